@@ -401,6 +401,18 @@ step =
         [Matlab] False
 
 
+run =
+    ApiFunction "run"
+        "run simulation for several cycles, recording all firing"
+        (Just "External stimulus for the whole run can optionally be provided up front as a StimulusSchedule. The firing record refers to memory owned by the simulation object, which is valid until the next call to run. Reading the firing this way avoids per-cycle copies.")
+        M.empty
+        [   ApiArg "firing" (Just "Firing during all cycles, as a FiringRecord") (Vector ApiUInt ExplicitLength) ]
+        [   Required (ApiArg "nsteps"
+                (Just "Number of cycles (1ms each) to run")
+                (Scalar ApiUInt)) ]
+        [Matlab, MEX] False
+
+
 applyStdp =
     ApiFunction "applyStdp"
         "update synapse weights using the accumulated STDP statistics"
@@ -548,7 +560,7 @@ simulation =
     ApiModule "Simulation" "sim"
         (Just "A simulation is created from a network and a configuration object. The simulation is run by stepping through it, providing stimulus as appropriate. It is possible to read back synapse data at run time. The simulation also maintains a timer for both simulated time and wallclock time.")
         (Factory [network, configuration])
-        [step, applyStdp, getMembranePotential,
+        [step, run, applyStdp, getMembranePotential,
             elapsedWallclock, elapsedSimulation, resetTimer, createSimulation, destroySimulation]
         constructable
 
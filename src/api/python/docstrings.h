@@ -14,6 +14,7 @@
 #define CONFIGURATION_RESET_CONFIGURATION_DOC "\n\nReplace configuration with default configuration"
 #define SIMULATION_DOC "A simulation is created from a network and a configuration object. The\nsimulation is run by stepping through it, providing stimulus as\nappropriate. It is possible to read back synapse data at run time. The\nsimulation also maintains a timer for both simulated time and wallclock\ntime."
 #define SIMULATION_STEP_DOC "\n\nrun simulation for a single cycle (1ms)\n\nInputs:\nfstim -- An optional list of neurons, which will be forced to fire this cycle\nistim_nidx -- An optional list of neurons which will be given input current stimulus this cycle\nistim_current -- The corresponding list of current input\n\nReturns Neurons which fired this cycle"
+#define SIMULATION_RUN_DOC "\n\nrun simulation for several cycles, recording all firing\n\nInputs:\nnsteps -- Number of cycles (1ms each) to run\n\nReturns Firing during all cycles, as a FiringRecord\n\nExternal stimulus for the whole run can optionally be provided up front as\na StimulusSchedule. The firing record refers to memory owned by the simulation object, which\nis valid until the next call to run. Reading the firing this way avoids\nper-cycle copies."
 #define SIMULATION_APPLY_STDP_DOC "\n\nupdate synapse weights using the accumulated STDP statistics\n\nInputs:\nreward -- Multiplier for the accumulated weight change"
 #define SIMULATION_GET_MEMBRANE_POTENTIAL_DOC "\n\nget neuron membane potential\n\nInputs:\nidx -- neuron index\n\nReturns membrane potential\n\nThe neuron index may be either scalar or a list. The output has the same\nlength as the neuron input"
 #define SIMULATION_ELAPSED_WALLCLOCK_DOC "\n\n\n\nReturns number of milliseconds of wall-clock time elapsed since first simulation step (or last timer reset)"
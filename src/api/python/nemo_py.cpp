@@ -7,6 +7,8 @@
  * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <functional>
@@ -14,6 +16,7 @@
 #include <boost/python.hpp>
 #include <boost/python/raw_function.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 
 #include <nemo.hpp>
 #include <nemo/config.h>
@@ -56,6 +59,13 @@ makeSimulation(const nemo::Network& net, const nemo::Configuration& conf)
 }
 
 
+boost::shared_ptr<nemo::Simulation>
+makeSimulationFromFile(const std::string& filename, const nemo::Configuration& conf)
+{
+	return boost::shared_ptr<nemo::Simulation>(simulation(filename, conf));
+}
+
+
 
 template<typename T>
 std::string
@@ -359,6 +369,294 @@ add_neuron_va(boost::python::tuple py_args, boost::python::dict /*kwargs*/)
 
 
 
+/*! Bulk input argument
+ *
+ * The argument may be a scalar, a Python sequence, or any object exporting a
+ * one-dimensional contiguous buffer of numbers (e.g. a NumPy array or an
+ * array.array). Buffers of the same type as the C++ argument are used in
+ * place. Other numeric buffers are converted in a single loop, without
+ * creating Python objects for the individual elements.
+ */
+template<typename T>
+class BulkInput : private boost::noncopyable
+{
+	public :
+
+		explicit BulkInput(PyObject* obj) :
+			m_hasView(false), m_vector(false), m_size(1), m_data(NULL)
+		{
+			if(PyObject_CheckBuffer(obj)
+					&& PyObject_GetBuffer(obj, &m_view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+				/* The destructor is not run if the constructor throws */
+				try {
+					useBuffer();
+				} catch(...) {
+					PyBuffer_Release(&m_view);
+					throw;
+				}
+				m_hasView = true;
+			} else {
+				PyErr_Clear();
+				if(PySequence_Check(obj)) {
+					m_vector = true;
+					m_size = PySequence_Size(obj);
+					m_copy.resize(m_size);
+					for(size_t i=0; i < m_size; ++i) {
+						boost::python::object item(boost::python::handle<>(PySequence_GetItem(obj, i)));
+						m_copy[i] = boost::python::extract<T>(item);
+					}
+				} else {
+					m_copy.push_back(boost::python::extract<T>(obj));
+				}
+				m_data = m_copy.empty() ? NULL : &m_copy[0];
+			}
+		}
+
+		~BulkInput() {
+			if(m_hasView) {
+				PyBuffer_Release(&m_view);
+			}
+		}
+
+		bool vector() const { return m_vector; }
+
+		size_t size() const { return m_size; }
+
+		/*! \return pointer to \a len values, replicating a scalar if required */
+		const T* data(size_t len) {
+			if(!m_vector && len != 1) {
+				m_copy.assign(len, m_copy.front());
+				m_data = len == 0 ? NULL : &m_copy[0];
+			}
+			return m_data;
+		}
+
+	private :
+
+		Py_buffer m_view;
+		bool m_hasView;
+		bool m_vector;
+		size_t m_size;
+		const T* m_data;
+		std::vector<T> m_copy;
+
+		/* Format character of the buffer, ignoring native byte order and
+		 * alignment specifiers */
+		static char formatKind(const char* format) {
+			if(format == NULL) {
+				return 'B';
+			}
+			if(*format == '@' || *format == '=') {
+				++format;
+			}
+			if(format[0] == '\0' || format[1] != '\0') {
+				throw std::invalid_argument(std::string("unsupported buffer format: ") + format);
+			}
+			return *format;
+		}
+
+		static char nativeKind();
+
+		void useBuffer() {
+			if(m_view.ndim > 1) {
+				throw std::invalid_argument("bulk input buffers must be one-dimensional");
+			}
+			m_vector = true;
+			m_size = m_view.len / m_view.itemsize;
+			char kind = formatKind(m_view.format);
+			if(kind == nativeKind() && size_t(m_view.itemsize) == sizeof(T)) {
+				m_data = static_cast<const T*>(m_view.buf);
+			} else {
+				convertBuffer(kind);
+			}
+		}
+
+		/* Integer arguments (indices, delays, plasticity flags) must be
+		 * represented exactly, so negative, fractional, and out-of-range
+		 * values are rejected rather than wrapped or truncated */
+		template<typename S>
+		static void checkElement(S x) {
+			if(std::numeric_limits<T>::is_integer) {
+				double v = double(x);
+				if(!(v >= 0.0) || v != std::floor(v) || v > double(std::numeric_limits<T>::max())) {
+					throw std::invalid_argument("bulk input contains a negative, non-integral, or out-of-range value");
+				}
+			}
+		}
+
+		template<typename S>
+		void convert() {
+			const S* src = static_cast<const S*>(m_view.buf);
+			m_copy.resize(m_size);
+			for(size_t i=0; i < m_size; ++i) {
+				checkElement(src[i]);
+				m_copy[i] = T(src[i]);
+			}
+			m_data = m_copy.empty() ? NULL : &m_copy[0];
+		}
+
+		void convertBuffer(char kind) {
+			switch(kind) {
+				case '?': convert<bool>(); break;
+				case 'b': convert<signed char>(); break;
+				case 'B': convert<unsigned char>(); break;
+				case 'h': convert<short>(); break;
+				case 'H': convert<unsigned short>(); break;
+				case 'i': convert<int>(); break;
+				case 'I': convert<unsigned int>(); break;
+				case 'l': convert<long>(); break;
+				case 'L': convert<unsigned long>(); break;
+				case 'q': convert<long long>(); break;
+				case 'Q': convert<unsigned long long>(); break;
+				case 'f': convert<float>(); break;
+				case 'd': convert<double>(); break;
+				default:
+					throw std::invalid_argument(std::string("unsupported buffer format: ") + kind);
+			}
+		}
+};
+
+template<> char BulkInput<unsigned>::nativeKind() { return 'I'; }
+template<> char BulkInput<unsigned char>::nativeKind() { return 'B'; }
+template<> char BulkInput<float>::nativeKind() { return 'f'; }
+
+
+
+/*! Verify that a vector input has the same length as any other vector inputs
+ *
+ * \param vector true if any other input is a vector, updated on return
+ * \param len common length of the vector inputs, updated on return
+ */
+template<typename T>
+void
+checkBulkLength(const BulkInput<T>& input, bool& vector, size_t& len)
+{
+	if(input.vector()) {
+		if(vector && input.size() != len) {
+			throw std::invalid_argument("input vectors of different length");
+		}
+		vector = true;
+		len = input.size();
+	}
+}
+
+
+
+/*! Add many synapses in one call
+ *
+ * As add_synapse, except that the inputs may also be NumPy arrays (or other
+ * objects exporting a buffer), which are passed on without per-element
+ * conversion. The synapse ids are either written to \a ids, which should then
+ * be a writable buffer of 64-bit integers, or returned as a list.
+ *
+ * \see nemo::Network::addSynapses
+ */
+PyObject*
+add_synapses(nemo::Network& net, PyObject* sources, PyObject* targets,
+		PyObject* delays, PyObject* weights, PyObject* plastics, PyObject* ids)
+{
+	BulkInput<unsigned> s(sources), t(targets), d(delays);
+	BulkInput<float> w(weights);
+	BulkInput<unsigned char> p(plastics);
+
+	/* If all inputs are scalars, a single synapse is added */
+	bool vector = false;
+	size_t len = 1;
+	checkBulkLength(s, vector, len);
+	checkBulkLength(t, vector, len);
+	checkBulkLength(d, vector, len);
+	checkBulkLength(w, vector, len);
+	checkBulkLength(p, vector, len);
+
+	const unsigned* sp = s.data(len);
+	const unsigned* tp = t.data(len);
+	const unsigned* dp = d.data(len);
+	const float* wp = w.data(len);
+	const unsigned char* pp = p.data(len);
+
+	if(ids != Py_None) {
+		Py_buffer view;
+		if(PyObject_GetBuffer(ids, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | PyBUF_WRITABLE) != 0) {
+			boost::python::throw_error_already_set();
+		}
+		const char* format = view.format == NULL ? "B" : view.format;
+		if(*format == '@' || *format == '=') {
+			++format;
+		}
+		bool integer = std::string("lLqQ").find(*format) != std::string::npos && format[1] == '\0';
+		if(!integer || size_t(view.itemsize) != sizeof(synapse_id)
+				|| size_t(view.len) / sizeof(synapse_id) != len) {
+			PyBuffer_Release(&view);
+			throw std::invalid_argument("synapse id output should be a vector of 64-bit integers of the same length as the inputs");
+		}
+		try {
+			net.addSynapses(len, sp, tp, dp, wp, pp, static_cast<synapse_id*>(view.buf));
+		} catch(...) {
+			PyBuffer_Release(&view);
+			throw;
+		}
+		PyBuffer_Release(&view);
+		Py_RETURN_NONE;
+	}
+
+	std::vector<synapse_id> out(len);
+	net.addSynapses(len, sp, tp, dp, wp, pp, len == 0 ? NULL : &out[0]);
+	to_python_value<synapse_id&> get_id;
+	PyObject* list = PyList_New(len);
+	for(size_t i=0; i != len; ++i) {
+		PyList_SetItem(list, i, get_id(out[i]));
+	}
+	return list;
+}
+
+
+
+/*! Add many neurons of the same type in one call
+ *
+ * The corresponding python prototype would be
+ *
+ * add_neurons(self, neuron_type, neuron_idx, *args)
+ *
+ * As add_neuron, except that the index and the parameters and state variables
+ * may also be NumPy arrays (or other objects exporting a buffer), which are
+ * passed on without per-element conversion.
+ *
+ * \see nemo::Network::addNeurons
+ */
+boost::python::object
+add_neurons_va(boost::python::tuple py_args, boost::python::dict /*kwargs*/)
+{
+	using namespace boost::python;
+
+	unsigned nargs = boost::python::len(py_args);
+	nemo::Network& net = boost::python::extract<nemo::Network&>(py_args[0])();
+	unsigned neuron_type = extract<unsigned>(py_args[1]);
+
+	if(nargs - 3 > NEMO_MAX_NEURON_ARGS) {
+		throw std::invalid_argument("too many neuron parameters and state variables");
+	}
+
+	BulkInput<unsigned> idx(static_cast<object>(py_args[2]).ptr());
+	bool vector = false;
+	size_t len = 1;
+	checkBulkLength(idx, vector, len);
+
+	boost::ptr_vector< BulkInput<float> > args;
+	for(unsigned i=3; i < nargs; ++i) {
+		args.push_back(new BulkInput<float>(static_cast<object>(py_args[i]).ptr()));
+		checkBulkLength(args.back(), vector, len);
+	}
+
+	const float* argv[NEMO_MAX_NEURON_ARGS];
+	for(unsigned i=0; i < args.size(); ++i) {
+		argv[i] = args[i].data(len);
+	}
+	net.addNeurons(neuron_type, len, idx.data(len), nargs-3, argv);
+	return object();
+}
+
+
+
 /*! Modify one or more neurons of arbitrary type
  *
  * \param args parameters and state variables, see below
@@ -691,6 +989,23 @@ step_fi(nemo::Simulation& sim,
 
 
 
+const nemo::Simulation::firing_record&
+run(nemo::Simulation& sim, unsigned nsteps)
+{
+	return sim.run(nsteps);
+}
+
+
+
+const nemo::Simulation::firing_record&
+run_s(nemo::Simulation& sim, unsigned nsteps,
+		const nemo::Simulation::stimulus_schedule& schedule)
+{
+	return sim.run(nsteps, schedule);
+}
+
+
+
 #ifdef NEMO_BRIAN_ENABLED
 
 /*! \copydoc nemo::Simulation::propagate */
@@ -717,6 +1032,15 @@ initializeConverters()
 }
 
 
+#define FIRING_RECORD_DOC "Firing during several consecutive cycles, as returned by Simulation.run.\n\nThe cycle and neuron index of each firing are found in 'cycles' and\n'neurons'. The firing during the i-th cycle of the run is found in the\nrange [offsets[i], offsets[i+1])."
+
+#define CONFIGURATION_SET_RNG_SEED_DOC "\n\nset the seed for the random number generators used by the simulation\n\nInputs:\nseed -- non-negative integer seed. The default seed is 0"
+#define NETWORK_ADD_SYNAPSES_DOC "\n\nadd many synapses to the network\n\nInputs:\nsource -- Indices of source neurons\ntarget -- Indices of target neurons\ndelay -- Synapse conductance delays in milliseconds\nweight -- Synapse weights\nplastic -- Whether or not each synapse is plastic\nids -- (optional) writable array of 64-bit integers for the synapse ids\n\nReturns List of synapse IDs, or None if ids is specified\n\nThe inputs may be NumPy arrays (or other objects exporting a one-dimensional\ncontiguous buffer), lists, or scalars. Arrays are read directly, without\nconverting each element, and should preferably already have the C++ type\n(uint32, float32, and uint8 for plastic). Scalars are replicated for each\nsynapse."
+#define NETWORK_ADD_NEURONS_DOC "\n\nadd many neurons of the same type to the network\n\nInputs:\ntype -- neuron type, as returned by add_neuron_type\nidx -- neuron indices\nparam0, param1, ... -- neuron parameters\nstate0, state1, ... -- initial values of neuron state variables\n\nThe inputs other than the type may be NumPy arrays (or other objects\nexporting a one-dimensional contiguous buffer), lists, or scalars. Arrays are\nread directly, without converting each element, and should preferably\nalready have the C++ type (uint32 for indices, float32 otherwise). Scalars\nare replicated for each neuron."
+#define NETWORK_SAVE_DOC "\n\nwrite the network to a file in NeMo's binary network format\n\nA simulation can be created directly from the file, without first loading\nthe network, using Simulation(filename, conf).\n\nInputs:\nfilename -- output file, which is replaced if it exists"
+#define STIMULUS_SCHEDULE_DOC "External stimulus for several consecutive cycles, for use with Simulation.run.\n\nStimulus is added one entry at a time, with steps counted from the start of\nthe run. Entries of each kind must be added in order of non-decreasing step."
+
+
 /* The STDP configuration comes in two forms in the C++ API. Use just the
  * original form here, in order to avoid breaking existing code. */
 void (nemo::Configuration::*stdp2)(
@@ -750,6 +1074,23 @@ BOOST_PYTHON_MODULE(_nemo)
 		.def("__str__", &std_vector_str<uint64_t>)
 	;
 
+	/* The firing record refers to vectors owned by the simulation, so
+	 * reading firing this way does not involve any copying */
+	class_<nemo::Simulation::firing_record>("FiringRecord", FIRING_RECORD_DOC, no_init)
+		.add_property("cycles", make_getter(&nemo::Simulation::firing_record::cycles, return_internal_reference<1>()))
+		.add_property("neurons", make_getter(&nemo::Simulation::firing_record::neurons, return_internal_reference<1>()))
+		.add_property("offsets", make_getter(&nemo::Simulation::firing_record::offsets, return_internal_reference<1>()))
+	;
+
+	class_<nemo::Simulation::stimulus_schedule>("StimulusSchedule", STIMULUS_SCHEDULE_DOC)
+		.def("add_firing", &nemo::Simulation::stimulus_schedule::addFiring,
+				"force a neuron to fire during a given step of the run")
+		.def("add_current", &nemo::Simulation::stimulus_schedule::addCurrent,
+				"provide external current to a neuron during a given step of the run")
+		.def("clear", &nemo::Simulation::stimulus_schedule::clear,
+				"remove all stimulus from the schedule")
+	;
+
 	class_<nemo::Configuration>("Configuration", CONFIGURATION_DOC)
 		//.def("enable_logging", &nemo::Configuration::enableLogging)
 		//.def("disable_logging", &nemo::Configuration::disableLogging)
@@ -758,12 +1099,16 @@ BOOST_PYTHON_MODULE(_nemo)
 		.def("set_cuda_backend", &nemo::Configuration::setCudaBackend, CONFIGURATION_SET_CUDA_BACKEND_DOC)
 		.def("set_cpu_backend", &nemo::Configuration::setCpuBackend, CONFIGURATION_SET_CPU_BACKEND_DOC)
 		.def("backend_description", &nemo::Configuration::backendDescription, CONFIGURATION_BACKEND_DESCRIPTION_DOC)
+		.def("set_rng_seed", &nemo::Configuration::setRngSeed, CONFIGURATION_SET_RNG_SEED_DOC)
 	;
 
 	class_<nemo::Network, boost::noncopyable>("Network", NETWORK_DOC)
 		.def("add_neuron_type", &nemo::Network::addNeuronType, NETWORK_ADD_NEURON_TYPE_DOC)
 		.def("add_neuron", raw_function(add_neuron_va, 3), NETWORK_ADD_NEURON_DOC)
 		.def("add_synapse", add_synapse, NETWORK_ADD_SYNAPSE_DOC)
+		.def("add_neurons", raw_function(add_neurons_va, 3), NETWORK_ADD_NEURONS_DOC)
+		.def("add_synapses", add_synapses, (arg("self"), arg("source"), arg("target"), arg("delay"), arg("weight"), arg("plastic"), arg("ids")=object()), NETWORK_ADD_SYNAPSES_DOC)
+		.def("save", &nemo::Network::save, NETWORK_SAVE_DOC)
 		.def("set_neuron", raw_function(set_neuron_va<nemo::Network>, 2), CONSTRUCTABLE_SET_NEURON_DOC)
 		.def("get_neuron_state", get_neuron_state<nemo::Network>, CONSTRUCTABLE_GET_NEURON_STATE_DOC)
 		.def("get_neuron_parameter", get_neuron_parameter<nemo::Network>, CONSTRUCTABLE_GET_NEURON_PARAMETER_DOC)
@@ -782,6 +1127,8 @@ BOOST_PYTHON_MODULE(_nemo)
 	class_<nemo::Simulation, boost::shared_ptr<nemo::Simulation>, boost::noncopyable>(
 			"Simulation", SIMULATION_DOC, no_init)
 		.def("__init__", make_constructor(makeSimulation))
+		/* Network file written by Network.save */
+		.def("__init__", make_constructor(makeSimulationFromFile))
 		/* For the step function(s) named optional input arguments is handled
 		 * in pure python. See __init__.py. */
 		/* May want to make a copy here, for some added safety:
@@ -794,6 +1141,8 @@ BOOST_PYTHON_MODULE(_nemo)
 		.def("step_f", step_f, return_internal_reference<1>())
 		.def("step_i", step_i, return_internal_reference<1>())
 		.def("step_fi", step_fi, return_internal_reference<1>())
+		.def("run", run, return_internal_reference<1>(), SIMULATION_RUN_DOC)
+		.def("run", run_s, return_internal_reference<1>(), SIMULATION_RUN_DOC)
 #ifdef NEMO_BRIAN_ENABLED
 		.def("propagate", propagate, SIMULATION_PROPAGATE_DOC)
 #endif
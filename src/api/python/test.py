@@ -2,6 +2,7 @@
 
 import unittest
 import random
+import array
 import nemo
 
 class IzNetwork(nemo.Network):
@@ -308,6 +309,54 @@ class TestFunctions(unittest.TestCase):
                 self.assertFalse(isinstance(ids, list))
 
 
+    def test_add_synapses_invalid_buffer(self):
+        """
+        Buffers with values which cannot be used as indices or delays should
+        be rejected, and the buffer should be released again, so that the
+        exporting object can still be resized
+        """
+        net = IzNetwork()
+        for (kind, values) in [('i', [0, -1]), ('d', [0.0, 1.5]), ('d', [0.0, -1.0])]:
+            source = array.array(kind, values)
+            self.assertRaises(ValueError, net.add_synapses, source, 0, 1, 1.0, False)
+            source.append(0)
+        delay = array.array('f', [1.0, 0.5])
+        self.assertRaises(ValueError, net.add_synapses, [0, 1], 0, delay, 1.0, False)
+        delay.append(1.0)
+        shaped = memoryview(array.array('I', [0, 1, 2, 3])).cast('B').cast('I', [2, 2])
+        self.assertRaises(ValueError, net.add_synapses, shaped, 0, 1, 1.0, False)
+        shaped.release()
+        ids = net.add_synapses(array.array('d', [0.0, 1.0]), 0, array.array('i', [1, 2]), 1.0, False)
+        self.assertEqual(len(ids), 2)
+
+
+    def test_save_and_load(self):
+        """
+        A simulation created from a saved network file should fire in the same
+        way as one created from the network itself
+        """
+        import os
+        import tempfile
+        net = IzNetwork()
+        for n in range(100):
+            net.add_neuron(n, 0.02, 0.2, -65.0, 8.0, 5.0, -13.0, -65.0)
+            net.add_synapse(n, [(n + k) % 100 for k in range(1, 11)], 1, 1.0, False)
+        (fd, filename) = tempfile.mkstemp(suffix='.nemo')
+        os.close(fd)
+        try:
+            net.save(filename)
+            conf = nemo.Configuration()
+            sim1 = nemo.Simulation(net, conf)
+            sim2 = nemo.Simulation(filename, conf)
+            for ms in range(100):
+                self.assertEqual(list(sim1.step()), list(sim2.step()))
+            self.assertEqual(sim2.get_synapse_target(sim2.get_synapses_from(1)),
+                    sim1.get_synapse_target(sim1.get_synapses_from(1)))
+        finally:
+            os.remove(filename)
+        self.assertRaises(RuntimeError, nemo.Simulation, filename, nemo.Configuration())
+
+
     def test_get_synapses_from_unconnected(self):
         net = IzNetwork()
         net.add_neuron(0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0)
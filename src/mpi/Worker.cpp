@@ -20,6 +20,8 @@
 #include <nemo/internals.hpp>
 #include <nemo/NetworkImpl.hpp>
 #include <nemo/ConnectivityMatrix.hpp>
+#include <nemo/RandomMapper.hpp>
+#include <nemo/fixedpoint.hpp>
 #include <nemo/config.h>
 
 #include "Mapper.hpp"
@@ -220,19 +222,25 @@ Worker::addSynapse(const Synapse& s,
 void
 gather(const SpikeQueue& queue,
 		const nemo::ConnectivityMatrix& fcm,
-		std::vector<fix_t>& current)
+		std::vector<fix_t>& current,
+		unsigned fbits,
+		std::vector<float>& currentFloat)
 {
-	std::fill(current.begin(), current.end(), 0.0);
+	std::fill(current.begin(), current.end(), 0);
 
 	SpikeQueue::const_iterator arrival_end = queue.current_end();
 	for(SpikeQueue::const_iterator arrival = queue.current_begin();
 			arrival != arrival_end; ++arrival) {
-		const Row& row = fcm.getRow(arrival->source(), arrival->delay());
-		FAxonTerminal* row_end = row.data.get() + row.len;
-		for(FAxonTerminal* terminal = row.data.get(); terminal != row_end; ++terminal) {
+		const Row row = fcm.getRow(arrival->source(), arrival->delay());
+		const FAxonTerminal* row_end = row.data + row.len;
+		for(const FAxonTerminal* terminal = row.data; terminal != row_end; ++terminal) {
 			current.at(terminal->target) += terminal->weight;
 		}
 	}
+
+	for(size_t n=0; n < current.size(); ++n) {
+		currentFloat[n] = fx_toFloat(current[n], fbits);
+	}
 }
 
 
@@ -261,18 +269,55 @@ Worker::runSimulation(
 	/* Local simulation data */
 	boost::scoped_ptr<nemo::SimulationBackend> sim(nemo::simulationBackend(net, conf));
 
-	/*! \bug the mapper() method no longer exists (due to more complex mapping
-	 * in the different backends). */
-	nemo::Mapper<nidx_t, nidx_t>& localMapper = sim->mapper();
-	nemo::ConnectivityMatrix g_fcmIn(conf, localMapper);
+	/* Incoming current is accumulated in the order expected by the dense
+	 * form of setCurrentStimulus, i.e. with neurons ordered by global index.
+	 * This is independent of the mapping used internally by the backend. */
+	std::vector<nidx_t> localNeurons;
+	for(unsigned type_id=0, id_end=net.neuronTypeCount(); type_id < id_end; ++type_id) {
+		for(network::neuron_iterator i = net.neuron_begin(type_id), i_end = net.neuron_end(type_id);
+				i != i_end; ++i) {
+			localNeurons.push_back(i->first);
+		}
+	}
+	std::sort(localNeurons.begin(), localNeurons.end());
+	nemo::RandomMapper<nidx_t> localMapper;
+	localMapper.reserve(net);
+	for(size_t i=0; i < localNeurons.size(); ++i) {
+		localMapper.insert(localNeurons[i], i);
+	}
+
+	/* The incoming connectivity matrix is indexed by the global index of the
+	 * remote source neurons, while its targets are local indices. The
+	 * synapses are collected into an intermediate network with targets
+	 * already translated, and the matrix is built using an identity mapping.
+	 * Only the forward rows are used, so STDP, compaction and the auxillary
+	 * synapse data are left disabled. */
+	network::NetworkImpl incoming;
+	nidx_t maxIdx = localNeurons.empty() ? 0 : nidx_t(localNeurons.size() - 1);
 	for(std::deque<Synapse>::const_iterator s = globalSynapses.begin();
 			s != globalSynapses.end(); ++s) {
-		g_fcmIn.addSynapse(s->source, localMapper.localIdx(s->target()), *s);
+		incoming.addSynapse(s->source, localMapper.localIdx(s->target()),
+				s->delay, s->weight(), s->plastic());
+		maxIdx = std::max(maxIdx, s->source);
+	}
+
+	nemo::RandomMapper<nidx_t> identity;
+	identity.reserve(0, maxIdx, maxIdx+1);
+	for(nidx_t n=0; n <= maxIdx; ++n) {
+		identity.insert(n, n);
 	}
-	g_fcmIn.finalize(localMapper, false);
 
-	std::vector<fix_t> istim(localMapper.neuronsInValidRange(), 0);
-	assert(localMapper.neuronsInValidRange() >= localCount);
+	nemo::ConfigurationImpl fcmConf;
+	fcmConf.setFractionalBits(sim->getFractionalBits());
+	fcmConf.setCpuCompactSynapses(false);
+	fcmConf.setWriteOnlySynapses();
+
+	nemo::ConnectivityMatrix g_fcmIn(incoming, fcmConf, identity);
+
+	std::vector<fix_t> istim_fx(localNeurons.size(), 0);
+	std::vector<float> istim(localNeurons.size(), 0.0f);
+	assert(localNeurons.size() == localCount);
+	const unsigned fbits = sim->getFractionalBits();
 	SpikeQueue queue(net.maxDelay()); // input from global spikes
 
 	/* Incoming master request */
@@ -332,7 +377,7 @@ Worker::runSimulation(
 		STEP("enqueue", enqueAllIncoming(ibufs, g_fcmIn, queue));
 		//! \todo improve naming
 		//! \todo experiment with order of gather and mreq
-		STEP("local gather", gather(queue, g_fcmIn, istim));
+		STEP("local gather", gather(queue, g_fcmIn, istim_fx, fbits, istim));
 		STEP("wait incoming master req", mreq.wait());
 		if(masterReq.terminate) {
 			break;
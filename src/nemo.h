@@ -162,6 +162,24 @@ nemo_status_t
 nemo_set_cpu_backend(nemo_configuration_t);
 
 
+/*! \copydoc nemo::Configuration::setCpuDeliveryEngine */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_set_cpu_delivery_engine(nemo_configuration_t, cpu_delivery_t);
+
+
+/*! \copydoc nemo::Configuration::setCpuRng */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_set_cpu_rng(nemo_configuration_t, cpu_rng_t);
+
+
+/*! \copydoc nemo::Configuration::setCpuCompactSynapses */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_set_cpu_compact_synapses(nemo_configuration_t, unsigned char enabled);
+
+
 /*! \copydoc nemo::Configuration::setCudaBackend */
 NEMO_DLL_PUBLIC
 nemo_status_t
@@ -191,6 +209,12 @@ nemo_status_t
 nemo_set_write_only_synapses(nemo_configuration_t conf);
 
 
+/*! \copydoc nemo::Configuration::setRngSeed */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_set_rng_seed(nemo_configuration_t conf, unsigned seed);
+
+
 
 /* \} */ // end configuration
 
@@ -269,6 +293,26 @@ nemo_add_neuron(nemo_network_t, unsigned type, unsigned idx,
 
 
 
+/*! Add several neurons of the same type to the network
+ *
+ * \param type index of the neuron type, as returned by \a add_neuron_type
+ * \param idx user-assigned unique neuron indices
+ * \param count length of \a idx and of each array in \a args
+ * \param nargs length of \a args
+ * \param args
+ * 		one array of length \a count for each floating point parameter,
+ * 		followed by one for each state variable
+ *
+ * \see nemo::Network::addNeurons
+ */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_add_neurons(nemo_network_t, unsigned type,
+		unsigned idx[], size_t count,
+		unsigned nargs, float* args[]);
+
+
+
 /* Add a single synapse to network
  *
  * \a id
@@ -287,12 +331,47 @@ nemo_add_synapse(nemo_network_t,
 
 
 
+/* Add several synapses to network
+ *
+ * All input arrays have length \a count.
+ *
+ * \a ids
+ * 		Array of length \a count which is set to the unique ids of the new
+ * 		synapses. Set to NULL if this is not required.
+ *
+ * \see nemo::Network::addSynapses
+ */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_add_synapses(nemo_network_t,
+		unsigned sources[],
+		unsigned targets[],
+		unsigned delays[],
+		float weights[],
+		unsigned char is_plastic[],
+		size_t count,
+		synapse_id ids[]);
+
+
+
 NEMO_DLL_PUBLIC
 nemo_status_t
 nemo_neuron_count(nemo_network_t net, unsigned* ncount);
 
 
 
+/*! Write the network to a file in NeMo's binary network format, replacing
+ * any existing file
+ *
+ * \see nemo_new_simulation_from_file
+ * \see nemo::Network::save
+ */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_save_network(nemo_network_t, const char* filename);
+
+
+
 
 /* \} */ // end construction group
 
@@ -312,6 +391,16 @@ NEMO_DLL_PUBLIC
 nemo_simulation_t nemo_new_simulation(nemo_network_t, nemo_configuration_t);
 
 
+/*! Create a new simulation from a network file written by nemo_save_network
+ * and a configuration. The network is read directly from the file.
+ *
+ * \return the new simulation, or NULL if the file could not be read or the
+ * 		simulation could not be created
+ */
+NEMO_DLL_PUBLIC
+nemo_simulation_t nemo_new_simulation_from_file(const char* filename, nemo_configuration_t);
+
+
 /*! Delete simulation object, freeing up all its associated resources */
 NEMO_DLL_PUBLIC
 void nemo_delete_simulation(nemo_simulation_t);
@@ -352,6 +441,92 @@ nemo_step(nemo_simulation_t,
 		unsigned* fired[], size_t* fired_count);
 
 
+/*! Run simulation for a single cycle (1ms) with input current for every neuron
+ *
+ * This is equivalent to \a nemo_step, except that the input current is
+ * provided as a dense vector. This is faster than the sparse form when most
+ * neurons receive input current.
+ *
+ * \param fstim_nidx
+ * 		Indices of the neurons which should be forced to fire this cycle.
+ * \param fstim_count
+ * 		Length of \a fstim_nidx
+ * \param istim_current
+ * 		Input current for every neuron, ordered by neuron index. Entry i is
+ * 		the current for the neuron with the i-th lowest index.
+ * \param istim_count
+ * 		Length of \a istim_current. This should be either the number of
+ * 		neurons in the network or zero (for no input current).
+ * \param[out] fired
+ * 		Vector which fill be filled with the indices of the neurons which fired
+ * 		this cycle. Set to NULL if the firing output is ignored.
+ * \param[out] fired_count
+ * 		Number of neurons which fired this cycle, i.e. the length of \a fired.
+ * 		Set to NULL if the firing output is ignored.
+ *
+ * \return
+ * 		NEMO_OK if operation succeeded, some other value otherwise.
+ */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_step_dense(nemo_simulation_t,
+		unsigned fstim_nidx[], size_t fstim_count,
+		float istim_current[], size_t istim_count,
+		unsigned* fired[], size_t* fired_count);
+
+
+/*! Run simulation for several cycles, recording all firing
+ *
+ * Stimulus can optionally be provided for any of the cycles, keyed by the
+ * step within the run (starting from 0). The stimulus entries must be ordered
+ * by step. This is equivalent to calling \a nemo_step \a nsteps times with
+ * the relevant stimulus for each cycle.
+ *
+ * The outputs refer to memory owned by the simulation object, which is valid
+ * until the next call to \a nemo_run. Any of the output arguments can be set
+ * to NULL if not required.
+ *
+ * \param nsteps number of cycles (1ms each) to run
+ * \param fstim_step
+ * 		Step during which each neuron in \a fstim_nidx should be forced to fire
+ * \param fstim_nidx
+ * 		Indices of the neurons which should be forced to fire
+ * \param fstim_count
+ * 		Length of \a fstim_step \b and \a fstim_nidx
+ * \param istim_step
+ * 		Step during which each neuron in \a istim_nidx should receive input
+ * 		current
+ * \param istim_nidx
+ * 		Indices of neurons which should receive external current stimulus
+ * \param istim_current
+ * 		The corresponding vector of current
+ * \param istim_count
+ * 		Length of \a istim_step, \a istim_nidx, \b and \a istim_current
+ * \param[out] cycles
+ * 		Simulation cycle of each firing, ordered by cycle. The length of this
+ * 		vector is \a fired_count.
+ * \param[out] fired
+ * 		Index of the neuron for each firing. The length of this vector is \a
+ * 		fired_count.
+ * \param[out] fired_count
+ * 		Total number of firings during the \a nsteps cycles
+ * \param[out] offsets
+ * 		Vector of length \a nsteps + 1. The firing during the i-th cycle of
+ * 		the run is found in \a cycles and \a fired in the range [offsets[i],
+ * 		offsets[i+1]).
+ *
+ * \return
+ * 		NEMO_OK if operation succeeded, some other value otherwise.
+ */
+NEMO_DLL_PUBLIC
+nemo_status_t
+nemo_run(nemo_simulation_t, unsigned nsteps,
+		unsigned fstim_step[], unsigned fstim_nidx[], size_t fstim_count,
+		unsigned istim_step[], unsigned istim_nidx[], float istim_current[], size_t istim_count,
+		uint64_t* cycles[], unsigned* fired[], size_t* fired_count,
+		uint64_t* offsets[]);
+
+
 /*! \copydoc nemo::Simulation::applyStdp */
 NEMO_DLL_PUBLIC
 nemo_status_t
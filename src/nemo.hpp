@@ -19,6 +19,7 @@
  */
 
 #include <nemo/Configuration.hpp>
+#include <nemo/InputGenerator.hpp>
 #include <nemo/Network.hpp>
 #include <nemo/Simulation.hpp>
 #include <nemo/exception.hpp>
@@ -27,6 +28,10 @@
 
 namespace nemo {
 
+namespace network {
+	class Generator;
+}
+
 /*! Create a simulation using one of the available backends. Returns NULL if
  * unable to create simulation.
  *
@@ -35,6 +40,31 @@ NEMO_DLL_PUBLIC
 Simulation* simulation(const Network& net, const Configuration& conf);
 
 
+/*! Create a simulation from a lower-level network generator, such as
+ * nemo::network::procedural::Generator (see
+ * nemo/network/procedural/Generator.hpp), whose synapses need not be stored
+ * in a Network.
+ *
+ * \see nemo::simulation(const Network&, const Configuration&)
+ */
+NEMO_DLL_PUBLIC
+Simulation* simulation(const network::Generator& net, const Configuration& conf);
+
+
+/*! Create a simulation from a network file written by nemo::Network::save
+ *
+ * The file is memory-mapped and read while the simulation is constructed,
+ * without first loading the network into a Network.
+ *
+ * \throws nemo::exception if the file cannot be opened, or is not a valid
+ * 		network file for this version of NeMo and this machine
+ *
+ * \see nemo::simulation(const Network&, const Configuration&)
+ */
+NEMO_DLL_PUBLIC
+Simulation* simulation(const std::string& filename, const Configuration& conf);
+
+
 /*! \return Number of CUDA devices on this system */
 NEMO_DLL_PUBLIC
 unsigned
@@ -116,6 +116,22 @@ Configuration::writeOnlySynapses() const
 
 
 
+void
+Configuration::setRngSeed(unsigned seed)
+{
+	m_impl->setRngSeed(seed);
+}
+
+
+
+unsigned
+Configuration::rngSeed() const
+{
+	return m_impl->rngSeed();
+}
+
+
+
 void
 Configuration::setCpuBackend()
 {
@@ -141,6 +157,54 @@ Configuration::backend() const
 
 
 
+void
+Configuration::setCpuDeliveryEngine(cpu_delivery_t engine)
+{
+	m_impl->setCpuDeliveryEngine(engine);
+}
+
+
+
+cpu_delivery_t
+Configuration::cpuDeliveryEngine() const
+{
+	return m_impl->cpuDeliveryEngine();
+}
+
+
+
+void
+Configuration::setCpuRng(cpu_rng_t rng)
+{
+	m_impl->setCpuRng(rng);
+}
+
+
+
+cpu_rng_t
+Configuration::cpuRng() const
+{
+	return m_impl->cpuRng();
+}
+
+
+
+void
+Configuration::setCpuCompactSynapses(bool enabled)
+{
+	m_impl->setCpuCompactSynapses(enabled);
+}
+
+
+
+bool
+Configuration::cpuCompactSynapses() const
+{
+	return m_impl->cpuCompactSynapses();
+}
+
+
+
 int
 Configuration::cudaDevice() const
 {
@@ -13,6 +13,7 @@
  */
 
 #include <ostream>
+#include <string>
 #include <vector>
 
 #include <nemo/config.h>
@@ -30,10 +31,15 @@ std::ostream& operator<<(std::ostream& o, nemo::Configuration const& conf);
 
 namespace nemo {
 
+	class Simulation;
 	class SimulationBackend;
 	class Network;
 	class ConfigurationImpl;
 
+	namespace network {
+		class Generator;
+	}
+
 	namespace mpi {
 		class Master;
 		class Worker;
@@ -105,6 +111,18 @@ class NEMO_DLL_PUBLIC Configuration
 		void setWriteOnlySynapses();
 		bool writeOnlySynapses() const;
 
+		/*! Set the seed for the random number generators used by the
+		 * simulation, i.e. for neuron noise and for input generators
+		 *
+		 * The random numbers for each neuron are derived from the seed and
+		 * the neuron index only, so a given seed gives reproducible
+		 * simulations, while different seeds give independent ones. The
+		 * default seed is 0. */
+		void setRngSeed(unsigned seed);
+
+		/*! \return the seed for the random number generators */
+		unsigned rngSeed() const;
+
 		/*! Specify that the CUDA backend should be used and optionally specify
 		 * a desired device. If the (default) device value of -1 is used the
 		 * backend will choose the best available device.
@@ -122,6 +140,60 @@ class NEMO_DLL_PUBLIC Configuration
 
 		backend_t backend() const;
 
+		/*! Select the spike delivery engine used by the CPU backend
+		 *
+		 * With NEMO_CPU_DELIVERY_PUSH (the default) spikes are delivered by
+		 * walking the outgoing synapses of each neuron which fired. With
+		 * NEMO_CPU_DELIVERY_PULL each target neuron instead collects current
+		 * from its incoming synapses. The pull engine requires an additional
+		 * reverse index, but may be faster for dense networks with high
+		 * firing rates. With NEMO_CPU_DELIVERY_RING the outgoing synapses of
+		 * each neuron are walked only once, when it fires, and the current is
+		 * accumulated in a circular buffer with one slot per delay. This
+		 * requires memory proportional to the number of neurons times the
+		 * maximum delay. As the weights are read when the spike is generated
+		 * rather than when it is delivered, the ring engine cannot be used
+		 * with STDP, and creating such a simulation raises an exception. All
+		 * engines which support a given configuration produce identical
+		 * results. */
+		void setCpuDeliveryEngine(cpu_delivery_t engine);
+
+		/*! \return the spike delivery engine used by the CPU backend */
+		cpu_delivery_t cpuDeliveryEngine() const;
+
+		/*! Select the random number generator used for neuron noise by the
+		 * CPU backend
+		 *
+		 * With NEMO_CPU_RNG_XORSHIFT (the default) each neuron has its own
+		 * stateful generator, which is advanced whenever the neuron draws a
+		 * random number. With NEMO_CPU_RNG_PHILOX the random numbers are
+		 * instead computed by a counter-based generator from the neuron
+		 * index and the cycle number. The results then do not depend on the
+		 * order in which neurons are updated, and can be reproduced for any
+		 * neuron and cycle without replaying the simulation. Only neuron
+		 * types whose CPU plugin provides a counter-based update (currently
+		 * Izhikevich and PoissonSource) can be used with NEMO_CPU_RNG_PHILOX.
+		 * The two generators produce different random streams. */
+		void setCpuRng(cpu_rng_t rng);
+
+		/*! \return the random number generator used by the CPU backend */
+		cpu_rng_t cpuRng() const;
+
+		/*! Enable or disable the compact synapse encoding in the CPU backend
+		 *
+		 * When enabled (the default), the forward connectivity matrix of a
+		 * network without STDP stores each synapse in 32 bits: the target
+		 * index in the low bits and an index into a table of distinct
+		 * weights in the high bits. The encoding is only used when it fits,
+		 * and never with the pull delivery engine. Disabling it keeps the
+		 * full encoding, e.g. for comparing the two. The simulation results
+		 * are the same either way. */
+		void setCpuCompactSynapses(bool enabled);
+
+		/*! \return true if the CPU backend may use the compact synapse
+		 * encoding */
+		bool cpuCompactSynapses() const;
+
 		/*! \return the chosen CUDA device or -1 if CUDA is not the selected
 		 * backend. */
 		int cudaDevice() const;
@@ -132,6 +204,8 @@ class NEMO_DLL_PUBLIC Configuration
 	private:
 
 		friend SimulationBackend* simulationBackend(const Network&, const Configuration&);
+		friend SimulationBackend* simulationBackend(const std::string&, const Configuration&);
+		friend Simulation* simulation(const network::Generator&, const Configuration&);
 		friend class nemo::mpi::Master;
 		friend class nemo::mpi::Worker;
 
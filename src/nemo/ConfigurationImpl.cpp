@@ -20,8 +20,12 @@ ConfigurationImpl::ConfigurationImpl() :
 	m_logging(false),
 	m_writeOnlySynapses(false),
 	m_fractionalBits(20),
+	m_rngSeed(0),
 	m_cudaPartitionSize(0),
 	m_cudaDevice(~0U),
+	m_cpuDeliveryEngine(NEMO_CPU_DELIVERY_PUSH),
+	m_cpuRng(NEMO_CPU_RNG_XORSHIFT),
+	m_cpuCompactSynapses(true),
 	m_backend(~0U), // the wrapper class will set this
 	m_backendDescription("No backend specified")
 {
@@ -97,6 +101,43 @@ ConfigurationImpl::setBackend(backend_t backend)
 
 
 
+void
+ConfigurationImpl::setCpuDeliveryEngine(cpu_delivery_t engine)
+{
+	using boost::format;
+
+	switch(engine) {
+		case NEMO_CPU_DELIVERY_PUSH :
+		case NEMO_CPU_DELIVERY_PULL :
+		case NEMO_CPU_DELIVERY_RING :
+			m_cpuDeliveryEngine = engine;
+			break;
+		default :
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Invalid CPU spike delivery engine (%u) specified") % engine));
+	}
+}
+
+
+
+void
+ConfigurationImpl::setCpuRng(cpu_rng_t rng)
+{
+	using boost::format;
+
+	switch(rng) {
+		case NEMO_CPU_RNG_XORSHIFT :
+		case NEMO_CPU_RNG_PHILOX :
+			m_cpuRng = rng;
+			break;
+		default :
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Invalid CPU random number generator (%u) specified") % rng));
+	}
+}
+
+
+
 void
 ConfigurationImpl::verifyStdp(unsigned d_max) const
 {
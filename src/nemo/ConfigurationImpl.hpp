@@ -55,6 +55,30 @@ class NEMO_BASE_DLL_PUBLIC ConfigurationImpl
 		void setCudaDevice(unsigned device) { m_cudaDevice = device; }
 		unsigned cudaDevice() const { return m_cudaDevice; }
 
+		/*! \copydoc nemo::Configuration::setCpuDeliveryEngine */
+		void setCpuDeliveryEngine(cpu_delivery_t engine);
+
+		/*! \copydoc nemo::Configuration::cpuDeliveryEngine */
+		cpu_delivery_t cpuDeliveryEngine() const { return m_cpuDeliveryEngine; }
+
+		/*! \copydoc nemo::Configuration::setCpuRng */
+		void setCpuRng(cpu_rng_t rng);
+
+		/*! \copydoc nemo::Configuration::cpuRng */
+		cpu_rng_t cpuRng() const { return m_cpuRng; }
+
+		/*! \copydoc nemo::Configuration::setCpuCompactSynapses */
+		void setCpuCompactSynapses(bool enabled) { m_cpuCompactSynapses = enabled; }
+
+		/*! \copydoc nemo::Configuration::cpuCompactSynapses */
+		bool cpuCompactSynapses() const { return m_cpuCompactSynapses; }
+
+		/*! \copydoc nemo::Configuration::setRngSeed */
+		void setRngSeed(unsigned seed) { m_rngSeed = seed; }
+
+		/*! \copydoc nemo::Configuration::rngSeed */
+		unsigned rngSeed() const { return m_rngSeed; }
+
 		/*! \copydoc nemo::Configuration::setStdpFunction */
 		void setStdpFunction(
 				const std::vector<float>& prefire,
@@ -103,11 +127,18 @@ class NEMO_BASE_DLL_PUBLIC ConfigurationImpl
 		int m_fractionalBits;
 		static const int s_defaultFractionalBits = -1;
 
+		unsigned m_rngSeed;
+
 		/* CUDA-specific */
 		unsigned m_cudaPartitionSize;
 
 		unsigned m_cudaDevice;
 
+		/* CPU-specific */
+		cpu_delivery_t m_cpuDeliveryEngine;
+		cpu_rng_t m_cpuRng;
+		bool m_cpuCompactSynapses;
+
 		friend void check_close(const ConfigurationImpl& lhs, const ConfigurationImpl& rhs);
 
 		backend_t m_backend;
@@ -122,7 +153,11 @@ class NEMO_BASE_DLL_PUBLIC ConfigurationImpl
 			ar & m_logging;
 			ar & m_stdpFn;
 			ar & m_fractionalBits;
+			ar & m_rngSeed;
 			ar & m_cudaPartitionSize;
+			ar & m_cpuDeliveryEngine;
+			ar & m_cpuRng;
+			ar & m_cpuCompactSynapses;
 			ar & m_backend;
 			ar & m_backendDescription;
 		}
@@ -11,12 +11,13 @@
 
 #include <algorithm>
 #include <utility>
-#include <stdlib.h>
 
-#include <boost/tuple/tuple_comparison.hpp>
 #include <boost/format.hpp>
 
 #include <nemo/config.h>
+#ifdef NEMO_CPU_OPENMP_ENABLED
+#include <omp.h>
+#endif
 #include <nemo/network/Generator.hpp>
 #include "ConfigurationImpl.hpp"
 #include "exception.hpp"
@@ -27,47 +28,283 @@
 namespace nemo {
 
 
-Row::Row(const std::vector<FAxonTerminal>& ss) :
-	len(ss.size())
+/* Number of rows (or source neurons) processed together in parallel loops */
+const int ROW_CHUNK = 1024;
+
+
+/* Number of synapses read at a time from a network which does not provide
+ * synapse blocks */
+const size_t ITERATOR_BLOCK_SIZE = 65536;
+
+
+
+/* Call visit for every block of synapses in the network.
+ *
+ * Blocks may have to be computed by the generator (see network::procedural),
+ * so a batch of blocks is read in parallel. If \a ordered is false the blocks
+ * of a batch are also visited in parallel, so the visitor must be
+ * thread-safe. Otherwise they are visited one at a time, in network order.
+ * Only one batch of blocks is held in memory at any time. Networks which do
+ * not provide blocks are read sequentially through the synapse iterator. */
+template<class Visitor>
+void
+forEachBlock(const network::Generator& net, Visitor& visit, bool ordered)
 {
-	void* ptr;
-#ifdef HAVE_POSIX_MEMALIGN
-	//! \todo factor out the memory aligned allocation
-	int error = posix_memalign(&ptr,
-			ASSUMED_CACHE_LINE_SIZE,
-			ss.size()*sizeof(FAxonTerminal));
-	if(error) {
-		throw nemo::exception(NEMO_ALLOCATION_ERROR, "Failed to allocate CM row");
+	size_t blockCount = net.synapseBlockCount();
+
+	if(blockCount == 0) {
+		network::SynapseBuffer buffer;
+		network::synapse_iterator i = net.synapse_begin();
+		network::synapse_iterator i_end = net.synapse_end();
+		for( ; i != i_end; ++i) {
+			buffer.add(i->source, i->target(), i->delay, i->weight(), i->plastic(), i->id());
+			if(buffer.size() == ITERATOR_BLOCK_SIZE) {
+				visit(buffer.block());
+				buffer.clear();
+			}
+		}
+		if(buffer.size() != 0) {
+			visit(buffer.block());
+		}
+		return;
 	}
+
+#ifdef NEMO_CPU_OPENMP_ENABLED
+	const size_t batchSize = 2 * omp_get_max_threads();
 #else
-	ptr = malloc(ss.size()*sizeof(FAxonTerminal));
+	const size_t batchSize = 1;
 #endif
-	FAxonTerminal* term = static_cast<FAxonTerminal*>(ptr);
-	std::copy(ss.begin(), ss.end(), term);
-	data = boost::shared_array<FAxonTerminal>(term, free);
-}
 
+	std::vector<network::SynapseBuffer> buffers(batchSize);
+	std::vector<network::SynapseBlock> blocks(batchSize);
 
+	for(size_t b0=0; b0 < blockCount; b0 += batchSize) {
 
-/* Insert into vector, resizing if appropriate */
-template<typename T>
-void
-insert(size_t idx, const T& val, std::vector<T>& vec)
-{
-	if(idx >= vec.size()) {
-		vec.resize(idx+1);
+		int n = int(std::min(batchSize, blockCount - b0));
+
+		/* Exceptions cannot leave the parallel region, so the first error is
+		 * recorded and re-thrown afterwards */
+		bool failed = false;
+		int errorNumber = NEMO_OK;
+		std::string errorMessage;
+
+#pragma omp parallel for default(shared) schedule(dynamic)
+		for(int i=0; i < n; ++i) {
+			try {
+				blocks[i] = net.synapseBlock(b0+i, buffers[i]);
+				if(!ordered) {
+					visit(blocks[i]);
+				}
+			} catch(nemo::exception& e) {
+#pragma omp critical (forEachBlock)
+				if(!failed) {
+					failed = true;
+					errorNumber = e.errorNumber();
+					errorMessage = e.what();
+				}
+			} catch(std::exception& e) {
+#pragma omp critical (forEachBlock)
+				if(!failed) {
+					failed = true;
+					errorNumber = NEMO_UNKNOWN_ERROR;
+					errorMessage = e.what();
+				}
+			}
+		}
+
+		if(failed) {
+			throw nemo::exception(errorNumber, errorMessage);
+		}
+
+		if(ordered) {
+			for(int i=0; i < n; ++i) {
+				visit(blocks[i]);
+			}
+		}
 	}
-	vec.at(idx) = val;
 }
 
 
 
+/* First pass over the network: count the synapses in each row, using an
+ * upper bound on the source index and delay for the row addresses, and find
+ * the actual range of sources, delays, and weights. The mapper rejects
+ * synapses with invalid source or target neurons. */
+class RowCounter
+{
+	public :
+
+		RowCounter(const ConnectivityMatrix::mapper_t& mapper,
+				delay_t maxDelay, std::vector<size_t>& count) :
+			sourceCount(0), maxDelay(0), minWeight(0.0f), maxWeight(0.0f),
+			m_mapper(mapper), m_delayBound(maxDelay), m_count(count) { }
+
+		void operator()(const network::SynapseBlock& block) {
+			using boost::format;
+
+			nidx_t sources = 0;
+			delay_t delays = 0;
+			float minW = 0.0f;
+			float maxW = 0.0f;
+			for(size_t s=0; s < block.size; ++s) {
+				nidx_t source = m_mapper.localIdx(block.source[s]);
+				m_mapper.localIdx(block.target[s]);
+				delay_t delay = block.delay[s];
+				if(delay < 1 || delay > m_delayBound) {
+					throw nemo::exception(NEMO_INVALID_INPUT,
+							str(format("Synapse delay %u outside the range [1, %u] given by the network")
+								% delay % m_delayBound));
+				}
+				size_t addr = size_t(source) * m_delayBound + delay - 1;
+#pragma omp atomic
+				m_count.at(addr) += 1;
+				sources = std::max(sources, source + 1);
+				delays = std::max(delays, delay);
+				minW = std::min(minW, block.weight[s]);
+				maxW = std::max(maxW, block.weight[s]);
+			}
+#pragma omp critical (RowCounter)
+			{
+				sourceCount = std::max(sourceCount, sources);
+				maxDelay = std::max(maxDelay, delays);
+				minWeight = std::min(minWeight, minW);
+				maxWeight = std::max(maxWeight, maxW);
+			}
+		}
+
+		nidx_t sourceCount;
+		delay_t maxDelay;
+		float minWeight;
+		float maxWeight;
+
+	private :
+
+		const ConnectivityMatrix::mapper_t& m_mapper;
+		delay_t m_delayBound;
+		std::vector<size_t>& m_count;
+};
+
+
+
+/* Second pass over the network: scatter each synapse into the next free
+ * slot of its row. The synapse id and plasticity are kept alongside the
+ * forward matrix until the auxillary data has been built. */
+class RowFiller
+{
+	public :
+
+		RowFiller(const ConnectivityMatrix::mapper_t& mapper,
+				delay_t maxDelay, unsigned fractionalBits,
+				const std::vector<size_t>& rowOffset,
+				std::vector<size_t>& next,
+				std::vector<FAxonTerminal>& terminals,
+				std::vector<id32_t>& id,
+				std::vector<unsigned char>& plastic) :
+			failed(false),
+			m_mapper(mapper), m_maxDelay(maxDelay),
+			m_fractionalBits(fractionalBits),
+			m_rowOffset(rowOffset), m_next(next),
+			m_terminals(terminals), m_id(id), m_plastic(plastic) { }
+
+		void operator()(const network::SynapseBlock& block) {
+			for(size_t s=0; s < block.size; ++s) {
+				nidx_t source = m_mapper.localIdx(block.source[s]);
+				nidx_t target = m_mapper.localIdx(block.target[s]);
+				delay_t delay = block.delay[s];
+				size_t addr = size_t(source) * m_maxDelay + delay - 1;
+				if(delay < 1 || delay > m_maxDelay || addr + 1 >= m_rowOffset.size()) {
+					failed = true;
+					continue;
+				}
+				size_t pos;
+#pragma omp atomic capture
+				pos = m_next[addr]++;
+				if(pos >= m_rowOffset[addr+1]) {
+					failed = true;
+					continue;
+				}
+				m_terminals[pos] = FAxonTerminal(target, fx_toFix(block.weight[s], m_fractionalBits));
+				m_id[pos] = block.id[s];
+				m_plastic[pos] = block.plastic[s];
+			}
+		}
+
+		/*! Set if the network returned synapses which were not counted in
+		 * the first pass. The flag is only ever set, so concurrent writes
+		 * are benign. */
+		bool failed;
+
+	private :
+
+		const ConnectivityMatrix::mapper_t& m_mapper;
+		delay_t m_maxDelay;
+		unsigned m_fractionalBits;
+		const std::vector<size_t>& m_rowOffset;
+		std::vector<size_t>& m_next;
+		std::vector<FAxonTerminal>& m_terminals;
+		std::vector<id32_t>& m_id;
+		std::vector<unsigned char>& m_plastic;
+};
+
+
+
+/* Final pass over the network: add the synapses to the reverse matrix in
+ * network order. The index of each synapse within its forward row is found
+ * from its id, as the rows are sorted by id. */
+class ReverseFiller
+{
+	public :
+
+		ReverseFiller(const ConnectivityMatrix::mapper_t& mapper,
+				delay_t maxDelay,
+				const std::vector<size_t>& rowOffset,
+				const std::vector<id32_t>& id,
+				construction::RCM<nidx_t, RSynapse, 32>& rcm) :
+			m_mapper(mapper), m_maxDelay(maxDelay),
+			m_rowOffset(rowOffset), m_id(id), m_rcm(rcm) { }
+
+		void operator()(const network::SynapseBlock& block) {
+			for(size_t s=0; s < block.size; ++s) {
+				nidx_t source = m_mapper.localIdx(block.source[s]);
+				nidx_t target = m_mapper.localIdx(block.target[s]);
+				delay_t delay = block.delay[s];
+				size_t addr = size_t(source) * m_maxDelay + delay - 1;
+				std::vector<id32_t>::const_iterator begin = m_id.begin() + m_rowOffset[addr];
+				std::vector<id32_t>::const_iterator end = m_id.begin() + m_rowOffset[addr+1];
+				std::vector<id32_t>::const_iterator found = std::lower_bound(begin, end, block.id[s]);
+				if(found == end || *found != block.id[s]) {
+					throw nemo::exception(NEMO_LOGIC_ERROR,
+							"Network generator returned different synapses when read a second time");
+				}
+				Synapse synapse(source, delay,
+						AxonTerminal(block.id[s], target, block.weight[s], block.plastic[s] != 0));
+				m_rcm.addSynapse(target, RSynapse(source, delay), synapse, size_t(found - begin));
+			}
+		}
+
+	private :
+
+		const ConnectivityMatrix::mapper_t& m_mapper;
+		delay_t m_maxDelay;
+		const std::vector<size_t>& m_rowOffset;
+		const std::vector<id32_t>& m_id;
+		construction::RCM<nidx_t, RSynapse, 32>& m_rcm;
+};
+
+
+
+/* The network is read twice (three times if the reverse matrix is used)
+ * rather than copied, so that the memory used during construction stays
+ * close to the size of the final matrix. Beyond the forward matrix and the
+ * auxillary data, only the id and plasticity of each synapse (5 bytes) are
+ * held temporarily, together with one batch of synapse blocks. */
 ConnectivityMatrix::ConnectivityMatrix(
 		const network::Generator& net,
 		const ConfigurationImpl& conf,
 		const mapper_t& mapper) :
 	m_mapper(mapper),
 	m_fractionalBits(conf.fractionalBits()),
+	m_targetBits(0),
 	m_maxDelay(0),
 	m_writeOnlySynapses(conf.writeOnlySynapses())
 {
@@ -75,115 +312,215 @@ ConnectivityMatrix::ConnectivityMatrix(
 		m_stdp = StdpProcess(conf.stdpFunction().get(), m_fractionalBits);
 	}
 
-	construction::RCM<nidx_t, RSynapse, 32> m_racc(conf, net, RSynapse(~0U,0));
-	network::synapse_iterator i = net.synapse_begin();
-	network::synapse_iterator i_end = net.synapse_end();
+	std::vector<id32_t> id;
+	std::vector<unsigned char> plastic;
+	nidx_t sourceCount = finalizeForward(net, id, plastic);
+	m_delays.init(m_maxDelay, m_rowOffset);
+	if(!m_writeOnlySynapses) {
+		finalizeAux(id, plastic, sourceCount);
+	}
+	std::vector<unsigned char>().swap(plastic);
 
-	for( ; i != i_end; ++i) {
-		nidx_t source = mapper.localIdx(i->source);
-		nidx_t target = mapper.localIdx(i->target());
-		sidx_t sidx = addSynapse(source, target, *i);
-		m_racc.addSynapse(target, RSynapse(source, i->delay), *i, sidx);
+	/* The reverse matrix is only populated if required by STDP or by the
+	 * neuron types. Synapses are added in network order. */
+	construction::RCM<nidx_t, RSynapse, 32> m_racc(conf, net, RSynapse(~0U,0));
+	if(m_racc.enabled() && !m_terminals.empty()) {
+		ReverseFiller fill(mapper, m_maxDelay, m_rowOffset, id, m_racc);
+		forEachBlock(net, fill, true);
 	}
+	std::vector<id32_t>().swap(id);
 
-	//! \todo avoid two passes here
-	bool verifySources = true;
-	finalizeForward(mapper, verifySources);
 	m_rcm.reset(new runtime::RCM(m_racc));
+	if(m_stdp) {
+		finalizeStdp();
+	}
+
+	if(conf.cpuDeliveryEngine() == NEMO_CPU_DELIVERY_PULL) {
+		finalizeIncoming(net.neuronCount());
+	} else if(!m_stdp && conf.cpuCompactSynapses()) {
+		packForward(net.neuronCount());
+	}
 }
 
 
 
-sidx_t
-ConnectivityMatrix::addSynapse(nidx_t source, nidx_t target, const Synapse& s)
+/* The forward matrix is built using a counting sort of the synapses by row,
+ * reading the network once to count and once to fill. Synapses are scattered
+ * into their rows concurrently, after which the synapses in each row are
+ * sorted by id. Since ids are assigned to the synapses of each source in
+ * order, this is the order in which they were provided by the network, and
+ * the result does not depend on the number of threads. */
+nidx_t
+ConnectivityMatrix::finalizeForward(
+		const network::Generator& net,
+		std::vector<id32_t>& id,
+		std::vector<unsigned char>& plastic)
 {
-	delay_t delay = s.delay;
-	fix_t weight = fx_toFix(s.weight(), m_fractionalBits);
-
-	fidx_t fidx(source, delay);
-	row_t& row = m_acc[fidx];
-	sidx_t sidx = row.size();
-	row.push_back(FAxonTerminal(target, weight));
+	m_rowOffset.clear();
+	m_terminals.clear();
+	id.clear();
+	plastic.clear();
+
+	/* Pass 1: row sizes, addressed using the bounds given by the network */
+	nidx_t sourceBound = m_mapper.maxLocalIdx() + 1;
+	delay_t delayBound = net.maxDelay();
+	std::vector<size_t> count(size_t(sourceBound) * delayBound, 0);
+	RowCounter counter(m_mapper, delayBound, count);
+	forEachBlock(net, counter, false);
+
+	if(counter.sourceCount == 0) {
+		return 0;
+	}
 
-	//! \todo could do this on finalize pass, since there are fewer steps there
-	m_delaysAcc.addDelay(source, delay);
+	/* Report any fixed-point overflow here rather than from within the
+	 * parallel fill of the forward matrix */
+	fx_toFix(counter.minWeight, m_fractionalBits);
+	fx_toFix(counter.maxWeight, m_fractionalBits);
+
+	/* Row offsets using the actual range of sources and delays */
+	m_maxDelay = counter.maxDelay;
+	const nidx_t sourceCount = counter.sourceCount;
+	const int64_t rowCount = int64_t(sourceCount) * m_maxDelay;
+	m_rowOffset.assign(rowCount+1, 0);
+	for(nidx_t source=0; source < sourceCount; ++source) {
+		for(delay_t delay=1; delay <= m_maxDelay; ++delay) {
+			size_t addr = addressOf(source, delay);
+			m_rowOffset[addr+1] = m_rowOffset[addr] + count[size_t(source) * delayBound + delay - 1];
+		}
+	}
+	std::vector<size_t>().swap(count);
+	const size_t synapseCount = m_rowOffset[rowCount];
+
+	/* Pass 2: scatter into rows */
+	m_terminals.resize(synapseCount, FAxonTerminal(0, 0));
+	id.resize(synapseCount);
+	plastic.resize(synapseCount);
+	{
+		std::vector<size_t> next(m_rowOffset.begin(), m_rowOffset.end()-1);
+		RowFiller fill(m_mapper, m_maxDelay, m_fractionalBits,
+				m_rowOffset, next, m_terminals, id, plastic);
+		forEachBlock(net, fill, false);
+		bool complete = !fill.failed;
+		for(int64_t addr=0; complete && addr < rowCount; ++addr) {
+			complete = next[addr] == m_rowOffset[addr+1];
+		}
+		if(!complete) {
+			throw nemo::exception(NEMO_LOGIC_ERROR,
+					"Network generator returned different synapses when read a second time");
+		}
+	}
 
-	if(!m_writeOnlySynapses) {
-		/* The auxillary synapse maps always uses the global (user-specified)
-		 * source and target neuron ids, since it's used for lookups basd on
-		 * these global ids */
-		aux_row& auxRow = m_cmAux[s.source];
-		insert(s.id(), AxonTerminalAux(sidx, delay, s.plastic() != 0), auxRow);
+	/* Restore network order within each row */
+#pragma omp parallel for default(shared) schedule(dynamic, ROW_CHUNK)
+	for(int64_t addr=0; addr < rowCount; ++addr) {
+		size_t begin = m_rowOffset[addr];
+		size_t end = m_rowOffset[addr+1];
+		bool sorted = true;
+		for(size_t i=begin; sorted && i+1 < end; ++i) {
+			sorted = id[i] < id[i+1];
+		}
+		if(sorted) {
+			continue;
+		}
+		std::vector< std::pair<id32_t, size_t> > key;
+		key.reserve(end - begin);
+		for(size_t i=begin; i < end; ++i) {
+			key.push_back(std::make_pair(id[i], i));
+		}
+		std::sort(key.begin(), key.end());
+		std::vector<FAxonTerminal> terminals(m_terminals.begin() + begin, m_terminals.begin() + end);
+		std::vector<unsigned char> flags(plastic.begin() + begin, plastic.begin() + end);
+		for(size_t k=0; k < key.size(); ++k) {
+			m_terminals[begin+k] = terminals[key[k].second - begin];
+			plastic[begin+k] = flags[key[k].second - begin];
+			id[begin+k] = key[k].first;
+		}
 	}
-	return sidx;
+
+	return sourceCount;
 }
 
 
 
-/* The fast lookup is indexed by source and delay. */
+/* The synapses of a single source occupy a contiguous range of the forward
+ * matrix, so the auxillary data can be built independently for each source */
 void
-ConnectivityMatrix::finalizeForward(const mapper_t& mapper, bool verifySources)
+ConnectivityMatrix::finalizeAux(
+		const std::vector<id32_t>& id,
+		const std::vector<unsigned char>& plastic,
+		nidx_t sourceCount)
 {
-	m_maxDelay = m_delaysAcc.maxDelay();
-	m_delays.init(m_delaysAcc);
-	m_delaysAcc.clear();
+	m_auxOffset.assign(sourceCount+1, 0);
+	m_aux.clear();
 
-	if(m_acc.empty()) {
+	if(m_terminals.empty()) {
 		return;
 	}
 
-	/* This relies on lexicographical ordering of tuple */
-	nidx_t maxSourceIdx = m_acc.rbegin()->first.get<0>();
-	m_cm.resize((maxSourceIdx+1) * m_maxDelay);
-
-	//! \todo change order here: default to Row() in all location, and then just iterate over map
-	for(nidx_t n=0; n <= maxSourceIdx; ++n) {
-		for(delay_t d=1; d <= m_maxDelay; ++d) {
-
-#if 0
-			if(d < 1) {
-				//! \todo make sure to report global index again here
-				throw nemo::exception(NEMO_INVALID_INPUT,
-						str(format("Neuron %u has synapses with delay < 1 (%u)") % source % delay));
+	/* Synapse ids are assigned per source, so the number of ids is one more
+	 * than the largest id. Each row is sorted by id. */
+#pragma omp parallel for default(shared) schedule(dynamic, ROW_CHUNK)
+	for(int64_t source=0; source < int64_t(sourceCount); ++source) {
+		size_t idCount = 0;
+		for(delay_t delay=1; delay <= m_maxDelay; ++delay) {
+			size_t addr = addressOf(nidx_t(source), delay);
+			if(m_rowOffset[addr+1] != m_rowOffset[addr]) {
+				idCount = std::max(idCount, size_t(id[m_rowOffset[addr+1]-1]) + 1);
 			}
-#endif
+		}
+		m_auxOffset[source+1] = idCount;
+	}
+
+	for(nidx_t source=0; source < sourceCount; ++source) {
+		m_auxOffset[source+1] += m_auxOffset[source];
+	}
 
-			std::map<fidx_t, row_t>::const_iterator row = m_acc.find(fidx_t(n, d));
-			if(row != m_acc.end()) {
-				verifySynapseTerminals(row->first, row->second, mapper, verifySources);
-				m_cm.at(addressOf(n,d)) = Row(row->second);
-			} else {
-				/* Insertion into map does not invalidate existing iterators */
-				m_cm.at(addressOf(n,d)) = Row(); // defaults to empty row
+	/* Any unused ids are left with invalid data */
+	m_aux.resize(m_auxOffset[sourceCount]);
+
+#pragma omp parallel for default(shared) schedule(dynamic, ROW_CHUNK)
+	for(int64_t source=0; source < int64_t(sourceCount); ++source) {
+		for(delay_t delay=1; delay <= m_maxDelay; ++delay) {
+			size_t addr = addressOf(nidx_t(source), delay);
+			size_t begin = m_rowOffset[addr];
+			for(size_t i=begin; i < m_rowOffset[addr+1]; ++i) {
+				m_aux[m_auxOffset[source] + id[i]] =
+					AxonTerminalAux(sidx_t(i - begin), delay, plastic[i] != 0);
 			}
-			//! \todo can delete the map now
 		}
 	}
 }
 
 
 
+/* The incoming index is built in two passes over the forward matrix: first
+ * count the indegree of each target, then fill in the synapses */
 void
-ConnectivityMatrix::verifySynapseTerminals(fidx_t idx,
-		const row_t& row,
-		const mapper_t& mapper,
-		bool verifySource) const
+ConnectivityMatrix::finalizeIncoming(unsigned neuronCount)
 {
-	using boost::format;
+	m_incomingOffset.assign(neuronCount+1, 0);
 
-	if(verifySource) {
-		nidx_t source = idx.get<0>();
-		if(!mapper.existingLocal(source)) {
-			throw nemo::exception(NEMO_INVALID_INPUT,
-				str(format("Invalid synapse source neuron %u") % source));
-		}
+	for(std::vector<FAxonTerminal>::const_iterator s = m_terminals.begin();
+			s != m_terminals.end(); ++s) {
+		m_incomingOffset.at(s->target+1) += 1;
 	}
 
-	for(size_t s=0; s < row.size(); ++s) {
-		nidx_t target = row.at(s).target;
-		if(!mapper.existingLocal(target)) {
-			throw nemo::exception(NEMO_INVALID_INPUT,
-					str(format("Invalid synapse target neuron %u (source: %u)") % target % idx.get<0>()));
+	for(unsigned n=0; n < neuronCount; ++n) {
+		m_incomingOffset[n+1] += m_incomingOffset[n];
+	}
+
+	m_incoming.resize(m_incomingOffset[neuronCount], IncomingTerminal(0, 0, NULL));
+	std::vector<size_t> next(m_incomingOffset.begin(), m_incomingOffset.end()-1);
+
+	/* Rows are stored in (source, delay) order, so this is the order of the
+	 * incoming synapses for each target as well */
+	for(size_t addr=0; addr < rowCount(); ++addr) {
+		nidx_t source = addr / m_maxDelay;
+		delay_t delay = addr % m_maxDelay + 1;
+		for(size_t s=m_rowOffset[addr]; s < m_rowOffset[addr+1]; ++s) {
+			const FAxonTerminal& terminal = m_terminals[s];
+			m_incoming[next[terminal.target]++] =
+				IncomingTerminal(source, delay, &terminal.weight);
 		}
 	}
 }
@@ -191,36 +528,95 @@ ConnectivityMatrix::verifySynapseTerminals(fidx_t idx,
 
 
 void
-ConnectivityMatrix::accumulateStdp(const std::vector<uint64_t>& recentFiring)
+ConnectivityMatrix::packForward(unsigned neuronCount)
 {
-	if(!m_stdp) {
+	/* Leave at least this many bits for the weight index */
+	const unsigned minWeightBits = 8;
+
+	if(m_terminals.empty()) {
 		return;
 	}
 
-	for(runtime::RCM::warp_iterator i = m_rcm->warp_begin();
-			i != m_rcm->warp_end(); i++) {
+	unsigned targetBits = 1;
+	while(targetBits < 32 && (1ULL << targetBits) < neuronCount) {
+		targetBits += 1;
+	}
+	if(32 - targetBits < minWeightBits) {
+		return;
+	}
+
+	std::vector<fix_t> table;
+	table.reserve(m_terminals.size());
+	for(std::vector<FAxonTerminal>::const_iterator s = m_terminals.begin();
+			s != m_terminals.end(); ++s) {
+		table.push_back(s->weight);
+	}
+	std::sort(table.begin(), table.end());
+	table.erase(std::unique(table.begin(), table.end()), table.end());
 
-		const nidx_t target = i->first;
-		const std::vector<size_t>& warps = i->second;
+	if(table.size() > (size_t(1) << (32 - targetBits))) {
+		return;
+	}
 
-		if(recentFiring[target] & m_stdp->postFireMask()) {
+	std::vector<uint32_t> packed;
+	packed.reserve(m_terminals.size());
+	for(std::vector<FAxonTerminal>::const_iterator s = m_terminals.begin();
+			s != m_terminals.end(); ++s) {
+		uint32_t widx = std::lower_bound(table.begin(), table.end(), s->weight) - table.begin();
+		packed.push_back((widx << targetBits) | s->target);
+	}
 
-			size_t remaining = m_rcm->indegree(target);
+	m_packed.swap(packed);
+	m_weightTable.swap(table);
+	std::vector<FAxonTerminal>().swap(m_terminals);
+	m_targetBits = targetBits;
+}
 
-			for(std::vector<size_t>::const_iterator wi = warps.begin();
-					wi != warps.end(); ++wi) {
 
-				const RSynapse* rdata_ptr = m_rcm->data(*wi);
-				fix_t* accumulator = m_rcm->accumulator(*wi);
 
-				for(signed s=0; s < m_rcm->WIDTH && remaining--; s++) {
-					const RSynapse& rdata = rdata_ptr[s];
-					uint64_t preFiring = recentFiring[rdata.source] >> rdata.delay;
-					fix_t w_diff = m_stdp->weightChange(preFiring, rdata.source, target);
-					if(w_diff != 0.0) {
-						accumulator[s] += w_diff;
-					}
-				}
+FAxonTerminal
+ConnectivityMatrix::terminal(nidx_t source, delay_t delay, sidx_t sidx) const
+{
+	if(packed()) {
+		const PackedRow row = getPackedRow(source, delay);
+		assert(sidx < row.len);
+		return FAxonTerminal(row.target(sidx), row.weight(sidx));
+	} else {
+		const Row row = getRow(source, delay);
+		assert(sidx < row.len);
+		return row[sidx];
+	}
+}
+
+
+
+void
+ConnectivityMatrix::accumulateStdp(const FiringHistory& history, nidx_t begin, nidx_t end)
+{
+	if(!m_stdp) {
+		return;
+	}
+
+	end = std::min(end, m_rcm->targetCount());
+
+	for(nidx_t target = begin; target < end; ++target) {
+
+		unsigned indegree = m_rcm->indegree(target);
+		if(indegree == 0 || !(history.window(target, 0) & m_stdp->postFireMask())) {
+			continue;
+		}
+
+		/* A target's warps are contiguous */
+		size_t warp = m_rcm->warp_begin(target);
+		const RSynapse* rdata = m_rcm->data(warp);
+		fix_t* accumulator = m_rcm->accumulator(warp);
+
+		for(unsigned s=0; s < indegree; s++) {
+			const RSynapse& rsynapse = rdata[s];
+			uint64_t preFiring = history.window(rsynapse.source, rsynapse.delay);
+			fix_t w_diff = m_stdp->weightChange(preFiring, rsynapse.source, target);
+			if(w_diff != 0.0) {
+				accumulator[s] += w_diff;
 			}
 		}
 	}
@@ -228,18 +624,47 @@ ConnectivityMatrix::accumulateStdp(const std::vector<uint64_t>& recentFiring)
 
 
 
-fix_t*
-ConnectivityMatrix::weight(const RSynapse& s, uint32_t sidx) const
+void
+ConnectivityMatrix::accumulateStdp(const FiringHistory& history)
 {
-	const Row& row = m_cm.at(addressOf(s.source, s.delay));
-	assert(sidx < row.len);
-	return &row.data[sidx].weight;
+	accumulateStdp(history, 0, m_rcm->targetCount());
 }
 
 
 
 void
-ConnectivityMatrix::applyStdp(float reward)
+ConnectivityMatrix::finalizeStdp()
+{
+	nidx_t target_end = m_rcm->targetCount();
+	if(target_end == 0) {
+		return;
+	}
+	m_stdpOffset.assign(m_rcm->warp_end(target_end-1) * runtime::RCM::WIDTH, 0);
+
+	for(nidx_t target=0; target < target_end; ++target) {
+
+		unsigned indegree = m_rcm->indegree(target);
+		if(indegree == 0) {
+			continue;
+		}
+
+		size_t warp = m_rcm->warp_begin(target);
+		const RSynapse* rdata = m_rcm->data(warp);
+		const uint32_t* forward = m_rcm->forward(warp);
+		size_t* offset = &m_stdpOffset[warp * runtime::RCM::WIDTH];
+
+		for(unsigned s=0; s < indegree; s++) {
+			size_t addr = addressOf(rdata[s].source, rdata[s].delay);
+			assert(m_rowOffset[addr] + forward[s] < m_rowOffset[addr+1]);
+			offset[s] = m_rowOffset[addr] + forward[s];
+		}
+	}
+}
+
+
+
+fix_t
+ConnectivityMatrix::stdpReward(float reward) const
 {
 	using boost::format;
 
@@ -253,41 +678,66 @@ ConnectivityMatrix::applyStdp(float reward)
 				str(format("STDP reward rounded down to zero. The smallest valid reward is %f")
 					% fx_toFloat(1U, m_fractionalBits)));
 	}
+	return fx_reward;
+}
 
-	if(fx_reward == 0) {
-		m_rcm->clearAccumulator();
-	}
 
-	for(runtime::RCM::warp_iterator i = m_rcm->warp_begin();
-			i != m_rcm->warp_end(); i++) {
 
-		const nidx_t target = i->first;
-		const std::vector<size_t>& warps = i->second;
-		size_t remaining = m_rcm->indegree(target);
+void
+ConnectivityMatrix::applyStdp(float reward)
+{
+	applyStdp(stdpReward(reward), 0, m_rcm->targetCount());
+}
+
+
+
+void
+ConnectivityMatrix::applyStdp(fix_t reward, nidx_t begin, nidx_t end)
+{
+	const unsigned width = runtime::RCM::WIDTH;
+	fix_t w_old[width];
+	fix_t w_diff[width];
+	fix_t w_new[width];
+
+	end = std::min(end, m_rcm->targetCount());
+
+	for(nidx_t target = begin; target < end; ++target) {
+
+		unsigned indegree = m_rcm->indegree(target);
+		if(indegree == 0) {
+			continue;
+		}
+
+		/* The synapses of a target are contiguous, and the offsets point
+		 * directly to the weights (see finalizeStdp). The weights are
+		 * gathered one warp at a time for the clamping. */
+		size_t warp = m_rcm->warp_begin(target);
+		const size_t* forward = &m_stdpOffset[warp * runtime::RCM::WIDTH];
+		fix_t* accumulator = m_rcm->accumulator(warp);
 
-		for(std::vector<size_t>::const_iterator wi = warps.begin();
-				wi != warps.end(); ++wi) {
+		for(unsigned base=0; base < indegree; base += width) {
 
-			const RSynapse* rdata_ptr = m_rcm->data(*wi);
-			const uint32_t* forward = m_rcm->forward(*wi);
-			fix_t* accumulator = m_rcm->accumulator(*wi);
+			unsigned n = std::min(width, indegree - base);
 
-			for(signed s=0; s < m_rcm->WIDTH && remaining--; s++) {
+			for(unsigned s=0; s < n; ++s) {
+				w_old[s] = m_terminals[forward[base+s]].weight;
+				w_diff[s] = fx_mul(reward, accumulator[base+s], m_fractionalBits);
+				accumulator[base+s] = 0;
+			}
 
-				const RSynapse& rsynapse = rdata_ptr[s];
-				fix_t* w_old = weight(rsynapse, forward[s]);
-				fix_t w_new = m_stdp->updatedWeight(*w_old, fx_mul(fx_reward, accumulator[s], m_fractionalBits));
+			m_stdp->updatedWeights(n, w_old, w_diff, w_new);
 
-				if(*w_old != w_new) {
+			for(unsigned s=0; s < n; ++s) {
 #ifdef DEBUG_TRACE
+				if(w_old[s] != w_new[s]) {
 					fprintf(stderr, "stdp (%u -> %u) %f %+f = %f\n",
-							rsynapse.source, target, fx_toFloat(*w_old, m_fractionalBits),
-							fx_toFloat(fx_mul(reward, accumulator[s], m_fractionalBits), m_fractionalBits),
-							fx_toFloat(w_new, m_fractionalBits));
-#endif
-					*w_old = w_new;
+							m_rcm->data(warp)[base+s].source, target,
+							fx_toFloat(w_old[s], m_fractionalBits),
+							fx_toFloat(w_diff[s], m_fractionalBits),
+							fx_toFloat(w_new[s], m_fractionalBits));
 				}
-				accumulator[s] = 0;
+#endif
+				m_terminals[forward[base+s]].weight = w_new[s];
 			}
 		}
 	}
@@ -305,20 +755,16 @@ ConnectivityMatrix::getSynapsesFrom(unsigned source)
 				"Cannot read synapse state if simulation configured with write-only synapses");
 	}
 
-	/* The relevant data is stored in the auxillary synapse map, which is
-	 * already indexed in global neuron indices. Therefore, no need to map into
-	 * local ids */
+	if(!m_mapper.existingGlobal(source)) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Non-existing source neuron id (%u) in synapse id query") % source));
+	}
+
+	/* Synapse ids are consecutive */
+	nidx_t l_source = m_mapper.localIdx(source);
 	size_t nSynapses = 0;
-	aux_map::const_iterator iRow = m_cmAux.find(source);
-	if(iRow == m_cmAux.end()) {
-		if(!m_mapper.existingGlobal(source)) {
-			throw nemo::exception(NEMO_INVALID_INPUT,
-					str(format("Non-existing source neuron id (%u) in synapse id query") % source));
-		}
-		/* else just leave nSynapses at zero */
-	} else {
-		/* Synapse ids are consecutive */
-		nSynapses = iRow->second.size();
+	if(size_t(l_source) + 1 < m_auxOffset.size()) {
+		nSynapses = m_auxOffset[l_source+1] - m_auxOffset[l_source];
 	}
 
 	m_queriedSynapseIds.resize(nSynapses);
@@ -332,14 +778,6 @@ ConnectivityMatrix::getSynapsesFrom(unsigned source)
 
 
 
-const Row&
-ConnectivityMatrix::getRow(nidx_t source, delay_t delay) const
-{
-	return m_cm.at(addressOf(source, delay));
-}
-
-
-
 const AxonTerminalAux&
 ConnectivityMatrix::axonTerminalAux(const synapse_id& id) const
 {
@@ -351,12 +789,20 @@ ConnectivityMatrix::axonTerminalAux(const synapse_id& id) const
 	}
 
 	nidx_t neuron = neuronIndex(id);
-	aux_map::const_iterator it = m_cmAux.find(neuron);
-	if(it == m_cmAux.end()) {
+	if(!m_mapper.existingGlobal(neuron)) {
 		throw nemo::exception(NEMO_INVALID_INPUT,
 				str(format("Non-existing neuron id (%u) in synapse query") % neuron));
 	}
-	return it->second.at(synapseIndex(id));
+
+	nidx_t l_source = m_mapper.localIdx(neuron);
+	size_t sidx = synapseIndex(id);
+	if(size_t(l_source) + 1 >= m_auxOffset.size()
+			|| sidx >= m_auxOffset[l_source+1] - m_auxOffset[l_source]) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Non-existing synapse id (neuron %u, synapse %u) in synapse query")
+					% neuron % sidx));
+	}
+	return m_aux[m_auxOffset[l_source] + sidx];
 }
 
 
@@ -366,7 +812,7 @@ ConnectivityMatrix::getTarget(const synapse_id& id) const
 {
 	const AxonTerminalAux& s = axonTerminalAux(id);
 	nidx_t l_source = m_mapper.localIdx(neuronIndex(id));
-	nidx_t l_target = m_cm[addressOf(l_source, s.delay)].data[s.idx].target;
+	nidx_t l_target = terminal(l_source, s.delay, s.idx).target;
 	return m_mapper.globalIdx(l_target);
 }
 
@@ -377,9 +823,7 @@ ConnectivityMatrix::getWeight(const synapse_id& id) const
 {
 	const AxonTerminalAux& s = axonTerminalAux(id);
 	nidx_t l_source = m_mapper.localIdx(neuronIndex(id));
-	const Row& row = m_cm[addressOf(l_source, s.delay)];
-	assert(s.idx < row.len);
-	fix_t w = row.data[s.idx].weight;
+	fix_t w = terminal(l_source, s.delay, s.idx).weight;
 	return fx_toFloat(w, m_fractionalBits);
 }
 
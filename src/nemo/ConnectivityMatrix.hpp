@@ -11,11 +11,8 @@
  */
 
 #include <vector>
-#include <map>
-#include <set>
+#include <cassert>
 
-#include <boost/tuple/tuple.hpp>
-#include <boost/shared_array.hpp>
 #include <boost/optional.hpp>
 #include <boost/scoped_ptr.hpp>
 
@@ -27,6 +24,7 @@
 #include "RandomMapper.hpp"
 #include "StdpProcess.hpp"
 #include "OutgoingDelays.hpp"
+#include "FiringHistory.hpp"
 
 #define ASSUMED_CACHE_LINE_SIZE 64
 
@@ -45,25 +43,63 @@ struct FAxonTerminal
 
 
 
+/* Synapse in the per-target incoming index used by target-driven spike
+ * delivery. The weight is referenced in the forward matrix, so that changes
+ * due to plasticity are seen regardless of the delivery engine. */
+struct IncomingTerminal
+{
+	IncomingTerminal(nidx_t s, delay_t d, const fix_t* w) :
+		source(s), delay(d), weight(w) {}
+
+	nidx_t source;
+	delay_t delay;
+	const fix_t* weight;
+};
+
+
+
 /* A row contains a number of synapses with a fixed source and delay. A
  * fixed-point format is used internally. The caller needs to specify the
- * format.  */
+ * format.
+ *
+ * The row is only a view into the connectivity matrix, which owns the data. */
 struct Row
 {
-	Row() : len(0) {}
+	Row() : len(0), data(NULL) {}
 
-	/* \post synapse order is the same as in input vector */
-	Row(const std::vector<FAxonTerminal>& ss);
+	Row(const FAxonTerminal* data, size_t len) : len(len), data(data) {}
 
 	size_t len;
-	//! \todo do own memory management here, and use raw pointers
-	boost::shared_array< FAxonTerminal> data;
+	const FAxonTerminal* data;
 
 	const FAxonTerminal& operator[](unsigned i) const { return data[i]; }
 };
 
 
 
+/* Row in the compact encoding of the forward matrix. Each synapse is packed
+ * into a single 32-bit word, with the target neuron in the low bits and an
+ * index into a table of distinct weights in the high bits.
+ *
+ * The row is only a view into the connectivity matrix, which owns the data. */
+struct PackedRow
+{
+	PackedRow() : len(0), data(NULL), weights(NULL), targetBits(0) {}
+
+	PackedRow(const uint32_t* data, size_t len, const fix_t* weights, unsigned targetBits) :
+		len(len), data(data), weights(weights), targetBits(targetBits) {}
+
+	size_t len;
+	const uint32_t* data;
+	const fix_t* weights;
+	unsigned targetBits;
+
+	nidx_t target(unsigned i) const { return data[i] & ~(~0U << targetBits); }
+	fix_t weight(unsigned i) const { return weights[data[i] >> targetBits]; }
+};
+
+
+
 namespace network {
 	class Generator;
 }
@@ -99,18 +135,26 @@ class NEMO_BASE_DLL_PUBLIC ConnectivityMatrix
 				const ConfigurationImpl& conf,
 				const mapper_t&);
 
-		/*! Add synapse with pre-mapped source and target
+		const std::vector<synapse_id>& getSynapsesFrom(unsigned neuron);
+
+		/*! \return all synapses for a given source and delay
 		 *
-		 * Add synapse but use the provided source and target values rather
-		 * than the ones provided in the underlying synapse. The caller can
-		 * thus provide an appropriate mapping of either index.
-		 */
-		sidx_t addSynapse(nidx_t source, nidx_t target, const Synapse&);
+		 * \pre !packed() */
+		Row getRow(nidx_t source, delay_t) const;
 
-		const std::vector<synapse_id>& getSynapsesFrom(unsigned neuron);
+		/*! \return true if the forward matrix uses the compact encoding. In
+		 * this case rows should be accessed via getPackedRow rather than
+		 * getRow. */
+		bool packed() const { return !m_weightTable.empty(); }
+
+		/*! \return all synapses for a given source and delay, in compact format
+		 *
+		 * \pre packed() */
+		PackedRow getPackedRow(nidx_t source, delay_t) const;
 
-		/*! \return all synapses for a given source and delay */
-		const Row& getRow(nidx_t source, delay_t) const;
+		/*! \return number of synapses for a given source and delay,
+		 * regardless of encoding */
+		size_t rowLength(nidx_t source, delay_t) const;
 
 		/*! \copydoc nemo::Simulation::getTarget */
 		unsigned getTarget(const synapse_id& synapse) const;
@@ -144,16 +188,64 @@ class NEMO_BASE_DLL_PUBLIC ConnectivityMatrix
 
 		delay_t maxDelay() const { return m_maxDelay; }
 
-		void accumulateStdp(const std::vector<uint64_t>& recentFiring);
+		/*! Accumulate STDP statistics for the most recent cycle
+		 *
+		 * \pre the firing for the most recent cycle has been recorded */
+		void accumulateStdp(const FiringHistory& history);
+
+		/*! Accumulate STDP statistics for the most recent cycle, for
+		 * synapses with (local) targets in the range [begin, end) only. Calls
+		 * for disjoint ranges may run concurrently.
+		 *
+		 * \pre the firing for the most recent cycle has been recorded */
+		void accumulateStdp(const FiringHistory& history, nidx_t begin, nidx_t end);
 
+		/*! \return true if STDP is enabled */
+		bool stdpEnabled() const { return m_stdp.is_initialized(); }
+
+		/*! Apply the accumulated STDP statistics to all plastic synapses,
+		 * and reset the statistics */
 		void applyStdp(float reward);
 
+		/*! \return reward converted to fixed-point format
+		 *
+		 * \throws nemo::exception if STDP is not enabled or if the reward
+		 * 		is too small to be represented */
+		fix_t stdpReward(float reward) const;
+
+		/*! Apply the accumulated STDP statistics as \a applyStdp, for synapses
+		 * with (local) targets in the range [begin, end) only. Calls for
+		 * disjoint ranges may run concurrently.
+		 *
+		 * \param reward fixed-point reward, see \a stdpReward */
+		void applyStdp(fix_t reward, nidx_t begin, nidx_t end);
+
 		/*! \return bit-mask indicating the delays at which the given neuron
 		 * has *any* outgoing synapses. If the source neuron is invalid 0 is
-		 * returned.
+		 * returned. See OutgoingDelays::delayBits regarding \a word.
 		 *
 		 * Only call this after finalize has been called. */
-		uint64_t delayBits(nidx_t l_source) const { return m_delays.delayBits(l_source); }
+		uint64_t delayBits(nidx_t l_source, unsigned word=0) const {
+			return m_delays.delayBits(l_source, word);
+		}
+
+		/*! \return true if the per-target incoming synapse index has been
+		 * constructed. This is only done if target-driven spike delivery is
+		 * configured. */
+		bool hasIncoming() const { return !m_incomingOffset.empty(); }
+
+		/*! \return pointer to the first incoming synapse for the given
+		 * (local) target neuron. Incoming synapses are ordered by source and
+		 * delay.
+		 *
+		 * \pre hasIncoming() */
+		const IncomingTerminal* incoming_begin(nidx_t target) const;
+
+		/*! \return pointer beyond the last incoming synapse for the given
+		 * (local) target neuron.
+		 *
+		 * \pre hasIncoming() */
+		const IncomingTerminal* incoming_end(nidx_t target) const;
 
 		/*! \return pointer to reverse connectivity matrix */
 		const runtime::RCM* rcm() const { return m_rcm.get(); }
@@ -164,58 +256,108 @@ class NEMO_BASE_DLL_PUBLIC ConnectivityMatrix
 
 		unsigned m_fractionalBits;
 
-		/* During network construction we accumulate data in a map. This way we
-		 * don't need to know the number of neurons or the number of delays in
-		 * advance */
-		typedef boost::tuple<nidx_t, delay_t> fidx_t;
-		typedef std::vector<FAxonTerminal> row_t;
-		std::map<fidx_t, row_t> m_acc;
+		/* All synapses are stored in a single contiguous array, ordered by
+		 * source and delay (i.e. CSR format). The synapses for the row at
+		 * linear address a (see addressOf) are found in the range
+		 * [m_rowOffset[a], m_rowOffset[a+1]). Within a row synapses are in
+		 * the order in which they were provided by the network. */
+		std::vector<size_t> m_rowOffset;
+		std::vector<FAxonTerminal> m_terminals;
+
+		/* Compact encoding of m_terminals. If the compact encoding is used
+		 * m_terminals is empty and the synapses are stored in m_packed
+		 * instead, using the same row offsets. Each word contains the target
+		 * in the lowest m_targetBits bits and an index into m_weightTable in
+		 * the remaining bits. */
+		std::vector<uint32_t> m_packed;
+		std::vector<fix_t> m_weightTable;
+		unsigned m_targetBits;
+
+		/*! Switch to the compact encoding of the forward matrix if the
+		 * network is small enough and has few enough distinct weights. The
+		 * weights of packed synapses cannot be modified, so this should only
+		 * be done if neither plasticity nor the incoming index are used.
+		 *
+		 * \pre finalizeForward has been called */
+		void packForward(unsigned neuronCount);
+
+		/*! \return a single synapse from the forward matrix, regardless of
+		 * encoding */
+		FAxonTerminal terminal(nidx_t source, delay_t, sidx_t) const;
+
+		/*! \return number of rows in the forward matrix */
+		size_t rowCount() const;
 
-		/* At run-time, however, we want a fast lookup of the rows. We
-		 * therefore use a vector with linear addressing.  */
-		std::vector<Row> m_cm;
-		void finalizeForward(const mapper_t&, bool verifySources);
+		/*! Build the forward matrix by reading the network twice: once to
+		 * count the synapses in each row, and once to fill in the rows of the
+		 * allocated matrix. Within each row synapses are sorted by id.
+		 *
+		 * \param id
+		 * \param plastic
+		 * 		on return contain the id and plasticity of each synapse in the
+		 * 		forward matrix
+		 * \return number of source neurons in the forward matrix
+		 */
+		nidx_t finalizeForward(const network::Generator& net,
+				std::vector<id32_t>& id,
+				std::vector<unsigned char>& plastic);
+
+		/*! Build the auxillary synapse data used for run-time queries
+		 *
+		 * \pre finalizeForward has been called */
+		void finalizeAux(const std::vector<id32_t>& id,
+				const std::vector<unsigned char>& plastic,
+				nidx_t sourceCount);
 
 		boost::scoped_ptr<runtime::RCM> m_rcm;
 
+		/* Direct offsets into \a m_terminals of the synapses in the reverse
+		 * matrix, laid out in the same warps. These are 64-bit so that STDP
+		 * is not limited in the size of the forward matrix. Empty unless STDP
+		 * is enabled. */
+		std::vector<size_t> m_stdpOffset;
+
+		/* Per-target incoming synapses, for target-driven spike delivery.
+		 * Stored in CSR format, with m_incomingOffset[n] pointing to the
+		 * first synapse for target n in m_incoming. Both are empty unless
+		 * target-driven delivery is used. */
+		std::vector<size_t> m_incomingOffset;
+		std::vector<IncomingTerminal> m_incoming;
+
+		/*! Build the incoming synapse index from the forward matrix
+		 *
+		 * \pre finalizeForward has been called */
+		void finalizeIncoming(unsigned neuronCount);
+
 		boost::optional<StdpProcess> m_stdp;
 
-		OutgoingDelaysAcc m_delaysAcc;
 		OutgoingDelays m_delays;
 		delay_t m_maxDelay;
 
 		/*! \return linear index into CM, based on 2D index (neuron,delay) */
 		size_t addressOf(nidx_t, delay_t) const;
 
-		void verifySynapseTerminals(fidx_t idx,
-				const row_t& row, const mapper_t&, bool verifySource) const;
-
-		/*! Get address to synapse weight
-		 *
-		 * \return address of the synapse weight in the forward matrix, given
-		 * 		a synapse in the reverse matrix
+		/*! Compute direct offsets into \a m_terminals from the forward
+		 * addresses of the reverse matrix, which are indices within a row of
+		 * the forward matrix. The weight of a plastic synapse can then be
+		 * updated without any lookup.
 		 *
-		 * \param rdata source/delay
-		 * \param sidx synapse index within synapse groups for given postsynaptic neuron
-		 */
-		fix_t* weight(const RSynapse& rdata, uint32_t sidx) const;
+		 * \pre finalizeForward has been called and the forward matrix is
+		 * 		not packed */
+		void finalizeStdp();
 
 		/* Internal buffers for synapse queries */
 		std::vector<synapse_id> m_queriedSynapseIds;
 
-		/*! \todo We could save both time and space here by doing the same as
-		 * in the cuda backend, namely
-		 *
-		 * 1. making use of the writeOnlySynapses flag
-		 * 2. make the aux_map use unordered_map
-		 */
-
 		/* Additional synapse data which is only needed for runtime queries.
-		 * This is kept separate from m_cm so that we can make m_cm fast and
-		 * compact. The query information is not crucial for performance.  */
-		typedef std::vector<AxonTerminalAux> aux_row;
-		typedef std::map<nidx_t, aux_row> aux_map;
-		aux_map m_cmAux;
+		 * This is kept separate from the forward matrix so that we can make
+		 * it fast and compact. The query information is not crucial for
+		 * performance. The data is stored in CSR format indexed by local
+		 * source neuron, with the synapses of each source found in
+		 * [m_auxOffset[n], m_auxOffset[n+1]) ordered by synapse id. Both are
+		 * empty if the simulation uses write-only synapses. */
+		std::vector<size_t> m_auxOffset;
+		std::vector<AxonTerminalAux> m_aux;
 
 		/* Look up auxillary synapse data and report invalid lookups */
 		const AxonTerminalAux& axonTerminalAux(const synapse_id&) const;
@@ -225,6 +367,32 @@ class NEMO_BASE_DLL_PUBLIC ConnectivityMatrix
 
 
 
+inline
+const IncomingTerminal*
+ConnectivityMatrix::incoming_begin(nidx_t target) const
+{
+	assert(target + 1 < m_incomingOffset.size());
+	if(m_incoming.empty()) {
+		return NULL;
+	}
+	return &m_incoming[0] + m_incomingOffset[target];
+}
+
+
+
+inline
+const IncomingTerminal*
+ConnectivityMatrix::incoming_end(nidx_t target) const
+{
+	assert(target + 1 < m_incomingOffset.size());
+	if(m_incoming.empty()) {
+		return NULL;
+	}
+	return &m_incoming[0] + m_incomingOffset[target+1];
+}
+
+
+
 inline
 size_t
 ConnectivityMatrix::addressOf(nidx_t source, delay_t delay) const
@@ -234,6 +402,56 @@ ConnectivityMatrix::addressOf(nidx_t source, delay_t delay) const
 
 
 
+inline
+size_t
+ConnectivityMatrix::rowCount() const
+{
+	return m_rowOffset.empty() ? 0 : m_rowOffset.size() - 1;
+}
+
+
+
+inline
+size_t
+ConnectivityMatrix::rowLength(nidx_t source, delay_t delay) const
+{
+	size_t addr = addressOf(source, delay);
+	return addr < rowCount() ? m_rowOffset[addr+1] - m_rowOffset[addr] : 0;
+}
+
+
+
+inline
+Row
+ConnectivityMatrix::getRow(nidx_t source, delay_t delay) const
+{
+	assert(!packed());
+	size_t addr = addressOf(source, delay);
+	if(addr >= rowCount()) {
+		return Row();
+	}
+	size_t begin = m_rowOffset[addr];
+	return Row(&m_terminals[0] + begin, m_rowOffset[addr+1] - begin);
+}
+
+
+
+inline
+PackedRow
+ConnectivityMatrix::getPackedRow(nidx_t source, delay_t delay) const
+{
+	assert(packed());
+	size_t addr = addressOf(source, delay);
+	if(addr >= rowCount()) {
+		return PackedRow();
+	}
+	size_t begin = m_rowOffset[addr];
+	return PackedRow(&m_packed[0] + begin, m_rowOffset[addr+1] - begin,
+			&m_weightTable[0], m_targetBits);
+}
+
+
+
 /* The parts of the synapse data is only needed if querying synapses at
  * run-time. This data is stored separately */
 struct AxonTerminalAux
@@ -20,12 +20,26 @@ FiringBuffer::addFiredNeuron(unsigned neuron)
 
 
 
+void
+FiringBuffer::addFiredNeurons(const std::vector<unsigned>& neurons)
+{
+	std::vector<unsigned>& fired = m_fired.back();
+	fired.insert(fired.end(), neurons.begin(), neurons.end());
+}
+
+
+
 
 void
 FiringBuffer::enqueueCycle()
 {
 	m_oldestCycle += 1;
 	m_fired.push_back(std::vector<unsigned>());
+	if(!m_spare.empty()) {
+		m_fired.back().swap(m_spare.back());
+		m_spare.pop_back();
+		m_fired.back().clear();
+	}
 }
 
 
@@ -36,6 +50,8 @@ FiringBuffer::dequeueCycle()
 	if(m_fired.size() < 2) {
 		throw nemo::exception(NEMO_BUFFER_UNDERFLOW, "Firing buffer underflow");
 	}
+	m_spare.push_back(std::vector<unsigned>());
+	m_spare.back().swap(m_fired.front());
 	m_fired.pop_front();
 	return FiredList(m_oldestCycle, m_fired.front());
 }
@@ -36,6 +36,9 @@ class NEMO_BASE_DLL_PUBLIC FiringBuffer
 
 		void addFiredNeuron(unsigned neuron);
 
+		/*! Add several fired neurons to the current cycle's firing vector */
+		void addFiredNeurons(const std::vector<unsigned>& neurons);
+
 		/*! Discard the current oldest cycle's data and return reference to the
 		 * new oldest cycle's data. The data referenced in the returned list of
 		 * firings is valid until the next call to \a read or \a dequeue. */
@@ -45,6 +48,10 @@ class NEMO_BASE_DLL_PUBLIC FiringBuffer
 
 		std::deque< std::vector<unsigned> > m_fired;
 
+		/* Storage from dequeued cycles, re-used for new cycles to avoid
+		 * allocating new firing vectors every cycle */
+		std::vector< std::vector<unsigned> > m_spare;
+
 		cycle_t m_oldestCycle;
 };
 
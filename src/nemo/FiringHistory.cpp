@@ -0,0 +1,40 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of nemo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FiringHistory.hpp"
+
+namespace nemo {
+
+
+FiringHistory::FiringHistory(size_t neuronCount, unsigned maxDelay) :
+	/* Enough words to cover the maximum delay, plus one so that a full
+	 * window can be extracted at the maximum delay */
+	m_wordsPerNeuron((maxDelay + 63) / 64 + 1),
+	m_length(m_wordsPerNeuron * 64),
+	m_head(0)
+{
+	m_words.resize(neuronCount * m_wordsPerNeuron, 0);
+}
+
+
+
+bool
+FiringHistory::any(nidx_t neuron, unsigned begin, unsigned end) const
+{
+	assert(end <= m_length);
+	for(unsigned age = begin; age < end; age += 64) {
+		uint64_t bits = end - age >= 64 ? window(neuron, age) : window(neuron, age) & ~(~uint64_t(0) << (end - age));
+		if(bits) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
@@ -0,0 +1,113 @@
+#ifndef NEMO_FIRING_HISTORY_HPP
+#define NEMO_FIRING_HISTORY_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of nemo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <cassert>
+
+#include <nemo/config.h>
+#include <nemo/internal_types.h>
+
+namespace nemo {
+
+
+/*! \brief Per-neuron firing history of arbitrary length
+ *
+ * The history for each neuron is a circular bit-vector, with the most recent
+ * cycle at the head. Recording a new cycle only moves the head, so the cost
+ * of a cycle does not depend on the length of the history. Queries are made
+ * relative to the most recently recorded cycle, using the same bit order as
+ * the 64-bit firing history used by the neuron models: bit k is set if the
+ * neuron fired k cycles before the most recent cycle.
+ */
+class NEMO_BASE_DLL_PUBLIC FiringHistory
+{
+	public :
+
+		/*! Create an empty firing history
+		 *
+		 * \param neuronCount number of (local) neurons
+		 * \param maxDelay
+		 * 		maximum delay of any synapse. The history is long enough to
+		 * 		extract a full 64-bit window starting at any delay up to this.
+		 */
+		FiringHistory(size_t neuronCount, unsigned maxDelay);
+
+		/*! Start recording a new cycle. Every neuron's firing should then be
+		 * recorded using \a record before the history is queried */
+		void advance() {
+			m_head = m_head == 0 ? m_length - 1 : m_head - 1;
+		}
+
+		/*! Record the firing of a single neuron in the current cycle */
+		void record(nidx_t neuron, bool fired) {
+			uint64_t& word = m_words[neuron * m_wordsPerNeuron + (m_head >> 6)];
+			uint64_t bit = uint64_t(1) << (m_head & 0x3f);
+			word = fired ? word | bit : word & ~bit;
+		}
+
+		/*! \return true if the neuron fired \a age cycles before the most
+		 * recent cycle */
+		bool fired(nidx_t neuron, unsigned age) const {
+			size_t pos = position(age);
+			return (m_words[neuron * m_wordsPerNeuron + (pos >> 6)] >> (pos & 0x3f)) & 0x1;
+		}
+
+		/*! \return 64 cycles worth of firing, starting \a age cycles before the
+		 * most recent cycle. Bit i is set if the neuron fired age+i cycles
+		 * before the most recent cycle.
+		 *
+		 * \pre age + 64 <= length()
+		 */
+		uint64_t window(nidx_t neuron, unsigned age) const {
+			assert(age + 64 <= m_length);
+			size_t pos = position(age);
+			const uint64_t* words = &m_words[neuron * m_wordsPerNeuron];
+			size_t w = pos >> 6;
+			unsigned offset = pos & 0x3f;
+			uint64_t bits = words[w] >> offset;
+			if(offset) {
+				size_t next = w + 1 == m_wordsPerNeuron ? 0 : w + 1;
+				bits |= words[next] << (64 - offset);
+			}
+			return bits;
+		}
+
+		/*! \return true if the neuron fired at least once between \a begin
+		 * (inclusive) and \a end (exclusive) cycles before the most recent
+		 * cycle */
+		bool any(nidx_t neuron, unsigned begin, unsigned end) const;
+
+		/*! \return number of cycles stored */
+		size_t length() const { return m_length; }
+
+	private :
+
+		std::vector<uint64_t> m_words;
+
+		size_t m_wordsPerNeuron;
+
+		/* Number of cycles stored (a multiple of 64) */
+		size_t m_length;
+
+		/* Bit position of the most recent cycle. Older cycles are found at
+		 * increasing positions, modulo the length. */
+		size_t m_head;
+
+		size_t position(unsigned age) const {
+			size_t pos = m_head + age;
+			return pos >= m_length ? pos - m_length : pos;
+		}
+};
+
+}
+
+#endif
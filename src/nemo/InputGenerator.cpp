@@ -0,0 +1,148 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "InputGenerator.hpp"
+
+#include <cmath>
+#include <boost/format.hpp>
+
+#include "RNG.hpp"
+#include "exception.hpp"
+#include "util.h"
+
+namespace nemo {
+
+
+float
+InputGenerator::uniform(RNG* rng)
+{
+	return float(urand(rng) >> 8) * (1.0f / float(1 << 24));
+}
+
+
+float
+InputGenerator::normal(RNG* rng)
+{
+	return nrand(rng);
+}
+
+
+
+/* Phase (in radians) of a sinusoid of the given frequency at the start of a
+ * cycle. The cycle count is reduced modulo the period in double precision, so
+ * that the phase stays accurate during long simulations. */
+static
+double
+cyclePhase(unsigned long cycle, float frequency)
+{
+	double periods = double(cycle) * double(frequency) / 1000.0;
+	return 2.0 * M_PI * (periods - std::floor(periods));
+}
+
+
+
+SinusoidalInput::SinusoidalInput(float amplitude, float frequency, float phase, float offset) :
+	m_amplitude(amplitude),
+	m_frequency(frequency),
+	m_phase(phase),
+	m_offset(offset)
+{
+	;
+}
+
+
+InputGenerator*
+SinusoidalInput::clone() const
+{
+	return new SinusoidalInput(*this);
+}
+
+
+float
+SinusoidalInput::current(unsigned long cycle, float /* state */[], RNG* /* rng */) const
+{
+	return m_offset + m_amplitude * float(std::sin(cyclePhase(cycle, m_frequency) + m_phase));
+}
+
+
+
+OrnsteinUhlenbeckInput::OrnsteinUhlenbeckInput(float mean, float sigma, float tau) :
+	m_mean(mean)
+{
+	using boost::format;
+	if(tau <= 0.0f) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Ornstein-Uhlenbeck input requires a positive time constant (%f given)") % tau));
+	}
+	double decay = std::exp(-1.0 / tau);
+	m_decay = float(decay);
+	m_noise = float(sigma * std::sqrt(1.0 - decay * decay));
+}
+
+
+InputGenerator*
+OrnsteinUhlenbeckInput::clone() const
+{
+	return new OrnsteinUhlenbeckInput(*this);
+}
+
+
+void
+OrnsteinUhlenbeckInput::initState(float state[]) const
+{
+	state[0] = m_mean;
+}
+
+
+float
+OrnsteinUhlenbeckInput::current(unsigned long /* cycle */, float state[], RNG* rng) const
+{
+	float& x = state[0];
+	x = m_mean + (x - m_mean) * m_decay + m_noise * normal(rng);
+	return x;
+}
+
+
+
+PoissonInput::PoissonInput(float rate, float weight, float depth, float frequency) :
+	m_rate(rate),
+	m_weight(weight),
+	m_depth(depth),
+	m_frequency(frequency)
+{
+	using boost::format;
+	if(rate < 0.0f) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Poisson input requires a non-negative rate (%f given)") % rate));
+	}
+	if(depth < 0.0f || depth > 1.0f) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Poisson input modulation depth should be in the range [0, 1] (%f given)") % depth));
+	}
+}
+
+
+InputGenerator*
+PoissonInput::clone() const
+{
+	return new PoissonInput(*this);
+}
+
+
+float
+PoissonInput::current(unsigned long cycle, float /* state */[], RNG* rng) const
+{
+	float rate = m_rate;
+	if(m_depth != 0.0f) {
+		rate *= 1.0f + m_depth * float(std::sin(cyclePhase(cycle, m_frequency)));
+	}
+	return uniform(rng) < rate * 0.001f ? m_weight : 0.0f;
+}
+
+}
@@ -0,0 +1,177 @@
+#ifndef NEMO_INPUT_GENERATOR_HPP
+#define NEMO_INPUT_GENERATOR_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <nemo/config.h>
+
+struct RNG;
+
+namespace nemo {
+
+
+/*! \class InputGenerator
+ *
+ * \brief Time-varying input current evaluated by the simulation
+ *
+ * An input generator provides external input current to a population of
+ * neurons, as an alternative to computing the current on the host and
+ * passing it to \a Simulation::step every cycle. Generators are registered
+ * using \a Simulation::addInputGenerator. The simulation then evaluates the
+ * generator for each target neuron during every simulation step, with
+ * separate state and a separate random number stream for each target.
+ *
+ * New generators are created by subclassing. \a current is called
+ * concurrently for different target neurons, so should only modify the
+ * per-target state which is passed in.
+ *
+ * \ingroup cpp-api
+ */
+class NEMO_BASE_DLL_PUBLIC InputGenerator
+{
+	public :
+
+		virtual ~InputGenerator() { }
+
+		/*! \return a copy of this generator */
+		virtual InputGenerator* clone() const = 0;
+
+		/*! \return number of state variables for each target neuron */
+		virtual unsigned stateCount() const { return 0; }
+
+		/*! Set the initial state for a single target neuron
+		 *
+		 * \param state array of length \a stateCount
+		 */
+		virtual void initState(float /* state */[]) const { }
+
+		/*! \return input current for a single target neuron for the given cycle
+		 *
+		 * \param cycle simulation cycle (1ms each) for which input is provided
+		 * \param state per-target state (\a stateCount values), updated in place
+		 * \param rng per-target random number generator state
+		 */
+		virtual float current(unsigned long cycle, float state[], RNG* rng) const = 0;
+
+	protected :
+
+		/*! \return uniform random number in [0, 1) */
+		static float uniform(RNG* rng);
+
+		/*! \return normal random number drawn from N(0, 1) */
+		static float normal(RNG* rng);
+};
+
+
+
+/*! \brief Sinusoidal input current
+ *
+ * The current is offset + amplitude * sin(2 pi frequency t + phase), where t
+ * is the simulation time in seconds.
+ */
+class NEMO_BASE_DLL_PUBLIC SinusoidalInput : public InputGenerator
+{
+	public :
+
+		/*!
+		 * \param amplitude peak amplitude of the sinusoid
+		 * \param frequency frequency in Hz
+		 * \param phase phase (in radians) at time 0
+		 * \param offset constant current added to the sinusoid
+		 */
+		SinusoidalInput(float amplitude, float frequency,
+				float phase=0.0f, float offset=0.0f);
+
+		InputGenerator* clone() const;
+
+		float current(unsigned long cycle, float state[], RNG* rng) const;
+
+	private :
+
+		float m_amplitude;
+		float m_frequency;
+		float m_phase;
+		float m_offset;
+};
+
+
+
+/*! \brief Noisy input current following an Ornstein-Uhlenbeck process
+ *
+ * The current relaxes towards \a mean with time constant \a tau, while being
+ * driven by white noise such that the stationary standard deviation is \a
+ * sigma. The process is updated using its exact discretisation at 1ms time
+ * steps, and starts at the mean.
+ */
+class NEMO_BASE_DLL_PUBLIC OrnsteinUhlenbeckInput : public InputGenerator
+{
+	public :
+
+		/*!
+		 * \param mean mean current
+		 * \param sigma stationary standard deviation of the current
+		 * \param tau time constant in ms
+		 */
+		OrnsteinUhlenbeckInput(float mean, float sigma, float tau);
+
+		InputGenerator* clone() const;
+
+		unsigned stateCount() const { return 1; }
+
+		void initState(float state[]) const;
+
+		float current(unsigned long cycle, float state[], RNG* rng) const;
+
+	private :
+
+		float m_mean;
+
+		/* Per-step decay factor and noise amplitude */
+		float m_decay;
+		float m_noise;
+};
+
+
+
+/*! \brief Input current pulses arriving as a (rate-modulated) Poisson process
+ *
+ * During each 1ms cycle a pulse of the given \a weight is provided with
+ * probability rate(t) / 1000, where rate(t) = rate * (1 + depth * sin(2 pi
+ * frequency t)) with t the simulation time in seconds. At most one pulse is
+ * provided per cycle, so the rate should be well below 1kHz.
+ */
+class NEMO_BASE_DLL_PUBLIC PoissonInput : public InputGenerator
+{
+	public :
+
+		/*!
+		 * \param rate mean rate in Hz
+		 * \param weight current provided by each pulse
+		 * \param depth modulation depth, in the range [0, 1]
+		 * \param frequency modulation frequency in Hz
+		 */
+		PoissonInput(float rate, float weight,
+				float depth=0.0f, float frequency=0.0f);
+
+		InputGenerator* clone() const;
+
+		float current(unsigned long cycle, float state[], RNG* rng) const;
+
+	private :
+
+		float m_rate;
+		float m_weight;
+		float m_depth;
+		float m_frequency;
+};
+
+}
+
+#endif
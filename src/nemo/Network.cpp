@@ -11,6 +11,7 @@
 
 #include "NetworkImpl.hpp"
 #include "synapse_indices.hpp"
+#include "network/mapped/write.hpp"
 
 namespace nemo {
 
@@ -43,6 +44,14 @@ Network::addNeuron(unsigned type, unsigned idx,
 }
 
 
+void
+Network::addNeurons(unsigned type, size_t count, const unsigned idx[],
+		unsigned nargs, const float* const args[])
+{
+	m_impl->addNeurons(type, count, idx, nargs, args);
+}
+
+
 void
 Network::addNeuron(unsigned idx,
 		float a, float b, float c, float d,
@@ -119,6 +128,20 @@ Network::addSynapse(
 
 
 
+void
+Network::addSynapses(size_t count,
+		const unsigned sources[],
+		const unsigned targets[],
+		const unsigned delays[],
+		const float weights[],
+		const unsigned char plastic[],
+		synapse_id ids[])
+{
+	m_impl->addSynapses(count, sources, targets, delays, weights, plastic, ids);
+}
+
+
+
 unsigned
 Network::getSynapseTarget(const synapse_id& id) const
 {
@@ -188,4 +211,12 @@ Network::neuronCount() const
 }
 
 
+
+void
+Network::save(const std::string& filename) const
+{
+	network::mapped::write(*m_impl, filename);
+}
+
+
 } // end namespace nemo
@@ -26,6 +26,9 @@ namespace mpi {
 namespace network {
 	class NetworkImpl;
 
+	namespace procedural {
+		class Generator;
+	}
 }
 
 class Simulation;
@@ -75,6 +78,29 @@ class NEMO_BASE_DLL_PUBLIC Network : public ReadableNetwork
 		void addNeuron(unsigned type, unsigned idx,
 				unsigned nargs, const float args[]);
 
+		/*! \brief Add several neurons of the same type to the network
+		 *
+		 * This is equivalent to calling \a addNeuron for each neuron, but is
+		 * faster when adding many neurons.
+		 *
+		 * \param type
+		 * 		index of the neuron type, as returned by \a addNeuronType
+		 * \param count
+		 * 		number of neurons
+		 * \param idx
+		 * 		indices of the neurons (length \a count)
+		 * \param nargs
+		 * 		length of \a args
+		 * \param args
+		 * 		one array of length \a count for each parameter followed by one
+		 * 		for each state variable (in that order)
+		 *
+		 * \pre The number of parameter and state arrays must match the neuron
+		 * 		type represented by \a type.
+		 */
+		void addNeurons(unsigned type, size_t count, const unsigned idx[],
+				unsigned nargs, const float* const args[]);
+
 		/*! \brief Add a single Izhikevich neuron to the network
 		 *
 		 * The neuron uses the Izhikevich neuron model. See E. M. Izhikevich
@@ -142,6 +168,24 @@ class NEMO_BASE_DLL_PUBLIC Network : public ReadableNetwork
 				float weight,
 				unsigned char plastic);
 
+		/*! \brief Add several synapses to the network
+		 *
+		 * This is equivalent to calling \a addSynapse for each synapse, but
+		 * is faster when adding many synapses. All input arrays have length
+		 * \a count. If any delay is invalid no synapses are added.
+		 *
+		 * \param[out] ids
+		 * 		array of length \a count which is set to the ids of the new
+		 * 		synapses, or NULL if the ids are not required.
+		 */
+		void addSynapses(size_t count,
+				const unsigned sources[],
+				const unsigned targets[],
+				const unsigned delays[],
+				const float weights[],
+				const unsigned char plastic[],
+				synapse_id ids[] = NULL);
+
 
 		/*! Get a single parameter for a single neuron
 		 *
@@ -207,10 +251,22 @@ class NEMO_BASE_DLL_PUBLIC Network : public ReadableNetwork
 		/*! \copydoc nemo::network::Generator::maxDelay */
 		unsigned neuronCount() const;
 
+		/*! Write the network to a file in NeMo's binary network format,
+		 * replacing any existing file
+		 *
+		 * A simulation can be created directly from the file, without first
+		 * loading the network, via
+		 * \a nemo::simulation(const std::string&, const Configuration&).
+		 *
+		 * \throws nemo::exception if the file cannot be written
+		 */
+		void save(const std::string& filename) const;
+
 	private :
 
 		friend SimulationBackend* simulationBackend(const Network&, const Configuration&);
 		friend class nemo::mpi::Master;
+		friend class nemo::network::procedural::Generator;
 
 		class network::NetworkImpl* m_impl;
 
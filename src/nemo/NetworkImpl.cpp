@@ -93,6 +93,29 @@ NetworkImpl::addNeuron(unsigned type_id, unsigned g_idx,
 
 
 
+void
+NetworkImpl::addNeurons(unsigned type_id, size_t count, const unsigned g_idx[],
+		unsigned nargs, const float* const args[])
+{
+	if(nargs > NEMO_MAX_NEURON_ARGS) {
+		throw nemo::exception(NEMO_INVALID_INPUT, "Too many neuron parameters/state variables");
+	}
+
+	Neurons& neurons = neuronCollection(type_id);
+	neurons.reserve(neurons.size() + count);
+
+	float neuronArgs[NEMO_MAX_NEURON_ARGS];
+
+	for(size_t n=0; n < count; ++n) {
+		for(unsigned i=0; i < nargs; ++i) {
+			neuronArgs[i] = args[i][n];
+		}
+		addNeuron(type_id, g_idx[n], nargs, neuronArgs);
+	}
+}
+
+
+
 void
 NetworkImpl::setNeuron(unsigned nidx, unsigned nargs, const float args[])
 {
@@ -117,7 +140,7 @@ NetworkImpl::addSynapse(
 				str(format("Invalid delay (%u) for synapse between %u and %u") % delay % source % target));
 	}
 
-	id32_t id = m_fcm[source].addSynapse(target, delay, weight, plastic != 0);
+	id32_t id = m_synapses.add(source, target, delay, weight, plastic != 0);
 
 	//! \todo make sure we don't have maxDelay in cuda::ConnectivityMatrix
 	m_maxIdx = std::max(m_maxIdx, int(std::max(source, target)));
@@ -131,6 +154,46 @@ NetworkImpl::addSynapse(
 
 
 
+void
+NetworkImpl::addSynapses(size_t count,
+		const unsigned sources[],
+		const unsigned targets[],
+		const unsigned delays[],
+		const float weights[],
+		const unsigned char plastic[],
+		synapse_id ids[])
+{
+	using boost::format;
+
+	/* Validate all the input before modifying the network */
+	for(size_t s=0; s < count; ++s) {
+		if(delays[s] < 1) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Invalid delay (%u) for synapse between %u and %u")
+						% delays[s] % sources[s] % targets[s]));
+		}
+	}
+
+	m_synapses.reserve(count);
+
+	for(size_t s=0; s < count; ++s) {
+		unsigned source = sources[s];
+		unsigned target = targets[s];
+		float weight = weights[s];
+		id32_t id = m_synapses.add(source, target, delays[s], weight, plastic[s] != 0);
+		if(ids != NULL) {
+			ids[s] = make_synapse_id(source, id);
+		}
+		m_maxIdx = std::max(m_maxIdx, int(std::max(source, target)));
+		m_minIdx = std::min(m_minIdx, int(std::min(source, target)));
+		m_maxDelay = std::max(m_maxDelay, delays[s]);
+		m_maxWeight = std::max(m_maxWeight, weight);
+		m_minWeight = std::min(m_minWeight, weight);
+	}
+}
+
+
+
 float
 NetworkImpl::getNeuronState(unsigned nidx, unsigned var) const
 {
@@ -167,24 +230,10 @@ NetworkImpl::setNeuronParameter(unsigned nidx, unsigned parameter, float val)
 
 
 
-const Axon&
-NetworkImpl::axon(nidx_t source) const
-{
-	using boost::format;
-	fcm_t::const_iterator i_src = m_fcm.find(source);
-	if(i_src == m_fcm.end()) {
-		throw nemo::exception(NEMO_INVALID_INPUT,
-				str(format("synapses of non-existing neuron (%u) requested") % source));
-	}
-	return i_src->second;
-}
-
-
-
 unsigned
 NetworkImpl::getSynapseTarget(const synapse_id& id) const
 {
-	return axon(neuronIndex(id)).getTarget(synapseIndex(id));
+	return m_synapses.target(m_synapses.find(neuronIndex(id), synapseIndex(id)));
 }
 
 
@@ -192,7 +241,7 @@ NetworkImpl::getSynapseTarget(const synapse_id& id) const
 unsigned
 NetworkImpl::getSynapseDelay(const synapse_id& id) const
 {
-	return axon(neuronIndex(id)).getDelay(synapseIndex(id));
+	return m_synapses.delay(m_synapses.find(neuronIndex(id), synapseIndex(id)));
 }
 
 
@@ -200,7 +249,7 @@ NetworkImpl::getSynapseDelay(const synapse_id& id) const
 float
 NetworkImpl::getSynapseWeight(const synapse_id& id) const
 {
-	return axon(neuronIndex(id)).getWeight(synapseIndex(id));
+	return m_synapses.weight(m_synapses.find(neuronIndex(id), synapseIndex(id)));
 }
 
 
@@ -208,7 +257,7 @@ NetworkImpl::getSynapseWeight(const synapse_id& id) const
 unsigned char
 NetworkImpl::getSynapsePlastic(const synapse_id& id) const
 {
-	return axon(neuronIndex(id)).getPlastic(synapseIndex(id));
+	return m_synapses.plastic(m_synapses.find(neuronIndex(id), synapseIndex(id)));
 }
 
 
@@ -216,12 +265,7 @@ NetworkImpl::getSynapsePlastic(const synapse_id& id) const
 const std::vector<synapse_id>&
 NetworkImpl::getSynapsesFrom(unsigned source)
 {
-	fcm_t::const_iterator i_src = m_fcm.find(source);
-	if(i_src == m_fcm.end()) {
-		m_queriedSynapseIds.clear();
-	} else {
-		i_src->second.setSynapseIds(source, m_queriedSynapseIds);
-	}
+	m_synapses.setSynapseIds(source, m_queriedSynapseIds);
 	return m_queriedSynapseIds;
 }
 
@@ -310,31 +354,14 @@ NetworkImpl::neuron_end(unsigned id) const
 synapse_iterator
 NetworkImpl::synapse_begin() const
 {
-	fcm_t::const_iterator ni = m_fcm.begin();
-	fcm_t::const_iterator ni_end = m_fcm.end();
-
-	size_t gi = 0;
-	size_t gi_end = 0;
-
-	if(ni != ni_end) {
-		gi_end = ni->second.size();
-	}
-	return synapse_iterator(
-		new programmatic::synapse_iterator(ni, ni_end, gi, gi_end));
+	return synapse_iterator(new programmatic::synapse_iterator(m_synapses, 0));
 }
 
 
 synapse_iterator
 NetworkImpl::synapse_end() const
 {
-	fcm_t::const_iterator ni = m_fcm.end();
-	size_t gi = 0;
-
-	if(m_fcm.begin() != ni) {
-		gi = m_fcm.rbegin()->second.size();
-	}
-
-	return synapse_iterator(new programmatic::synapse_iterator(ni, ni, gi, gi));
+	return synapse_iterator(new programmatic::synapse_iterator(m_synapses, m_synapses.size()));
 }
 
 
@@ -16,10 +16,10 @@
 
 #include <nemo/config.h>
 #include <nemo/network/Generator.hpp>
-#include "Axon.hpp"
 #include "Neurons.hpp"
 #include "ReadableNetwork.hpp"
 #include "RandomMapper.hpp"
+#include "Synapses.hpp"
 
 namespace nemo {
 
@@ -42,6 +42,10 @@ class NEMO_BASE_DLL_PUBLIC NetworkImpl : public Generator, public ReadableNetwor
 		/*! \copydoc nemo::Network::addNeuron */
 		void addNeuron(unsigned type, unsigned idx, unsigned nargs, const float args[]);
 
+		/*! \copydoc nemo::Network::addNeurons */
+		void addNeurons(unsigned type, size_t count, const unsigned idx[],
+				unsigned nargs, const float* const args[]);
+
 		/*! \copydoc nemo::Network::setNeuron */
 		void setNeuron(unsigned idx, unsigned nargs, const float args[]);
 
@@ -53,6 +57,15 @@ class NEMO_BASE_DLL_PUBLIC NetworkImpl : public Generator, public ReadableNetwor
 				float weight,
 				unsigned char plastic);
 
+		/*! \copydoc nemo::Network::addSynapses */
+		void addSynapses(size_t count,
+				const unsigned sources[],
+				const unsigned targets[],
+				const unsigned delays[],
+				const float weights[],
+				const unsigned char plastic[],
+				synapse_id ids[]);
+
 		/*! \copydoc nemo::Network::getNeuronState */
 		float getNeuronState(unsigned neuron, unsigned var) const;
 
@@ -106,6 +119,15 @@ class NEMO_BASE_DLL_PUBLIC NetworkImpl : public Generator, public ReadableNetwor
 		synapse_iterator synapse_begin() const;
 		synapse_iterator synapse_end() const;
 
+		/*! \copydoc nemo::network::Generator::synapseBlockCount */
+		size_t synapseBlockCount() const { return m_synapses.blockCount(); }
+
+		/*! \copydoc nemo::network::Generator::synapseBlock */
+		SynapseBlock synapseBlock(size_t i, SynapseBuffer&) const { return m_synapses.block(i); }
+
+		/*! \return number of synapses with the given source */
+		id32_t outdegree(nidx_t source) const { return m_synapses.outdegree(source); }
+
 		/*! \copydoc nemo::network::Generator::neuronType */
 		const NeuronType& neuronType(unsigned) const;
 
@@ -128,12 +150,7 @@ class NEMO_BASE_DLL_PUBLIC NetworkImpl : public Generator, public ReadableNetwor
 
 		nemo::RandomMapper<NeuronAddress> m_mapper;
 
-		/*! \todo consider using unordered here instead, esp. after removing
-		 * iterator interface. Currently we need rbegin, which is not found in
-		 * unordered_map */
-		typedef std::map<nidx_t, Axon> fcm_t;
-
-		fcm_t m_fcm;
+		Synapses m_synapses;
 
 		int m_minIdx;
 		int m_maxIdx;
@@ -146,8 +163,6 @@ class NEMO_BASE_DLL_PUBLIC NetworkImpl : public Generator, public ReadableNetwor
 		/*! Internal buffer for synapse queries */
 		std::vector<synapse_id> m_queriedSynapseIds;
 
-		const Axon& axon(nidx_t source) const;
-
 };
 
 	} // end namespace network
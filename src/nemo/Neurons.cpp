@@ -49,6 +49,20 @@ Neurons::add(unsigned gidx, unsigned nargs, const float args[])
 
 
 
+void
+Neurons::reserve(size_t n)
+{
+	for(unsigned i=0; i < m_param.size(); ++i) {
+		m_param[i].reserve(n);
+	}
+	for(unsigned i=0; i < m_state.size(); ++i) {
+		m_state[i].reserve(n);
+	}
+	m_gidx.reserve(n);
+}
+
+
+
 unsigned
 Neurons::parameterIndex(unsigned i) const
 {
@@ -45,6 +45,9 @@ class NEMO_BASE_DLL_PUBLIC Neurons
 		 */
 		size_t add(unsigned gidx, unsigned nargs, const float args[]);
 
+		/*! Reserve space for a total of \a n neurons */
+		void reserve(size_t n);
+
 		/*! Modify an existing neuron
 		 *
 		 * \param nargs number of parameters and state variables
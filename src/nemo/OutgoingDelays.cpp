@@ -15,23 +15,28 @@ OutgoingDelays::OutgoingDelays() :
 }
 
 
-OutgoingDelays::OutgoingDelays(const OutgoingDelaysAcc& acc) :
-	m_maxDelay(0)
-{
-	init(acc);
-}
-
-
 void
-OutgoingDelays::init(const OutgoingDelaysAcc& acc)
+OutgoingDelays::init(delay_t maxDelay, const std::vector<size_t>& rowOffset)
 {
-	m_maxDelay = acc.maxDelay();
+	m_maxDelay = maxDelay;
+	m_offset.clear();
+	m_data.clear();
+
+	if(maxDelay == 0 || rowOffset.empty()) {
+		return;
+	}
 
-	typedef std::map<unsigned, std::set<unsigned> >::const_iterator it;
-	for(it i = acc.m_delays.begin(), i_end = acc.m_delays.end(); i != i_end; ++i) {
-		const std::set<unsigned>& delays = i->second;
-		unsigned neuron = i->first;
-		m_data[neuron] = std::vector<delay_t>(delays.begin(), delays.end());
+	size_t sourceCount = (rowOffset.size() - 1) / maxDelay;
+	m_offset.reserve(sourceCount + 1);
+	m_offset.push_back(0);
+	for(size_t source=0; source < sourceCount; ++source) {
+		const size_t* row = &rowOffset[source * maxDelay];
+		for(delay_t d=1; d <= maxDelay; ++d) {
+			if(row[d] != row[d-1]) {
+				m_data.push_back(d);
+			}
+		}
+		m_offset.push_back(m_data.size());
 	}
 }
 
@@ -40,11 +45,10 @@ OutgoingDelays::init(const OutgoingDelaysAcc& acc)
 OutgoingDelays::const_iterator
 OutgoingDelays::begin(nidx_t source) const
 {
-	boost::unordered_map<nidx_t, std::vector<delay_t> >::const_iterator found = m_data.find(source);
-	if(found == m_data.end()) {
+	if(!hasSynapses(source)) {
 		throw nemo::exception(NEMO_INVALID_INPUT, "Invalid source neuron");
 	}
-	return found->second.begin();
+	return m_data.begin() + m_offset[source];
 }
 
 
@@ -52,28 +56,30 @@ OutgoingDelays::begin(nidx_t source) const
 OutgoingDelays::const_iterator
 OutgoingDelays::end(nidx_t source) const
 {
-	boost::unordered_map<nidx_t, std::vector<delay_t> >::const_iterator found = m_data.find(source);
-	if(found == m_data.end()) {
+	if(!hasSynapses(source)) {
 		throw nemo::exception(NEMO_INVALID_INPUT, "Invalid source neuron");
 	}
-	return found->second.end();
+	return m_data.begin() + m_offset[source+1];
 }
 
 
 bool
 OutgoingDelays::hasSynapses(nidx_t source) const
 {
-	return m_data.find(source) != m_data.end();
+	return size_t(source) + 1 < m_offset.size() && m_offset[source+1] != m_offset[source];
 }
 
 
 uint64_t
-OutgoingDelays::delayBits(nidx_t source) const
+OutgoingDelays::delayBits(nidx_t source, unsigned word) const
 {
 	uint64_t bits = 0;
 	if(hasSynapses(source)) {
 		for(const_iterator d = begin(source), d_end = end(source); d != d_end; ++d) {
-			bits = bits | (uint64_t(0x1) << uint64_t(*d - 1));
+			unsigned bit = *d - 1;
+			if(bit / 64 == word) {
+				bits = bits | (uint64_t(0x1) << uint64_t(bit % 64));
+			}
 		}
 	}
 	return bits;
@@ -11,44 +11,11 @@
  */
 
 #include <vector>
-#include <map>
-#include <set>
-#include <boost/unordered_map.hpp>
 
 #include <nemo/internal_types.h>
 
 namespace nemo {
 
-/*! Per-neuron collection of outoing delays (accumulation) */
-class OutgoingDelaysAcc
-{
-	public :
-
-		OutgoingDelaysAcc() : m_maxDelay(0) { }
-
-		/*! \param neuron global index 
-		 *  \param delay
-		 */
-		void addDelay(nidx_t neuron, delay_t delay) {
-			m_delays[neuron].insert(delay);
-			m_maxDelay = std::max(m_maxDelay, delay);
-		}
-
-		delay_t maxDelay() const { return m_maxDelay; }
-
-		void clear() { m_delays.clear() ; }
-	
-	private :
-
-		friend class OutgoingDelays;
-
-		std::map<nidx_t, std::set<delay_t> > m_delays;
-
-		delay_t m_maxDelay;
-};
-
-
-
 /*! Per-neuron collection of outgoing delays (run-time) */
 class OutgoingDelays
 {
@@ -56,13 +23,17 @@ class OutgoingDelays
 
 		OutgoingDelays();
 
-		/*
-		 * \param maxIdx
-		 * 		max source neuron index which will be used for run-time queries
+		/*! Set the delays from the row lengths of a forward connectivity
+		 * matrix.
+		 *
+		 * \param maxDelay
+		 * 		number of rows (delays 1 to \a maxDelay) for each source neuron
+		 * \param rowOffset
+		 * 		row offsets in CSR format, where the rows of source neuron n
+		 * 		start at n * maxDelay. A source has an outgoing delay d iff
+		 * 		row d is non-empty.
 		 */
-		OutgoingDelays(const OutgoingDelaysAcc&);
-
-		void init(const OutgoingDelaysAcc&);
+		void init(delay_t maxDelay, const std::vector<size_t>& rowOffset);
 
 		delay_t maxDelay() const { return m_maxDelay; }
 
@@ -82,17 +53,18 @@ class OutgoingDelays
 		 */
 		const_iterator end(nidx_t neuron) const;
 
-		/*! \return a bitwise representation of the delays for a single source.
-		 * The least significant bit corresponds to a delay of 1 */
-		uint64_t delayBits(nidx_t source) const;
+		/*! \return a bitwise representation of the delays for a single
+		 * source. Each word covers 64 delays, with the least significant bit
+		 * of word 0 corresponding to a delay of 1, and the least significant
+		 * bit of word w corresponding to a delay of 64*w+1. */
+		uint64_t delayBits(nidx_t source, unsigned word=0) const;
 		
 	private :
 
-		/*! \note Did some experimentation with replacing std::vector with raw
-		 * arrays but this did not improve performance appreciably. The main
-		 * cost of using this data structure is in calling find on the hash
-		 * table */
-		boost::unordered_map<nidx_t, std::vector<delay_t> > m_data;
+		/* Delays in CSR format, in increasing order for each source. The
+		 * delays of source n are found in [m_offset[n], m_offset[n+1]) */
+		std::vector<size_t> m_offset;
+		std::vector<delay_t> m_data;
 
 		delay_t m_maxDelay;
 
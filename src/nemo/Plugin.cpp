@@ -181,6 +181,14 @@ Plugin::function(const std::string& name) const
 
 
 
+void*
+Plugin::optionalFunction(const std::string& name) const
+{
+	return dl_sym(m_handle, name.c_str());
+}
+
+
+
 void
 Plugin::addPath(const std::string& dir)
 {
@@ -63,6 +63,13 @@ class NEMO_BASE_DLL_PUBLIC Plugin : private boost::noncopyable
 		 */
 		void* function(const std::string& name) const;
 
+		/*! \return function pointer for a named function, or NULL if the
+		 * plugin does not provide such a function
+		 *
+		 * The user needs to cast this to the appropriate type.
+		 */
+		void* optionalFunction(const std::string& name) const;
+
 		/*! \return path to user plugin directory
 		 *
 		 * The path may not exist
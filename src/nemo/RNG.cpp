@@ -1,7 +1,6 @@
 #include "RNG.hpp"
 
 #include <cmath>
-#include <boost/random.hpp>
 
 #include "exception.hpp"
 
@@ -35,30 +34,60 @@ nrand(RNG* rng)
 
 namespace nemo {
 
-void
-initialiseRng(nidx_t minNeuronIdx, nidx_t maxNeuronIdx, std::vector<RNG>& rngs)
+/* SplitMix64 (Steele, Lea, and Flood 2014), used to spread the key over the
+ * whole RNG state */
+static
+uint64_t
+splitmix64(uint64_t& x)
 {
-	assert_or_throw(minNeuronIdx <= maxNeuronIdx,
-			"Invalid neuron range when initialising RNG");
+	uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
 
-	//! \todo allow users to seed this RNG
-	typedef boost::mt19937 rng_t;
-	rng_t rng;
 
-	boost::variate_generator<rng_t, boost::uniform_int<unsigned long> >
-		seed(rng, boost::uniform_int<unsigned long>(0, 0x7fffffff));
 
-	for(unsigned gidx=0; gidx < 4 * minNeuronIdx; ++gidx) {
-		seed();
+void
+seedRng(uint64_t key, RNG& rng)
+{
+	uint64_t x = key;
+	for(unsigned plane=0; plane < 4; plane += 2) {
+		uint64_t z = splitmix64(x);
+		rng.state[plane] = unsigned(z);
+		rng.state[plane+1] = unsigned(z >> 32);
 	}
+	/* The all-zero state is a fixed point of the generator */
+	if((rng.state[0] | rng.state[1] | rng.state[2] | rng.state[3]) == 0) {
+		rng.state[0] = 1;
+	}
+}
+
+
+
+void
+seedRng(unsigned seed, uint64_t key, RNG& rng)
+{
+	/* Hash the seed separately, so that nearby (seed, key) pairs do not
+	 * collide */
+	uint64_t s = seed;
+	seedRng(key ^ splitmix64(s), rng);
+}
+
+
+
+void
+initialiseRng(nidx_t minNeuronIdx, nidx_t maxNeuronIdx, unsigned seed, std::vector<RNG>& rngs)
+{
+	assert_or_throw(minNeuronIdx <= maxNeuronIdx,
+			"Invalid neuron range when initialising RNG");
+	assert_or_throw(rngs.size() > maxNeuronIdx - minNeuronIdx,
+			"RNG vector too small for neuron range");
 
+	// some of these neuron indices may be invalid
 	for(unsigned gidx = minNeuronIdx, gidx_end = maxNeuronIdx;
 			gidx <= gidx_end; ++gidx) {
-		// some of these neuron indices may be invalid
-		RNG& seeds = rngs.at(gidx - minNeuronIdx);
-		for(unsigned plane=0; plane < 4; ++plane) {
-			seeds.state[plane] = seed();
-		}
+		seedRng(seed, gidx, rngs[gidx - minNeuronIdx]);
 	}
 }
 
@@ -1,6 +1,7 @@
 #ifndef NEMO_RNG_HPP
 #define NEMO_RNG_HPP
 
+#include <math.h>
 #include <vector>
 #include <nemo/internal_types.h>
 #include <nemo/config.h>
@@ -20,6 +21,88 @@ NEMO_BASE_DLL_PUBLIC unsigned urand(RNG* rng);
 /*! \return normal random number drawn from N(0, 1) */
 NEMO_BASE_DLL_PUBLIC float nrand(RNG* rng);
 
+
+/*! \name Counter-based RNG
+ *
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+ * 3", SC'11). Each call maps a 128-bit counter and a 64-bit key to 128
+ * random bits, with no mutable state. For neuron noise the key is formed
+ * from the global neuron index and a seed, and the counter from the cycle,
+ * so the random numbers for any neuron and cycle can be computed
+ * independently, regardless of thread count or neuron partitioning.
+ * @{ */
+
+/*! Key for a single neuron's counter-based random stream */
+typedef struct {
+	unsigned key[2];
+} PhiloxKey;
+
+
+#define PHILOX_M0 0xd2511f53U
+#define PHILOX_M1 0xcd9e8d57U
+#define PHILOX_W0 0x9e3779b9U
+#define PHILOX_W1 0xbb67ae85U
+#define PHILOX_ROUNDS 10
+
+
+/*! Compute Philox4x32-10 of counter \a ctr and key \a key, writing the 128
+ * output bits to \a out */
+static inline
+void
+philox4x32(const unsigned ctr[4], const unsigned key[2], unsigned out[4])
+{
+	unsigned c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+	unsigned k0 = key[0], k1 = key[1];
+	unsigned r;
+	for(r = 0; r < PHILOX_ROUNDS; ++r) {
+		uint64_t p0 = (uint64_t) PHILOX_M0 * c0;
+		uint64_t p1 = (uint64_t) PHILOX_M1 * c2;
+		unsigned hi0 = (unsigned) (p0 >> 32), lo0 = (unsigned) p0;
+		unsigned hi1 = (unsigned) (p1 >> 32), lo1 = (unsigned) p1;
+		c0 = hi1 ^ c1 ^ k0;
+		c1 = lo1;
+		c2 = hi0 ^ c3 ^ k1;
+		c3 = lo0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+
+/*! \return the first of the four random words for a neuron's key during a
+ * given cycle. The \a stream argument selects independent sets of random
+ * numbers for the same neuron and cycle. */
+static inline
+unsigned
+philox_urand(const PhiloxKey* key, unsigned cycle, unsigned stream)
+{
+	unsigned ctr[4] = { cycle, stream, 0, 0 };
+	unsigned out[4];
+	philox4x32(ctr, key->key, out);
+	return out[0];
+}
+
+
+/*! \return normal random number drawn from N(0, 1), for a neuron's key
+ * during a given cycle. This uses the same Box-Muller transform as nrand. */
+static inline
+float
+philox_nrand(const PhiloxKey* key, unsigned cycle, unsigned stream)
+{
+	unsigned ctr[4] = { cycle, stream, 0, 0 };
+	unsigned out[4];
+	philox4x32(ctr, key->key, out);
+	{
+		float a = out[0] * 1.4629180792671596810513378043098e-9f;
+		float b = out[1] * 0.00000000023283064365386962890625f;
+		float r = sqrtf(-2*logf(1-b));
+		return sinf(a) * r;
+	}
+}
+
+/*! @} */
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,14 +110,30 @@ NEMO_BASE_DLL_PUBLIC float nrand(RNG* rng);
 
 namespace nemo {
 
-/* Generates RNG seeds for neurons in the range [0, maxIdx], and writes the
- * seeds for [minIdx, maxIdx] to the output vector (indices [0, maxIdx -
- * minIdx). Generating and discarding the initial seed values is done in order
- * to always have a fixed mapping from global neuron index to RNG seed values.
- */
+/* Seeds the RNGs for neurons in the range [minIdx, maxIdx], writing them to
+ * the output vector (indices [0, maxIdx - minIdx]). Each neuron's RNG is
+ * seeded from the user seed and its global index alone (see \a seedRng), so
+ * the mapping from global neuron index to RNG state is fixed, and the cost
+ * does not depend on \a minIdx. Different ranges can thus be initialised
+ * independently and in parallel. */
+NEMO_BASE_DLL_PUBLIC
+void
+initialiseRng(nidx_t minNeuronIdx, nidx_t maxNeuronIdx, unsigned seed, std::vector<RNG>& rngs);
+
+
+/*! Seed a single RNG from an arbitrary 64-bit key, in constant time.
+ * Different keys give unrelated streams. */
+NEMO_BASE_DLL_PUBLIC
+void
+seedRng(uint64_t key, RNG& rng);
+
+
+/*! Seed a single RNG from a user seed and a 64-bit key (typically derived
+ * from a neuron index), in constant time. Different seeds give unrelated
+ * streams for the same key. */
 NEMO_BASE_DLL_PUBLIC
 void
-initialiseRng(nidx_t minNeuronIdx, nidx_t maxNeuronIdx, std::vector<RNG>& rngs);
+seedRng(unsigned seed, uint64_t key, RNG& rng);
 
 } // end namespace
 
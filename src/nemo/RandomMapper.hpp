@@ -10,39 +10,156 @@
  * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <boost/bimap.hpp>
+#include <map>
+#include <vector>
+#include <boost/unordered_map.hpp>
 #include <boost/format.hpp>
 
 #include <nemo/internal_types.h>
 #include <nemo/Mapper.hpp>
 #include <nemo/exception.hpp>
+#include <nemo/network/Generator.hpp>
 
 namespace nemo {
 
+	namespace mapper {
+
+/* Lookup from local to global index. In general the local indices can be of
+ * any ordered type, but the common case of compact scalar local indices is
+ * stored in a flat vector. */
+template<class L>
+class LocalLookup
+{
+	public :
+
+		/*! \return false if \a lidx already exists */
+		bool insert(const L& lidx, nidx_t gidx) {
+			return m_map.insert(std::make_pair(lidx, gidx)).second;
+		}
+
+		/*! \return pointer to global index, or NULL if \a lidx does not exist */
+		const nidx_t* find(const L& lidx) const {
+			typename std::map<L, nidx_t>::const_iterator i = m_map.find(lidx);
+			return i == m_map.end() ? NULL : &i->second;
+		}
+
+	private :
+
+		std::map<L, nidx_t> m_map;
+};
+
+
+template<>
+class LocalLookup<nidx_t>
+{
+	public :
+
+		bool insert(nidx_t lidx, nidx_t gidx) {
+			if(lidx >= m_global.size()) {
+				m_global.resize(lidx+1, INVALID);
+			}
+			if(m_global[lidx] != INVALID) {
+				return false;
+			}
+			m_global[lidx] = gidx;
+			return true;
+		}
+
+		const nidx_t* find(nidx_t lidx) const {
+			return lidx < m_global.size() && m_global[lidx] != INVALID ? &m_global[lidx] : NULL;
+		}
+
+	private :
+
+		/* The global index ~0 is reserved, as neuron counts are 32-bit */
+		static const nidx_t INVALID = ~nidx_t(0);
+
+		std::vector<nidx_t> m_global;
+};
+
+	}
+
+
+
 /*! Mapper between global neuron index space and another index space
  *
  * The user of this class is responsible for providing both indices
+ *
+ * The mapping from global indices is stored either in a flat vector covering
+ * the range of global indices (dense mode) or in a hash table (sparse mode).
+ * Dense mode is used if the expected range of global indices is provided up
+ * front (see \a reserve) and is not much larger than the number of neurons.
+ * In either case lookups are constant time. If a global index outside the
+ * expected range is inserted, the mapper falls back to sparse mode.
  */
 template<class L>
 class RandomMapper : public Mapper<nidx_t, L>
 {
-	private :
-
-		typedef boost::bimap<nidx_t, L> bm_type;
-
 	public :
 
+		RandomMapper() : m_size(0), m_dense(false), m_denseBase(0) { }
+
 		~RandomMapper() {}
 
+		/*! Prepare the mapper for \a count neurons with global indices in the
+		 * range [\a minGlobal, \a maxGlobal], using dense mode if the range is
+		 * at most DENSE_RANGE_FACTOR times the neuron count.
+		 *
+		 * \pre no neurons have yet been inserted
+		 */
+		void reserve(nidx_t minGlobal, nidx_t maxGlobal, size_t count) {
+			if(m_size != 0) {
+				throw nemo::exception(NEMO_LOGIC_ERROR,
+						"Internal error: mapper reserved after neurons were added");
+			}
+			size_t range = size_t(maxGlobal) - size_t(minGlobal) + 1;
+			m_dense = maxGlobal >= minGlobal && range <= DENSE_RANGE_FACTOR * count;
+			if(m_dense) {
+				m_denseBase = minGlobal;
+				m_denseLocal.resize(range);
+				m_denseValid.resize(range, false);
+			} else {
+				m_sparse.rehash(count);
+			}
+		}
+
+		/*! Prepare the mapper for all the neurons in a network */
+		void reserve(const network::Generator& net) {
+			if(net.neuronCount() != 0) {
+				reserve(net.minNeuronIndex(), net.maxNeuronIndex(), net.neuronCount());
+			}
+		}
+
+		/*! \return true if the mapper uses flat vector storage for the global indices */
+		bool dense() const { return m_dense; }
+
 		/*! Add a new global/local neuron index pair */
 		virtual void insert(nidx_t gidx, const L& lidx) {
 			using boost::format;
-			std::pair<typename bm_type::iterator,bool> insertion =
-				m_bm.insert(typename bm_type::value_type(gidx, lidx));
-			if(!insertion.second) {
+			if(existingGlobal(gidx) || !m_local.insert(lidx, gidx)) {
 				throw nemo::exception(NEMO_INVALID_INPUT,
 					str(format("Duplicate neuron index %u") % gidx));
 			}
+			if(m_dense && (gidx < m_denseBase || gidx - m_denseBase >= m_denseLocal.size())) {
+				makeSparse();
+			}
+			if(m_dense) {
+				m_denseLocal[gidx - m_denseBase] = lidx;
+				m_denseValid[gidx - m_denseBase] = true;
+			} else {
+				m_sparse.insert(std::make_pair(gidx, lidx));
+			}
+
+			if(m_size == 0) {
+				m_minGlobal = m_maxGlobal = gidx;
+				m_minLocal = m_maxLocal = lidx;
+			} else {
+				m_minGlobal = std::min(m_minGlobal, gidx);
+				m_maxGlobal = std::max(m_maxGlobal, gidx);
+				m_minLocal = std::min(m_minLocal, lidx);
+				m_maxLocal = std::max(m_maxLocal, lidx);
+			}
+			m_size += 1;
 		}
 
 		/*! \return local index corresponding to the global neuron index \a gidx 
@@ -52,54 +169,48 @@ class RandomMapper : public Mapper<nidx_t, L>
 		 */
 		L localIdx(const nidx_t& gidx) const {
 			using boost::format;
-			try {
-				return m_bm.left.at(gidx);
-			} catch(std::out_of_range) {
+			const L* lidx = findGlobal(gidx);
+			if(lidx == NULL) {
 				throw nemo::exception(NEMO_INVALID_INPUT,
 					str(format("Non-existing neuron index %u") % gidx));
-			} 
+			}
+			return *lidx;
 		}
 
 		nidx_t globalIdx(const L& lidx) const {
-			try {
-				return m_bm.right.at(lidx);
-			} catch(std::out_of_range) {
+			const nidx_t* gidx = m_local.find(lidx);
+			if(gidx == NULL) {
 				//! \todo print the local index as well here
 				throw nemo::exception(NEMO_INVALID_INPUT,
 						"Non-existing local neuron index");
 			}
+			return *gidx;
 		}
 
 		bool existingGlobal(const nidx_t& gidx) const {
-			return m_bm.left.find(gidx) != m_bm.left.end();
+			return findGlobal(gidx) != NULL;
 		}
 
 		bool existingLocal(const L& lidx) const {
-			return m_bm.right.find(lidx) != m_bm.right.end();
+			return m_local.find(lidx) != NULL;
 		}
 
 		L minLocalIdx() const {
-			return m_bm.size() == 0 ? 0 : m_bm.right.begin()->first;
+			return m_size == 0 ? L() : m_minLocal;
 		}
 
 		L maxLocalIdx() const {
-			return m_bm.size() == 0 ? 0 : m_bm.right.rbegin()->first;
+			return m_size == 0 ? L() : m_maxLocal;
 		}
 
 		nidx_t minGlobalIdx() const {
-			return m_bm.size() == 0 ? 0 : m_bm.left.begin()->first;
+			return m_size == 0 ? 0 : m_minGlobal;
 		}
 
 		nidx_t maxGlobalIdx() const {
-			return m_bm.size() == 0 ? 0 : m_bm.left.rbegin()->first;
+			return m_size == 0 ? 0 : m_maxGlobal;
 		}
 
-		/*! Iterator over <global,local> pairs */
-		typedef typename bm_type::left_const_iterator const_iterator;
-
-		const_iterator begin() const { return m_bm.left.begin(); }
-		const_iterator end() const { return m_bm.left.end(); }
-
 		/*! Add a new local 0-based contiguous index to mapper
 		 *
 		 * \pre local increases monotonically on subsequent calls to this function
@@ -152,7 +263,50 @@ class RandomMapper : public Mapper<nidx_t, L>
 
 	private :
 
-		bm_type m_bm;
+		/* Maximum ratio between the range of global indices and the number
+		 * of neurons for which dense mode is used */
+		static const size_t DENSE_RANGE_FACTOR = 4;
+
+		size_t m_size;
+
+		mapper::LocalLookup<L> m_local;
+
+		/* Global to local mapping in dense mode. Entry i refers to the global
+		 * index m_denseBase + i. */
+		bool m_dense;
+		nidx_t m_denseBase;
+		std::vector<L> m_denseLocal;
+		std::vector<bool> m_denseValid;
+
+		/* Global to local mapping in sparse mode */
+		boost::unordered_map<nidx_t, L> m_sparse;
+
+		nidx_t m_minGlobal;
+		nidx_t m_maxGlobal;
+		L m_minLocal;
+		L m_maxLocal;
+
+		const L* findGlobal(nidx_t gidx) const {
+			if(m_dense) {
+				size_t i = gidx - m_denseBase;
+				return gidx >= m_denseBase && i < m_denseLocal.size() && m_denseValid[i] ?
+					&m_denseLocal[i] : NULL;
+			}
+			typename boost::unordered_map<nidx_t, L>::const_iterator i = m_sparse.find(gidx);
+			return i == m_sparse.end() ? NULL : &i->second;
+		}
+
+		/* Move all existing mappings from dense to sparse storage */
+		void makeSparse() {
+			for(size_t i=0; i < m_denseLocal.size(); ++i) {
+				if(m_denseValid[i]) {
+					m_sparse.insert(std::make_pair(nidx_t(m_denseBase + i), m_denseLocal[i]));
+				}
+			}
+			m_dense = false;
+			m_denseLocal.clear();
+			m_denseValid.clear();
+		}
 };
 
 
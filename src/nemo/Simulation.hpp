@@ -21,6 +21,7 @@ namespace nemo {
 
 class Network;
 class Configuration;
+class InputGenerator;
 
 
 /*! \class Simulation
@@ -50,6 +51,92 @@ class NEMO_BASE_DLL_PUBLIC Simulation : public ReadableNetwork
 		/*! Current stimulus specified as pairs of neuron index and input current */
 		typedef std::vector< std::pair<unsigned, float> > current_stimulus;
 
+		/*! Current stimulus specified for every neuron. Entry i is the input
+		 * current for the neuron with the i-th lowest neuron index. */
+		typedef std::vector<float> dense_current_stimulus;
+
+		/*! Firing during a number of consecutive simulation steps
+		 *
+		 * The firing is stored in contiguous arrays, with one entry in \a
+		 * cycles and \a neurons for each firing, ordered by cycle. In
+		 * addition \a offsets provides a per-cycle index: the firing during
+		 * the i-th step is found in the range [offsets[i], offsets[i+1]).
+		 */
+		struct firing_record
+		{
+			/*! Simulation cycle (as reported by \a elapsedSimulation) of each firing */
+			std::vector<uint64_t> cycles;
+
+			/*! Index of the neuron which fired, for each firing */
+			std::vector<unsigned> neurons;
+
+			/*! Start of each step's firing in \a cycles and \a neurons, plus
+			 * a final entry containing the total number of firings */
+			std::vector<uint64_t> offsets;
+
+			/*! Remove all firing, keeping the allocated storage */
+			void clear() {
+				cycles.clear();
+				neurons.clear();
+				offsets.assign(1, 0);
+			}
+
+			/*! Add a single cycle's firing at the end */
+			void append(uint64_t cycle, const std::vector<unsigned>& fired) {
+				cycles.insert(cycles.end(), fired.size(), cycle);
+				neurons.insert(neurons.end(), fired.begin(), fired.end());
+				offsets.push_back(neurons.size());
+			}
+		};
+
+		/*! Firing and current stimulus for a number of consecutive
+		 * simulation steps
+		 *
+		 * Each stimulus entry is keyed by the step within the run (starting
+		 * from 0) to which it applies. The entries are stored in parallel
+		 * arrays and must be added in order of non-decreasing step, both for
+		 * firing and for current stimulus.
+		 */
+		struct stimulus_schedule
+		{
+			/*! Step during which each entry in \a firingNeurons should fire */
+			std::vector<unsigned> firingSteps;
+
+			/*! Neurons which will be forced to fire */
+			std::vector<unsigned> firingNeurons;
+
+			/*! Step during which each entry in \a currentNeurons should
+			 * receive the corresponding entry in \a currents */
+			std::vector<unsigned> currentSteps;
+
+			/*! Neurons which will receive current stimulus */
+			std::vector<unsigned> currentNeurons;
+
+			/*! Input current for each entry in \a currentNeurons */
+			std::vector<float> currents;
+
+			void clear() {
+				firingSteps.clear();
+				firingNeurons.clear();
+				currentSteps.clear();
+				currentNeurons.clear();
+				currents.clear();
+			}
+
+			/*! Force \a neuron to fire during the given step */
+			void addFiring(unsigned step, unsigned neuron) {
+				firingSteps.push_back(step);
+				firingNeurons.push_back(neuron);
+			}
+
+			/*! Provide input current to \a neuron during the given step */
+			void addCurrent(unsigned step, unsigned neuron, float current) {
+				currentSteps.push_back(step);
+				currentNeurons.push_back(neuron);
+				currents.push_back(current);
+			}
+		};
+
 		/*! Run simulation for a single cycle (1ms) without external stimulus */
 		virtual const firing_output& step() = 0;
 
@@ -90,6 +177,72 @@ class NEMO_BASE_DLL_PUBLIC Simulation : public ReadableNetwork
 					const firing_stimulus& fstim,
 					const current_stimulus& istim) = 0;
 
+		/*! Run simulation for a single cycle (1ms) with current stimulus for
+		 * every neuron
+		 *
+		 * This is cheaper than the sparse form of current stimulus when most
+		 * neurons receive input, since no per-neuron index lookup is required.
+		 *
+		 * \param istim
+		 * 		Input current for this cycle, with one entry per neuron, ordered
+		 * 		by neuron index. If the vector is empty no current is provided.
+		 * \return
+		 * 		List of neurons which fired this cycle. The referenced data is
+		 * 		valid until the next call to step.
+		 *
+		 * \throws nemo::exception if \a istim is non-empty and its length
+		 * 		differs from the number of neurons
+		 */
+		virtual const firing_output& step(const dense_current_stimulus& istim) = 0;
+
+		/*! Run simulation for a single cycle (1ms) with firing stimulus and
+		 * current stimulus for every neuron
+		 *
+		 * \param fstim
+		 * 		An list of neurons, which will be forced to fire this cycle.
+		 * \param istim
+		 * 		Input current for this cycle, as for the single-argument
+		 * 		dense form.
+		 * \return
+		 * 		List of neurons which fired this cycle. The referenced data is
+		 * 		valid until the next call to step.
+		 */
+		virtual const firing_output& step(
+					const firing_stimulus& fstim,
+					const dense_current_stimulus& istim) = 0;
+
+		/*! Run simulation for several cycles without external stimulus,
+		 * recording all firing
+		 *
+		 * \param nsteps number of cycles (1ms each) to run
+		 * \return
+		 * 		Firing during all \a nsteps cycles. The referenced data is valid
+		 * 		until the next call to \a run. The storage is re-used between
+		 * 		calls, so reading long runs in blocks of cycles does not cause
+		 * 		repeated allocation.
+		 */
+		virtual const firing_record& run(unsigned nsteps) = 0;
+
+		/*! Run simulation for several cycles with scheduled stimulus,
+		 * recording all firing
+		 *
+		 * This is equivalent to calling \a step \a nsteps times, with the
+		 * relevant stimulus for each step, but without the per-cycle call
+		 * overhead.
+		 *
+		 * \param nsteps number of cycles (1ms each) to run
+		 * \param schedule
+		 * 		firing and current stimulus, keyed by step within the run.
+		 * 		Steps must be less than \a nsteps.
+		 * \return
+		 * 		Firing during all \a nsteps cycles, as for \a run without
+		 * 		stimulus.
+		 *
+		 * \throws nemo::exception if the schedule is malformed
+		 */
+		virtual const firing_record& run(unsigned nsteps,
+				const stimulus_schedule& schedule) = 0;
+
 #ifdef NEMO_BRIAN_ENABLED
 		/* Propagate spikes on given some firing
 		 *
@@ -153,6 +306,27 @@ class NEMO_BASE_DLL_PUBLIC Simulation : public ReadableNetwork
 		 */
 		virtual void applyStdp(float reward) = 0;
 
+		/*! Add a generator of time-varying input current
+		 *
+		 * The generator is evaluated by the simulation during every
+		 * subsequent simulation step, separately for each target neuron. The
+		 * resulting current is added to any external input current provided
+		 * to \a step or \a run. Several generators may target the same
+		 * neuron, in which case their contributions are summed.
+		 *
+		 * \param generator
+		 * 		input generator. The simulation keeps its own copy, so the
+		 * 		same generator can be used for several populations.
+		 * \param neurons
+		 * 		target neurons. Each neuron should be listed only once.
+		 *
+		 * \throws nemo::exception if the backend does not support input
+		 * 		generators, or if \a neurons contains invalid or repeated
+		 * 		neuron indices.
+		 */
+		virtual void addInputGenerator(const InputGenerator& generator,
+				const std::vector<unsigned>& neurons) = 0;
+
 		/*! \name Queries
 		 *
 		 * Neuron and synapse state is availble at run-time.
@@ -8,6 +8,10 @@
  */
 
 #include "SimulationBackend.hpp"
+
+#include <boost/format.hpp>
+
+#include "exception.hpp"
 #include "fixedpoint.hpp"
 
 namespace nemo {
@@ -76,4 +80,116 @@ SimulationBackend::step(const firing_stimulus& fstim, const current_stimulus& is
 	return readFiring().neurons;
 }
 
+
+const Simulation::firing_output&
+SimulationBackend::step(const dense_current_stimulus& istim)
+{
+	prefire();
+	setCurrentStimulus(istim);
+	fire();
+	postfire();
+	return readFiring().neurons;
+}
+
+
+const Simulation::firing_output&
+SimulationBackend::step(const firing_stimulus& fstim, const dense_current_stimulus& istim)
+{
+	prefire();
+	setCurrentStimulus(istim);
+	setFiringStimulus(fstim);
+	fire();
+	postfire();
+	return readFiring().neurons;
+}
+
+
+
+const Simulation::firing_record&
+SimulationBackend::run(unsigned nsteps)
+{
+	return run(nsteps, stimulus_schedule());
+}
+
+
+
+/* Verify that stimulus is provided in order and only for the steps of the
+ * run */
+static
+void
+checkSchedule(const std::vector<unsigned>& steps, size_t len, unsigned nsteps, const char* kind)
+{
+	using boost::format;
+
+	if(steps.size() != len) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("%s stimulus schedule: vectors of different length") % kind));
+	}
+	for(size_t i=0; i < steps.size(); ++i) {
+		if(steps[i] >= nsteps) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("%s stimulus scheduled for step %u in a run of %u steps")
+						% kind % steps[i] % nsteps));
+		}
+		if(i > 0 && steps[i] < steps[i-1]) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("%s stimulus schedule not ordered by step") % kind));
+		}
+	}
+}
+
+
+
+const Simulation::firing_record&
+SimulationBackend::run(unsigned nsteps, const stimulus_schedule& schedule)
+{
+	checkSchedule(schedule.firingSteps, schedule.firingNeurons.size(), nsteps, "firing");
+	checkSchedule(schedule.currentSteps, schedule.currentNeurons.size(), nsteps, "current");
+	checkSchedule(schedule.currentSteps, schedule.currents.size(), nsteps, "current");
+
+	m_firingRecord.clear();
+
+	/* Next stimulus entries to use */
+	size_t f = 0;
+	size_t c = 0;
+
+	for(unsigned step=0; step < nsteps; ++step) {
+
+		uint64_t cycle = elapsedSimulation();
+		prefire();
+
+		size_t c_end = c;
+		while(c_end < schedule.currentSteps.size() && schedule.currentSteps[c_end] == step) {
+			++c_end;
+		}
+		initCurrentStimulus(c_end - c);
+		for(size_t i=c; i < c_end; ++i) {
+			addCurrentStimulus(schedule.currentNeurons[i], schedule.currents[i]);
+		}
+		finalizeCurrentStimulus(c_end - c);
+		c = c_end;
+
+		if(f < schedule.firingSteps.size() && schedule.firingSteps[f] == step) {
+			m_scheduledFiring.clear();
+			for( ; f < schedule.firingSteps.size() && schedule.firingSteps[f] == step; ++f) {
+				m_scheduledFiring.push_back(schedule.firingNeurons[f]);
+			}
+			setFiringStimulus(m_scheduledFiring);
+		}
+
+		fire();
+		postfire();
+		m_firingRecord.append(cycle, readFiring().neurons);
+	}
+	return m_firingRecord;
+}
+
+
+
+void
+SimulationBackend::addInputGenerator(const InputGenerator&, const std::vector<unsigned>&)
+{
+	throw nemo::exception(NEMO_API_UNSUPPORTED, "input generators not supported by this backend");
+}
+
 }
@@ -56,11 +56,12 @@ class NEMO_BASE_DLL_PUBLIC SimulationBackend : public Simulation
 		 * 		sim->addCurrentStimulus(pair);
 		 *  sim->setCurrentStimulus
 		 *
-		 * Alternatively, call the setCurrentStimulus method where neurons are
-		 * specified using the internal neuron indexing and the current is
-		 * already converted to the correct fixed-point format. This can be
-		 * quite a bit faster, especially if there is input current for *every*
-		 * neuron, and is used in the MPI backend.
+		 * Alternatively, call the setCurrentStimulus method with a dense
+		 * vector containing the current for every neuron. The backend maps
+		 * this to its internal neuron indexing using a permutation computed
+		 * when the simulation is created. This can be quite a bit faster if
+		 * there is input current for (nearly) every neuron, and is used in the
+		 * MPI backend.
 		 *
 		 * Only one of these interfaces should be used.
 		 */
@@ -75,20 +76,20 @@ class NEMO_BASE_DLL_PUBLIC SimulationBackend : public Simulation
 		/*! Perform any finalisation of input current stimulus buffers. */
 		virtual void finalizeCurrentStimulus(size_t count) = 0;
 
-		/*! Set per-neuron input current on the device and set the relevant
-		 * member variable containing the device pointer. If there is no input
-		 * the device pointer is NULL.
+		/*! Set input current for every neuron for the next simulation step
 		 *
 		 * This function should only be called once per cycle and should not be
-		 * called in the same cycle as the floating-point function with the
-		 * same name.
+		 * called in the same cycle as the sparse current stimulus functions
+		 * above.
 		 *
 		 * \param current
-		 * 		Input current vector using the same fixed-point format as the
-		 * 		backend. The current vector indices should have a one-to-one
-		 * 		mapping to the valid indices in the simulation. In other words,
-		 * 		the input current vector must have been constructed filled
-		 * 		taking into account the backend's own mapper.
+		 * 		Input current with one entry per neuron, ordered by global
+		 * 		neuron index. In other words, entry i is the current for the
+		 * 		neuron with the i-th lowest global index. If the vector is empty
+		 * 		no current is provided.
+		 *
+		 * \throws nemo::exception if \a current is non-empty and of the wrong
+		 * 		length
 		 */
 		virtual void setCurrentStimulus(const std::vector<float>& current) = 0;
 
@@ -134,9 +135,27 @@ class NEMO_BASE_DLL_PUBLIC SimulationBackend : public Simulation
 		/*! \copydoc nemo::Simulation::step */
 		const firing_output& step(const firing_stimulus&, const current_stimulus&);
 
+		/*! \copydoc nemo::Simulation::step */
+		const firing_output& step(const dense_current_stimulus&);
+
+		/*! \copydoc nemo::Simulation::step */
+		const firing_output& step(const firing_stimulus&, const dense_current_stimulus&);
+
+		/*! \copydoc nemo::Simulation::run(unsigned) */
+		const firing_record& run(unsigned nsteps);
+
+		/*! \copydoc nemo::Simulation::run(unsigned, const stimulus_schedule&) */
+		const firing_record& run(unsigned nsteps, const stimulus_schedule& schedule);
+
 		/*! \copydoc nemo::Simulation::applyStdp */
 		virtual void applyStdp(float reward) = 0;
 
+		/*! \copydoc nemo::Simulation::addInputGenerator
+		 *
+		 * The default implementation throws NEMO_API_UNSUPPORTED */
+		virtual void addInputGenerator(const InputGenerator& generator,
+				const std::vector<unsigned>& neurons);
+
 		/*! \return tuple oldest buffered cycle's worth of firing data and the
 		 * associated cycle number. */
 		virtual FiredList readFiring() = 0;
@@ -147,6 +166,12 @@ class NEMO_BASE_DLL_PUBLIC SimulationBackend : public Simulation
 
 	private :
 
+		/* Output buffer for \a run */
+		firing_record m_firingRecord;
+
+		/* Firing stimulus for a single step of \a run */
+		firing_stimulus m_scheduledFiring;
+
 		/* Disallow copying of SimulationBackend object */
 		SimulationBackend(const Simulation&);
 		SimulationBackend& operator=(const Simulation&);
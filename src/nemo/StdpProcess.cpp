@@ -139,4 +139,22 @@ StdpProcess::updatedWeight(fix_t w_old, fix_t w_diff) const
 
 
 
+void
+StdpProcess::updatedWeights(unsigned n,
+		const fix_t w_old[], const fix_t w_diff[], fix_t w_new[]) const
+{
+	for(unsigned i=0; i < n; ++i) {
+		fix_t w = w_old[i];
+		bool excitatory = w > 0;
+		fix_t lo = excitatory ? m_minExcitatoryWeight : m_maxInhibitoryWeight;
+		fix_t hi = excitatory ? m_maxExcitatoryWeight : m_minInhibitoryWeight;
+		fix_t sum = w + w_diff[i];
+		sum = sum < lo ? lo : sum;
+		sum = sum > hi ? hi : sum;
+		w_new[i] = w == 0 ? 0 : sum;
+	}
+}
+
+
+
 } // end namespace nemo
@@ -35,6 +35,11 @@ class NEMO_BASE_DLL_PUBLIC StdpProcess
 		 * change. */
 		fix_t updatedWeight(fix_t w_old, fix_t w_diff) const;
 
+		/*! Compute \a updatedWeight for \a n synapses at once. The weights are
+		 * clamped without branches, so that the loop can be vectorised. */
+		void updatedWeights(unsigned n, const fix_t w_old[],
+				const fix_t w_diff[], fix_t w_new[]) const;
+
 		/* Bitmask indicating the position of the postsynaptic firing within
 		 * the window. This is useful in determining when to compute STDP updates. */
 		uint64_t postFireMask() const { return m_postFireMask; }
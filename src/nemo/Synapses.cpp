@@ -0,0 +1,201 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Synapses.hpp"
+
+#include <algorithm>
+
+#include <boost/format.hpp>
+
+#include "exception.hpp"
+#include "synapse_indices.hpp"
+
+namespace nemo {
+
+
+const size_t Synapses::CHUNK_SIZE;
+const size_t Synapses::INITIAL_CAPACITY;
+
+
+
+void
+Synapses::Chunk::reserve(size_t n)
+{
+	source.reserve(n);
+	target.reserve(n);
+	delay.reserve(n);
+	weight.reserve(n);
+	plastic.reserve(n);
+	id.reserve(n);
+}
+
+
+
+void
+Synapses::addChunk(size_t capacity)
+{
+	m_chunks.push_back(Chunk());
+	m_chunks.back().reserve(capacity);
+}
+
+
+
+/* Only the capacity which is actually needed is reserved, also in the last
+ * chunk */
+void
+Synapses::reserve(size_t n)
+{
+	size_t end = m_size + n;
+	for(size_t ci = m_size / CHUNK_SIZE; ci * CHUNK_SIZE < end; ++ci) {
+		size_t capacity = std::min(CHUNK_SIZE, end - ci * CHUNK_SIZE);
+		if(ci == m_chunks.size()) {
+			addChunk(capacity);
+		} else {
+			m_chunks[ci].reserve(capacity);
+		}
+	}
+}
+
+
+
+id32_t
+Synapses::add(nidx_t source, nidx_t target,
+		delay_t delay, float weight, unsigned char plastic)
+{
+	size_t ci = m_size / CHUNK_SIZE;
+	if(ci == m_chunks.size()) {
+		addChunk(INITIAL_CAPACITY);
+	}
+
+	Chunk& c = m_chunks[ci];
+	if(c.source.size() == c.source.capacity()) {
+		c.reserve(std::min(CHUNK_SIZE, 2 * c.source.capacity()));
+	}
+
+	id32_t id = m_outdegree[source]++;
+
+	c.source.push_back(source);
+	c.target.push_back(target);
+	c.delay.push_back(delay);
+	c.weight.push_back(weight);
+	c.plastic.push_back(plastic);
+	c.id.push_back(id);
+	m_size += 1;
+
+	return id;
+}
+
+
+
+id32_t
+Synapses::outdegree(nidx_t source) const
+{
+	outdegree_map::const_iterator found = m_outdegree.find(source);
+	return found == m_outdegree.end() ? 0 : found->second;
+}
+
+
+
+const Synapses::Chunk&
+Synapses::chunk(size_t pos) const
+{
+	if(pos >= m_size) {
+		throw nemo::exception(NEMO_INVALID_INPUT, "synapse id out or range");
+	}
+	return m_chunks[pos / CHUNK_SIZE];
+}
+
+
+
+Synapse
+Synapses::get(size_t pos) const
+{
+	const Chunk& c = chunk(pos);
+	size_t i = pos % CHUNK_SIZE;
+	return Synapse(c.source[i], c.delay[i],
+			AxonTerminal(c.id[i], c.target[i], c.weight[i], c.plastic[i] != 0));
+}
+
+
+
+/* Since ids are assigned consecutively for each source, the index can be
+ * built using a single pass over the synapses */
+void
+Synapses::buildIndex() const
+{
+	m_indexStart.clear();
+	size_t start = 0;
+	for(outdegree_map::const_iterator i = m_outdegree.begin();
+			i != m_outdegree.end(); ++i) {
+		m_indexStart[i->first] = start;
+		start += i->second;
+	}
+
+	m_index.resize(m_size);
+	for(size_t pos=0; pos < m_size; ++pos) {
+		const Chunk& c = m_chunks[pos / CHUNK_SIZE];
+		size_t i = pos % CHUNK_SIZE;
+		m_index[m_indexStart[c.source[i]] + c.id[i]] = pos;
+	}
+	m_indexed = m_size;
+}
+
+
+
+size_t
+Synapses::find(nidx_t source, id32_t id) const
+{
+	using boost::format;
+
+	id32_t count = outdegree(source);
+	if(count == 0) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("synapses of non-existing neuron (%u) requested") % source));
+	}
+	if(id >= count) {
+		throw nemo::exception(NEMO_INVALID_INPUT, "synapse id out or range");
+	}
+	if(m_indexed != m_size) {
+		buildIndex();
+	}
+	return m_index[m_indexStart.find(source)->second + id];
+}
+
+
+
+network::SynapseBlock
+Synapses::block(size_t i) const
+{
+	const Chunk& c = m_chunks.at(i);
+	network::SynapseBlock b;
+	b.size = c.source.size();
+	if(b.size != 0) {
+		b.source = &c.source[0];
+		b.target = &c.target[0];
+		b.delay = &c.delay[0];
+		b.weight = &c.weight[0];
+		b.plastic = &c.plastic[0];
+		b.id = &c.id[0];
+	}
+	return b;
+}
+
+
+
+void
+Synapses::setSynapseIds(nidx_t source, std::vector<synapse_id>& ids) const
+{
+	size_t nSynapses = outdegree(source);
+	ids.resize(nSynapses);
+	for(size_t iSynapse = 0; iSynapse < nSynapses; ++iSynapse) {
+		ids[iSynapse] = make_synapse_id(source, iSynapse);
+	}
+}
+
+}
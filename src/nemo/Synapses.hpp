@@ -0,0 +1,128 @@
+#ifndef NEMO_SYNAPSES_HPP
+#define NEMO_SYNAPSES_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include <deque>
+
+#include <boost/unordered_map.hpp>
+
+#include <nemo/config.h>
+#include <nemo/network/Generator.hpp>
+#include "types.hpp"
+
+namespace nemo {
+
+/*! \brief Append-only collection of synapses
+ *
+ * Synapses are stored in the order in which they are added, as a
+ * structure-of-arrays split into chunks of fixed size. Adding a synapse
+ * never moves existing data, and each chunk can be exported as a set of
+ * contiguous arrays (see \a network::SynapseBlock).
+ *
+ * Each synapse has an id which is unique among the synapses with the same
+ * source, with ids assigned consecutively from 0. Looking up a synapse by
+ * source and id requires an index which is built on demand, the first time
+ * such a lookup is done after synapses have been added.
+ */
+class NEMO_BASE_DLL_PUBLIC Synapses
+{
+	public :
+
+		Synapses() : m_size(0), m_indexed(0) { }
+
+		/*! Add a synapse
+		 *
+		 * \return id of the newly added synapse
+		 */
+		id32_t add(nidx_t source, nidx_t target,
+				delay_t delay, float weight, unsigned char plastic);
+
+		/*! Reserve space for \a n more synapses */
+		void reserve(size_t n);
+
+		/*! \return total number of synapses */
+		size_t size() const { return m_size; }
+
+		/*! \return number of synapses with the given source */
+		id32_t outdegree(nidx_t source) const;
+
+		/*! \return the synapse at the given position in insertion order */
+		Synapse get(size_t pos) const;
+
+		/*! \return position in insertion order of the given synapse
+		 *
+		 * \throws nemo::exception if the synapse does not exist
+		 */
+		size_t find(nidx_t source, id32_t id) const;
+
+		nidx_t target(size_t pos) const { return chunk(pos).target[pos % CHUNK_SIZE]; }
+		delay_t delay(size_t pos) const { return chunk(pos).delay[pos % CHUNK_SIZE]; }
+		float weight(size_t pos) const { return chunk(pos).weight[pos % CHUNK_SIZE]; }
+		unsigned char plastic(size_t pos) const { return chunk(pos).plastic[pos % CHUNK_SIZE]; }
+
+		/*! \return number of chunks, for bulk export */
+		size_t blockCount() const { return m_chunks.size(); }
+
+		/*! \return contiguous arrays for the ith chunk of synapses */
+		network::SynapseBlock block(size_t i) const;
+
+		/*! Populate vector with the ids of all synapses from the given source */
+		void setSynapseIds(nidx_t source, std::vector<synapse_id>&) const;
+
+	private :
+
+		/* The synapses are stored in fixed-size chunks, so that adding
+		 * synapses never copies more than a single chunk. Chunks grow
+		 * geometrically from INITIAL_CAPACITY up to CHUNK_SIZE, unless the
+		 * capacity was set by \a reserve, so that small networks do not pay
+		 * for full chunks. */
+		static const size_t CHUNK_SIZE = 1 << 16;
+		static const size_t INITIAL_CAPACITY = 64;
+
+		struct Chunk
+		{
+			std::vector<nidx_t> source;
+			std::vector<nidx_t> target;
+			std::vector<delay_t> delay;
+			std::vector<float> weight;
+			std::vector<unsigned char> plastic;
+			std::vector<id32_t> id;
+
+			/*! Reserve capacity for \a n synapses in every column */
+			void reserve(size_t n);
+		};
+
+		std::deque<Chunk> m_chunks;
+
+		size_t m_size;
+
+		const Chunk& chunk(size_t pos) const;
+
+		void addChunk(size_t capacity);
+
+		/* Number of synapses for each source, i.e. the next id to assign */
+		typedef boost::unordered_map<nidx_t, id32_t> outdegree_map;
+		outdegree_map m_outdegree;
+
+		/* Index for lookups by source and id. The position of synapse (s, i)
+		 * is m_index[m_indexStart[s] + i]. The index covers the first
+		 * m_indexed synapses. */
+		mutable boost::unordered_map<nidx_t, size_t> m_indexStart;
+		mutable std::vector<size_t> m_index;
+		mutable size_t m_indexed;
+
+		void buildIndex() const;
+};
+
+}
+
+#endif
@@ -89,6 +89,10 @@ class RCM
 
 		size_t synapseCount() const { return m_synapseCount; }
 
+		/*! \return true if the RCM is used at all, i.e. if \a addSynapse has
+		 * any effect */
+		bool enabled() const { return m_enabled; }
+
 		/*! Number of words allocated in any enabled RCM fields
 		 *
 		 * The class maintains the invariant that all RCM fields are either of
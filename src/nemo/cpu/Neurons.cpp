@@ -1,35 +1,74 @@
 #include "Neurons.hpp"
 
+#include <boost/numeric/conversion/cast.hpp>
+
 namespace nemo {
 	namespace cpu {
 
 
+/*! Allocate a zero-initialised array of \a size floats aligned according to
+ * NEMO_CPU_NEURON_ALIGNMENT
+ *
+ * \param alloc storage, which the caller needs to keep alive
+ * \return aligned pointer into \a alloc
+ */
+static
+float*
+allocateAligned(std::vector<float>& alloc, size_t size)
+{
+	const size_t align = NEMO_CPU_NEURON_ALIGNMENT / sizeof(float);
+	alloc.assign(size + align, 0.0f);
+	size_t misalignment = (reinterpret_cast<size_t>(&alloc[0]) / sizeof(float)) % align;
+	return &alloc[0] + (misalignment ? align - misalignment : 0);
+}
+
+
 Neurons::Neurons(const nemo::network::Generator& net,
+				const nemo::ConfigurationImpl& conf,
 				unsigned type_id,
 				RandomMapper<nidx_t>& mapper) :
 	m_base(mapper.typeBase(type_id)),
 	m_type(net.neuronType(type_id)),
 	m_nParam(m_type.parameterCount()),
 	m_nState(m_type.stateVarCount()),
-	m_param(boost::extents[m_nParam][net.neuronCount(type_id)]),
-	m_state(boost::extents[m_type.stateHistory()][m_nState][net.neuronCount(type_id)]),
+	m_stride(((net.neuronCount(type_id) + NEMO_CPU_NEURON_PADDING - 1)
+				/ NEMO_CPU_NEURON_PADDING) * NEMO_CPU_NEURON_PADDING),
+	m_param(allocateAligned(m_paramAlloc, m_nParam * m_stride)),
+	m_state(allocateAligned(m_stateAlloc, m_type.stateHistory() * m_nState * m_stride)),
 	m_stateCurrent(0),
 	m_size(0),
 	m_rng(net.neuronCount(type_id)),
 	m_plugin(m_type.pluginDir() / "cpu", m_type.name()),
-	m_update_neurons((cpu_update_neurons_t*) m_plugin.function("cpu_update_neurons"))
+	m_update_neurons((cpu_update_neurons_t*) m_plugin.function("cpu_update_neurons")),
+	m_update_neurons_fx((cpu_update_neurons_fx_t*) m_plugin.optionalFunction("cpu_update_neurons_fx")),
+	m_update_neurons_philox(NULL)
 {
 	using namespace nemo::network;
+	using boost::format;
 
-	std::fill(m_state.data(), m_state.data() + m_state.num_elements(), 0.0f);
+	/* User indices, in local index order */
+	std::vector<unsigned> userIdx;
+	userIdx.reserve(net.neuronCount(type_id));
+
+	bool counterRng = conf.cpuRng() == NEMO_CPU_RNG_PHILOX && m_type.usesNormalRNG();
+	if(counterRng) {
+		m_update_neurons_philox = (cpu_update_neurons_philox_t*)
+				m_plugin.optionalFunction("cpu_update_neurons_philox");
+		if(m_update_neurons_philox == NULL) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Neuron type %s does not support the counter-based RNG on the CPU backend")
+						% m_type.name()));
+		}
+		m_keys.resize(net.neuronCount(type_id));
+	}
 
 	for(neuron_iterator i = net.neuron_begin(type_id), i_end = net.neuron_end(type_id);
 			i != i_end; ++i) {
 
-		unsigned userIdx = i->first;
 		unsigned localIdx = m_size;
 		unsigned simIdx = m_base + m_size;
-		mapper.insert(userIdx, simIdx);
+		userIdx.push_back(i->first);
+		mapper.insert(i->first, simIdx);
 		mapper.insertTypeMapping(simIdx, type_id);
 
 		const Neuron& n = i->second;
@@ -38,12 +77,24 @@ Neurons::Neurons(const nemo::network::Generator& net,
 		m_size++;
 	}
 
-	nemo::initialiseRng(m_base, m_base+m_size-1, m_rng);
+	/* Both kinds of RNG are seeded from the user seed and the user index,
+	 * so that the random numbers do not depend on how neurons are laid out
+	 * in the simulation. Seeding is constant time per neuron. */
+	const unsigned seed = conf.rngSeed();
+	int nn = boost::numeric_cast<int, size_t>(m_size);
+#pragma omp parallel for default(shared)
+	for(int nl=0; nl < nn; nl++) {
+		nemo::seedRng(seed, userIdx[nl], m_rng[nl]);
+		if(counterRng) {
+			m_keys[nl].key[0] = userIdx[nl];
+			m_keys[nl].key[1] = seed;
+		}
+	}
 
 	cpu_init_neurons_t* init_neurons = (cpu_init_neurons_t*) m_plugin.function("cpu_init_neurons");
 	init_neurons(m_base, m_base + size(),
-			m_param.data(), m_param.strides()[0],
-			m_state.data(), m_state.strides()[0], m_state.strides()[1],
+			m_param, m_stride,
+			m_state, m_nState * m_stride, m_stride,
 			&m_rng[0]);
 }
 
@@ -60,18 +111,18 @@ Neurons::set(unsigned l_idx, unsigned nargs, const float args[])
 						% (m_nParam + m_nState) % nargs));
 	}
 
-	setUnsafe(l_idx, args, args+m_nParam);
+	setUnsafe(l_idx - m_base, args, args+m_nParam);
 }
 
 
 void
-Neurons::setUnsafe(unsigned l_idx, const float param[], const float state[])
+Neurons::setUnsafe(unsigned idx, const float param[], const float state[])
 {
 	for(unsigned i=0; i < m_nParam; ++i) {
-		m_param[i][l_idx] = param[i];
+		paramRow(i)[idx] = param[i];
 	}
 	for(unsigned i=0; i < m_nState; ++i) {
-		m_state[0][i][l_idx] = state[i];
+		stateRow(0, i)[idx] = state[i];
 	}
 }
 
@@ -80,7 +131,7 @@ Neurons::setUnsafe(unsigned l_idx, const float param[], const float state[])
 float
 Neurons::getState(unsigned l_idx, unsigned var) const
 {
-	return m_state[m_stateCurrent][stateIndex(var)][l_idx];
+	return stateRow(m_stateCurrent, stateIndex(var))[l_idx - m_base];
 }
 
 
@@ -88,7 +139,7 @@ Neurons::getState(unsigned l_idx, unsigned var) const
 void
 Neurons::setState(unsigned l_idx, unsigned var, float val)
 {
-	m_state[m_stateCurrent][stateIndex(var)][l_idx] = val;
+	stateRow(m_stateCurrent, stateIndex(var))[l_idx - m_base] = val;
 }
 
 
@@ -96,7 +147,7 @@ Neurons::setState(unsigned l_idx, unsigned var, float val)
 void
 Neurons::setParameter(unsigned l_idx, unsigned param, float val)
 {
-	m_param[parameterIndex(param)][l_idx] = val;
+	paramRow(parameterIndex(param))[l_idx - m_base] = val;
 }
 
 
@@ -104,14 +155,14 @@ Neurons::setParameter(unsigned l_idx, unsigned param, float val)
 float
 Neurons::getParameter(unsigned l_idx, unsigned param) const
 {
-	return m_param[parameterIndex(param)][l_idx];
+	return paramRow(parameterIndex(param))[l_idx - m_base];
 }
 
 
 void
 Neurons::update(
 		unsigned cycle,
-		unsigned fbits,
+		const cpu_fx_current_t& current,
 		float currentEPSP[],
 		float currentIPSP[],
 		float currentExternal[],
@@ -122,10 +173,47 @@ Neurons::update(
 {
 	m_stateCurrent = (cycle+1) % m_type.stateHistory();
 
+	if(m_update_neurons_philox != NULL) {
+		m_update_neurons_philox(m_base, m_base + size(), cycle,
+				m_param, m_stride,
+				m_state, m_nState * m_stride, m_stride,
+				fstim,
+				&m_keys[0],
+				&current,
+				currentExternal,
+				recentFiring,
+				fired,
+				rcm);
+		return;
+	}
+
+	if(m_update_neurons_fx != NULL) {
+		m_update_neurons_fx(m_base, m_base + size(), cycle,
+				m_param, m_stride,
+				m_state, m_nState * m_stride, m_stride,
+				fstim,
+				&m_rng[0],
+				&current,
+				currentExternal,
+				recentFiring,
+				fired,
+				rcm);
+		return;
+	}
+
+	/* Convert the current for this group only */
+	int nn = boost::numeric_cast<int, size_t>(size());
+#pragma omp parallel for default(shared)
+	for(int nl=0; nl < nn; nl++) {
+		unsigned ng = m_base + nl;
+		currentEPSP[ng] = cpu_fx_consume(&current, current.excitatory, ng);
+		currentIPSP[ng] = cpu_fx_consume(&current, current.inhibitory, ng);
+	}
+
 	m_update_neurons(m_base, m_base + size(), cycle,
-			m_param.data(), m_param.strides()[0],
-			m_state.data(), m_state.strides()[0], m_state.strides()[1],
-			fbits,
+			m_param, m_stride,
+			m_state, m_nState * m_stride, m_stride,
+			current.fbits,
 			fstim,
 			&m_rng[0],
 			currentEPSP,
@@ -10,8 +10,9 @@
  * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <boost/multi_array.hpp>
+#include <vector>
 
+#include <nemo/ConfigurationImpl.hpp>
 #include <nemo/RandomMapper.hpp>
 #include <nemo/Plugin.hpp>
 #include <nemo/RNG.hpp>
@@ -25,7 +26,8 @@ namespace nemo {
 /*! Neuron population for CPU backend
  *
  * The neurons are stored internally in dense structure-of-arrays with
- * contigous local indices starting from zero.
+ * contigous local indices starting from zero. Each array is aligned and
+ * padded as described in neuron_model.h.
  *
  * \todo deal with multi-threading inside this class
  */
@@ -38,21 +40,29 @@ class Neurons
 		 * As a side effect, the mapper is updated to contain mappings between
 		 * global and local indices for the relevant neurons, as well as
 		 * mappings between type_id and local neuron index.
+		 *
+		 * \throws nemo::exception if the configured RNG is not supported by
+		 * 		the plugin for this neuron type
 		 */
 		Neurons(const network::Generator& net,
+				const ConfigurationImpl& conf,
 				unsigned type_id,
 				RandomMapper<nidx_t>& mapper);
 
 		/*! Update the state of all neurons
 		 *
-		 * \param currentEPSP input current due to EPSPs
-		 * \param currentIPSP input current due to IPSPs
+		 * \param current accumulated input current due to EPSPs and IPSPs
+		 * \param currentEPSP
+		 * 		scratch space for the EPSP current in floating point. This is
+		 * 		only used if the plugin cannot read \a current directly.
+		 * \param currentIPSP scratch space for the IPSP current, as above
 		 * \param currentExternal externally (user-provided input current)
 		 *
-		 * \post the input current vector is set to all zero.
+		 * \post the input current vectors and accumulators are set to all zero.
 		 * \post the firing stimulus buffer (\a fstim) is set to all false.
 		 */
-		void update(unsigned cycle, unsigned fbits,
+		void update(unsigned cycle,
+			const cpu_fx_current_t& current,
 			float currentEPSP[],
 			float currentIPSP[],
 			float currentExternal[],
@@ -113,35 +123,42 @@ class Neurons
 		const unsigned m_nParam;
 		const unsigned m_nState;
 
-		/*! Neurons are stored in several structure-of-arrays, supporting
-		 * arbitrary neuron types. Functions modifying these maintain the
-		 * invariant that the shapes are the same.
-		 *
-		 * The indices here are:
+		/*! Number of neurons in each array, including padding */
+		size_t m_stride;
+
+		/*! Neuron parameters are stored in a structure-of-arrays format,
+		 * supporting arbitrary neuron types. Parameter p for neuron n is
+		 * found at m_param[p * m_stride + n].
 		 *
-		 * 1. (outer) parameter index
-		 * 2. (inner) neuron index
-		 */
-		typedef boost::multi_array<float, 2> param_type;
-		param_type m_param;
+		 * m_param points into m_paramAlloc, which is over-allocated so that
+		 * m_param can be aligned. */
+		std::vector<float> m_paramAlloc;
+		float* m_param;
 
 		/*! Neuron state is stored in a structure-of-arrays format, supporting
-		 * arbitrary neuron types. Functions modifying these maintain the
+		 * arbitrary neuron types. State variable v in history slot h for
+		 * neuron n is found at m_state[(h * m_nState + v) * m_stride + n].
 		 *
-		 * The indices here are:
-		 *
-		 * 1. (outer) history index
-		 * 2.         variable index
-		 * 3. (inner) neuron index
-		 */
-		typedef boost::multi_array<float, 3> state_type;
-		state_type m_state;
+		 * Allocation as for m_param. */
+		std::vector<float> m_stateAlloc;
+		float* m_state;
+
+		/*! \return pointer to a given parameter or state variable for the
+		 * first neuron */
+		float* paramRow(unsigned param) const { return m_param + param * m_stride; }
+		float* stateRow(unsigned hist, unsigned var) const {
+			return m_state + (hist * m_nState + var) * m_stride;
+		}
 
 		/* History index corresponding to most recent state */
 		unsigned m_stateCurrent;
 
-		/*! Set neuron, like \a cpu::Neurons::set, but with fewer checks */
-		void setUnsafe(unsigned l_idx, const float param[], const float state[]);
+		/*! Set neuron, like \a cpu::Neurons::set, but with fewer checks
+		 *
+		 * \param idx index within this collection, i.e. local index minus
+		 * 		the type base
+		 */
+		void setUnsafe(unsigned idx, const float param[], const float state[]);
 
 		/*! Number of neurons in this collection */
 		size_t m_size;
@@ -155,12 +172,28 @@ class Neurons
 		/*! RNG with separate state for each neuron */
 		std::vector<RNG> m_rng;
 
+		/*! Key for the counter-based RNG for each neuron. Empty unless the
+		 * counter-based RNG is used. */
+		std::vector<PhiloxKey> m_keys;
+
 		//! \todo maintain firing buffer etc. here instead?
 
+		Neurons(const Neurons&);
+		Neurons& operator=(const Neurons&);
+
 		/* The update function itself is found in a plugin which is loaded
 		 * dynamically */
 		Plugin m_plugin;
 		cpu_update_neurons_t* m_update_neurons;
+
+		/* Optional update function which reads the fixed-point current
+		 * accumulators directly. NULL if not provided by the plugin. */
+		cpu_update_neurons_fx_t* m_update_neurons_fx;
+
+		/* Update function using the counter-based RNG. Set only if the
+		 * counter-based RNG is configured and required by this neuron
+		 * type. */
+		cpu_update_neurons_philox_t* m_update_neurons_philox;
 };
 
 
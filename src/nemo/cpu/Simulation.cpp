@@ -1,6 +1,8 @@
 #include "Simulation.hpp"
 
 #include <cmath>
+#include <cassert>
+#include <algorithm>
 
 #include <boost/format.hpp>
 #include <boost/numeric/conversion/cast.hpp>
@@ -33,28 +35,51 @@ namespace nemo {
 	namespace cpu {
 
 
+/* Number of target neurons processed as a unit in the parallel STDP
+ * functions */
+const unsigned STDP_CHUNK = 256;
+
+
+/* Tag for the keys of the input generator RNGs. Neuron RNGs are keyed by the
+ * global neuron index alone, and procedural connectivity by the rule index
+ * plus one in the upper word, so the top bit keeps the input streams apart
+ * from both. */
+const uint64_t INPUT_RNG_DOMAIN = uint64_t(1) << 63;
+
+
 Simulation::Simulation(
 		const nemo::network::Generator& net,
 		const nemo::ConfigurationImpl& conf) :
 	m_neuronCount(net.neuronCount()),
 	m_fired(m_neuronCount, 0),
 	m_recentFiring(m_neuronCount, 0),
-	m_delays(m_neuronCount, 0),
-	mfx_currentE(m_neuronCount, 0U),
+	m_history(m_neuronCount, net.maxDelay()),
+	m_delayWords(std::max(1U, (net.maxDelay() + 63) / 64)),
+	m_deliveryEngine(conf.cpuDeliveryEngine()),
+	m_rngSeed(conf.rngSeed()),
+#ifdef NEMO_CPU_OPENMP_ENABLED
+	m_deliveryThreads(omp_get_max_threads()),
+#else
+	m_deliveryThreads(1),
+#endif
 	m_currentE(m_neuronCount, 0.0f),
-	mfx_currentI(m_neuronCount, 0U),
 	m_currentI(m_neuronCount, 0.0),
+	m_ringDepth(0),
 	m_currentExt(m_neuronCount, 0.0f),
 	m_fstim(m_neuronCount, 0)
 {
 	using boost::format;
 
-	if(net.maxDelay() > 64) {
+	/* The ring engine adds the weight of each synapse to the ring when the
+	 * spike is generated, so weight changes from applyStdp would not reach
+	 * spikes already in flight */
+	if(m_deliveryEngine == NEMO_CPU_DELIVERY_RING && conf.stdpFunction()) {
 		throw nemo::exception(NEMO_INVALID_INPUT,
-				str(format("The network has synapses with delay %ums. The CPU backend supports a maximum of 64 ms")
-						% net.maxDelay()));
+				"The ring spike delivery engine cannot be used with STDP");
 	}
 
+	m_mapper.reserve(net);
+
 	/* Contigous local neuron indices */
 	nidx_t l_idx = 0;
 
@@ -67,15 +92,65 @@ Simulation::Simulation(
 			continue;
 		}
 
-		boost::shared_ptr<Neurons> ns(new Neurons(net, type_id, m_mapper));
+		boost::shared_ptr<Neurons> ns(new Neurons(net, conf, type_id, m_mapper));
 		l_idx += ns->size();
 		m_neurons.push_back(ns);
 	}
 
+	m_globalIdx.resize(m_neuronCount);
+	for(nidx_t l=0; l < m_neuronCount; ++l) {
+		m_globalIdx[l] = m_mapper.globalIdx(l);
+	}
+
+	std::vector< std::pair<nidx_t, nidx_t> > order(m_neuronCount);
+	for(nidx_t l=0; l < m_neuronCount; ++l) {
+		order[l] = std::make_pair(m_globalIdx[l], l);
+	}
+	std::sort(order.begin(), order.end());
+	m_denseLocalIdx.resize(m_neuronCount);
+	for(size_t i=0; i < m_neuronCount; ++i) {
+		m_denseLocalIdx[i] = order[i].second;
+	}
+	m_firedThread.resize(m_deliveryThreads);
+	m_firedOffset.resize(m_deliveryThreads + 1, 0);
+
 	m_cm.reset(new nemo::ConnectivityMatrix(net, conf, m_mapper));
 
-	for(size_t source=0; source < m_neuronCount; ++source) {
-		m_delays[source] = m_cm->delayBits(source);
+	m_fxCurrent.stride = m_neuronCount;
+	m_fxCurrent.buffers = 1;
+	m_fxCurrent.fbits = getFractionalBits();
+
+	if(m_deliveryEngine == NEMO_CPU_DELIVERY_PUSH) {
+		m_fxCurrent.buffers = m_deliveryThreads;
+	}
+
+	if(m_deliveryEngine != NEMO_CPU_DELIVERY_RING) {
+		mfx_currentE.resize(m_fxCurrent.buffers * m_neuronCount, 0U);
+		mfx_currentI.resize(m_fxCurrent.buffers * m_neuronCount, 0U);
+		m_fxCurrent.excitatory = &mfx_currentE[0];
+		m_fxCurrent.inhibitory = &mfx_currentI[0];
+	}
+
+	if(m_deliveryEngine == NEMO_CPU_DELIVERY_RING) {
+		m_ringDepth = std::max(delay_t(1), m_cm->maxDelay());
+		m_ringE.resize(m_ringDepth * m_neuronCount, 0U);
+		m_ringI.resize(m_ringDepth * m_neuronCount, 0U);
+		m_ringDelayOffset.push_back(0);
+		for(size_t source=0; source < m_neuronCount; ++source) {
+			for(delay_t d=1; d <= m_cm->maxDelay(); ++d) {
+				if(m_cm->rowLength(source, d)) {
+					m_ringDelays.push_back(d);
+				}
+			}
+			m_ringDelayOffset.push_back(m_ringDelays.size());
+		}
+	} else {
+		m_delays.resize(m_neuronCount * m_delayWords, 0);
+		for(size_t source=0; source < m_neuronCount; ++source) {
+			for(unsigned w=0; w < m_delayWords; ++w) {
+				m_delays[source * m_delayWords + w] = m_cm->delayBits(source, w);
+			}
+		}
 	}
 
 	resetTimer();
@@ -95,18 +170,22 @@ void
 Simulation::fire()
 {
 	deliverSpikes();
+	generateInput(m_timer.elapsedSimulation());
 	for(neuron_groups::const_iterator i = m_neurons.begin();
 			i != m_neurons.end(); ++i) {
 		(*i)->update(
-			m_timer.elapsedSimulation(), getFractionalBits(),
+			m_timer.elapsedSimulation(), m_fxCurrent,
 			&m_currentE[0], &m_currentI[0], &m_currentExt[0],
 			&m_fstim[0], &m_recentFiring[0], &m_fired[0],
 			const_cast<void*>(static_cast<const void*>(m_cm->rcm())));
 	}
 
-	//! \todo do this in the postfire step
-	m_cm->accumulateStdp(m_recentFiring);
 	setFiring();
+	//! \todo do this in the postfire step
+	accumulateStdp();
+	if(m_deliveryEngine == NEMO_CPU_DELIVERY_RING) {
+		scatterSpikes(m_timer.elapsedSimulation() + 1);
+	}
 	m_timer.step();
 }
 
@@ -119,17 +198,33 @@ Simulation::propagate_raw(uint32_t* fired, int nfired)
 	//! \todo assert that STDP is not enabled
 
 	/* convert the input firing to the format required by deliverSpikes */
+	m_history.advance();
 #pragma omp parallel for default(shared)
 	for(unsigned n=0; n <= m_mapper.maxGlobalIdx(); ++n) {
-		m_recentFiring[n] <<= 1;
+		m_history.record(n, false);
 	}
 
-#pragma omp parallel for default(shared)
+	m_firedLocal.clear();
 	for(int i=0; i < nfired; ++i) {
 		uint32_t n = fired[i];
-		m_recentFiring[n] |= uint64_t(1);
+		m_history.record(n, true);
+		addActiveSource(n);
+		m_firedLocal.push_back(n);
 	}
+	pruneActiveSources();
+
+	/* The input firing is due for delivery with a delay of one in this cycle */
+	if(m_deliveryEngine == NEMO_CPU_DELIVERY_RING) {
+		scatterSpikes(m_timer.elapsedSimulation());
+	}
+
 	deliverSpikes();
+	int ncount = boost::numeric_cast<int, unsigned>(m_neuronCount);
+#pragma omp parallel for default(shared)
+	for(int n=0; n < ncount; n++) {
+		m_currentE[n] = cpu_fx_consume(&m_fxCurrent, m_fxCurrent.excitatory, n);
+		m_currentI[n] = cpu_fx_consume(&m_fxCurrent, m_fxCurrent.inhibitory, n);
+	}
 	m_timer.step();
 
 	return std::make_pair<float*, float*>(&m_currentE[0], &m_currentI[0]);
@@ -137,6 +232,25 @@ Simulation::propagate_raw(uint32_t* fired, int nfired)
 #endif
 
 
+void
+Simulation::accumulateStdp()
+{
+	if(!m_cm->stdpEnabled()) {
+		return;
+	}
+
+	int nchunks = boost::numeric_cast<int, size_t>((m_neuronCount + STDP_CHUNK - 1) / STDP_CHUNK);
+
+#pragma omp parallel for default(shared) schedule(dynamic)
+	for(int c=0; c < nchunks; ++c) {
+		nidx_t begin = c * STDP_CHUNK;
+		nidx_t end = nidx_t(std::min(size_t(begin + STDP_CHUNK), m_neuronCount));
+		m_cm->accumulateStdp(m_history, begin, end);
+	}
+}
+
+
+
 void
 Simulation::setFiringStimulus(const std::vector<unsigned>& fstim)
 {
@@ -175,36 +289,179 @@ Simulation::finalizeCurrentStimulus(size_t count)
 void
 Simulation::setCurrentStimulus(const std::vector<float>& current)
 {
-	if(m_currentExt.empty()) {
-		//! do we need to clear current?
+	using boost::format;
+
+	/* The current is cleared after use, so no need to reset */
+	if(current.empty()) {
 		return;
 	}
-	/*! \todo We need to deal with the mapping from global to local neuron
-	 * indices. Before doing this, we should probably change the interface
-	 * here. Note that this function is only used internally (see mpi::Worker),
-	 * so we might be able to use the existing interface, and make sure that we
-	 * only use local indices. */
-	throw nemo::exception(NEMO_API_UNSUPPORTED, "setting current stimulus vector not supported for CPU backend");
-#if 0
-	if(current.size() != m_current.size()) {
-		throw nemo::exception(NEMO_INVALID_INPUT, "current stimulus vector not of expected size");
-	}
-	m_current = current;
-#endif
+	if(current.size() != m_neuronCount) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("current stimulus vector has %u entries, but the network has %u neurons")
+					% current.size() % m_neuronCount));
+	}
+	int ncount = boost::numeric_cast<int, size_t>(m_neuronCount);
+#pragma omp parallel for default(shared)
+	for(int i=0; i < ncount; ++i) {
+		m_currentExt[m_denseLocalIdx[i]] = current[i];
+	}
+}
+
+
+
+void
+Simulation::addInputGenerator(const InputGenerator& generator,
+		const std::vector<unsigned>& neurons)
+{
+	using boost::format;
+
+	InputPopulation input;
+	input.targets.resize(neurons.size());
+	for(size_t i=0; i < neurons.size(); ++i) {
+		input.targets[i] = m_mapper.localIdx(neurons[i]);
+	}
+
+	std::vector<nidx_t> sorted(input.targets);
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<nidx_t>::const_iterator repeated = std::adjacent_find(sorted.begin(), sorted.end());
+	if(repeated != sorted.end()) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Neuron %u listed more than once as target of input generator")
+					% m_globalIdx[*repeated]));
+	}
+
+	input.generator.reset(generator.clone());
+
+	unsigned nstate = generator.stateCount();
+	input.state.resize(neurons.size() * nstate);
+	for(size_t i=0; i < neurons.size(); ++i) {
+		input.generator->initState(nstate ? &input.state[i * nstate] : NULL);
+	}
+
+	/* Seed each target's RNG from the user seed, its global index and the
+	 * position of the generator, so that streams are independent of the
+	 * backend mapping, and unrelated to the target's own noise stream */
+	input.rng.resize(neurons.size());
+	uint64_t population = m_inputs.size();
+	for(size_t i=0; i < neurons.size(); ++i) {
+		seedRng(m_rngSeed, INPUT_RNG_DOMAIN | (population << 32) | uint64_t(neurons[i]),
+				input.rng[i]);
+	}
+
+	m_inputs.push_back(input);
+}
+
+
+
+void
+Simulation::generateInput(unsigned long cycle)
+{
+	for(std::vector<InputPopulation>::iterator p = m_inputs.begin();
+			p != m_inputs.end(); ++p) {
+		const InputGenerator& generator = *p->generator;
+		unsigned nstate = generator.stateCount();
+		float* state = p->state.empty() ? NULL : &p->state[0];
+		int ntargets = boost::numeric_cast<int, size_t>(p->targets.size());
+#pragma omp parallel for default(shared)
+		for(int i=0; i < ntargets; ++i) {
+			m_currentExt[p->targets[i]] += generator.current(cycle, state + i * nstate, &p->rng[i]);
+		}
+	}
 }
 
 
 
-//! \todo use per-thread buffers and just copy these in bulk
 void
 Simulation::setFiring()
 {
+	m_history.advance();
 	m_firingBuffer.enqueueCycle();
-	for(unsigned n=0; n < m_neuronCount; ++n) {
-		if(m_fired[n]) {
-			m_firingBuffer.addFiredNeuron(m_mapper.globalIdx(n));
+
+	/* The per-thread lists are sized when the simulation is created, so the
+	 * thread count must not change if omp_set_num_threads is called later */
+#pragma omp parallel default(shared) num_threads(m_deliveryThreads)
+	{
+#ifdef NEMO_CPU_OPENMP_ENABLED
+		size_t t = omp_get_thread_num();
+		size_t nthreads = omp_get_num_threads();
+#else
+		size_t t = 0;
+		size_t nthreads = 1;
+#endif
+		assert(nthreads <= m_firedThread.size());
+
+		std::vector<nidx_t>& fired = m_firedThread[t];
+		fired.clear();
+		size_t begin = t * m_neuronCount / nthreads;
+		size_t end = (t+1) * m_neuronCount / nthreads;
+		for(size_t n=begin; n < end; ++n) {
+			m_history.record(n, m_fired[n] != 0);
+			if(m_fired[n]) {
+				fired.push_back(n);
+			}
+		}
+
+#pragma omp barrier
+#pragma omp single
+		{
+			for(size_t i=0; i < nthreads; ++i) {
+				m_firedOffset[i+1] = m_firedOffset[i] + m_firedThread[i].size();
+			}
+			m_firedLocal.resize(m_firedOffset[nthreads]);
+			m_firedGlobal.resize(m_firedOffset[nthreads]);
+		}
+
+		size_t offset = m_firedOffset[t];
+		for(size_t i=0; i < fired.size(); ++i) {
+			m_firedLocal[offset + i] = fired[i];
+			m_firedGlobal[offset + i] = m_globalIdx[fired[i]];
 		}
 	}
+
+	m_firingBuffer.addFiredNeurons(m_firedGlobal);
+
+	for(std::vector<nidx_t>::const_iterator i = m_firedLocal.begin();
+			i != m_firedLocal.end(); ++i) {
+		addActiveSource(*i);
+	}
+	pruneActiveSources();
+}
+
+
+
+void
+Simulation::pruneActiveSources()
+{
+	std::vector<nidx_t>::iterator out = m_activeSources.begin();
+	for(std::vector<nidx_t>::const_iterator i = m_activeSources.begin();
+			i != m_activeSources.end(); ++i) {
+		if(m_history.any(*i, 0, m_cm->maxDelay())) {
+			*out++ = *i;
+		}
+	}
+	m_activeSources.erase(out, m_activeSources.end());
+}
+
+
+
+void
+Simulation::addActiveSource(nidx_t source)
+{
+	/* Only push delivery uses the list */
+	if(m_deliveryEngine != NEMO_CPU_DELIVERY_PUSH) {
+		return;
+	}
+
+	bool hasSynapses = false;
+	for(unsigned w=0; w < m_delayWords; ++w) {
+		hasSynapses = hasSynapses || m_delays[source * m_delayWords + w];
+	}
+
+	/* The source is already in the list if it fired within the delay window
+	 * before the current cycle. Age 0 is the current cycle's firing */
+	if(hasSynapses && !m_history.any(source, 1, m_cm->maxDelay() + 1)) {
+		m_activeSources.push_back(source);
+	}
 }
 
 
@@ -250,7 +507,18 @@ Simulation::setNeuronParameter(unsigned g_idx, unsigned parameter, float val)
 void
 Simulation::applyStdp(float reward)
 {
-	m_cm->applyStdp(reward);
+	fix_t fx_reward = m_cm->stdpReward(reward);
+
+	/* As for accumulateStdp. The work per target is proportional to its
+	 * number of plastic synapses. */
+	int nchunks = boost::numeric_cast<int, size_t>((m_neuronCount + STDP_CHUNK - 1) / STDP_CHUNK);
+
+#pragma omp parallel for default(shared) schedule(dynamic)
+	for(int c=0; c < nchunks; ++c) {
+		nidx_t begin = c * STDP_CHUNK;
+		nidx_t end = nidx_t(std::min(size_t(begin + STDP_CHUNK), m_neuronCount));
+		m_cm->applyStdp(fx_reward, begin, end);
+	}
 }
 
 
@@ -258,46 +526,176 @@ Simulation::applyStdp(float reward)
 void
 Simulation::deliverSpikes()
 {
-	/* Ignore spikes outside of max delay. We keep these older spikes as they
-	 * may be needed for STDP */
-	uint64_t validSpikes = ~(((uint64_t) (~0)) << m_cm->maxDelay());
+	switch(m_deliveryEngine) {
+		case NEMO_CPU_DELIVERY_PULL : deliverSpikesPull(); break;
+		case NEMO_CPU_DELIVERY_RING : deliverSpikesRing(); break;
+		default : deliverSpikesPush(); break;
+	}
+}
 
-	for(size_t source=0; source < m_neuronCount; ++source) {
 
-		uint64_t f = m_recentFiring[source] & validSpikes & m_delays[source];
 
-		int delay = 0;
-		while(f) {
-			int shift = 1 + ctz64(f);
-			delay += shift;
-			f = f >> shift;
-			deliverSpikesOne(source, delay);
+void
+Simulation::deliverSpikesPush()
+{
+	int nactive = boost::numeric_cast<int, size_t>(m_activeSources.size());
+
+	/* Number of accumulators written to in this cycle. Each thread claims
+	 * the next free accumulator when it first has a spike to deliver, so
+	 * that the used accumulators are always the first ones. Only those are
+	 * summed and cleared by cpu_fx_consume, so a quiet cycle costs nothing
+	 * here, and otherwise the reduction costs O(N) per thread which
+	 * actually delivered spikes rather than per thread. */
+	unsigned used = 0;
+
+	/* Only neurons which fired recently can have spikes due for delivery, so
+	 * there is no need to look at any other sources. The amount of work per
+	 * active source is irregular, so use a dynamic schedule. There is one
+	 * accumulator per thread, allocated when the simulation was created,
+	 * so the thread count is fixed. */
+#pragma omp parallel default(shared) num_threads(m_deliveryThreads) if(nactive > 0)
+	{
+		wfix_t* currentE = NULL;
+		wfix_t* currentI = NULL;
+
+#pragma omp for schedule(dynamic, 16)
+		for(int i=0; i < nactive; ++i) {
+
+			nidx_t source = m_activeSources[i];
+			const uint64_t* delays = &m_delays[source * m_delayWords];
+
+			/* Bit d-1 in the firing history is set if the source fired d
+			 * cycles ago, i.e. if spikes with delay d are due */
+			for(unsigned w=0; w < m_delayWords; ++w) {
+				uint64_t f = m_history.window(source, w*64) & delays[w];
+				int delay = w*64;
+				while(f) {
+					/* Shift in two steps, as the total may be 64 */
+					int skip = ctz64(f);
+					delay += 1 + skip;
+					f = (f >> skip) >> 1;
+					if(currentE == NULL) {
+						size_t buffer;
+#pragma omp critical(nemo_cpu_push_buffer)
+						buffer = used++;
+						currentE = &mfx_currentE[buffer * m_neuronCount];
+						currentI = &mfx_currentI[buffer * m_neuronCount];
+					}
+					deliverSpikesOne(source, delay, currentE, currentI);
+				}
+			}
 		}
 	}
 
-	/* convert current back to float */
-	unsigned fbits = getFractionalBits();
+	m_fxCurrent.buffers = used;
+}
+
+
+
+void
+Simulation::deliverSpikesPull()
+{
+	assert(m_cm->hasIncoming());
+
 	int ncount = boost::numeric_cast<int, unsigned>(m_neuronCount);
-#pragma omp parallel for default(shared)
-	for(int n=0; n < ncount; n++) {
-		m_currentE[n] = wfx_toFloat(mfx_currentE[n], fbits);
-		mfx_currentE[n] = 0U;
-		m_currentI[n] = wfx_toFloat(mfx_currentI[n], fbits);
-		mfx_currentI[n] = 0U;
+
+	/* The static schedule gives each thread a contiguous range of targets */
+#pragma omp parallel for default(shared) schedule(static)
+	for(int target=0; target < ncount; ++target) {
+
+		wfix_t accE = 0;
+		wfix_t accI = 0;
+
+		for(const IncomingTerminal* i = m_cm->incoming_begin(target);
+				i != m_cm->incoming_end(target); ++i) {
+			/* Bit d-1 in the firing history is set if the source fired d
+			 * cycles ago */
+			if(m_history.fired(i->source, i->delay-1)) {
+				fix_t weight = *i->weight;
+				if(weight >= 0) {
+					accE += weight;
+				} else {
+					accI += weight;
+				}
+			}
+		}
+
+		mfx_currentE[target] = accE;
+		mfx_currentI[target] = accI;
 	}
 }
 
 
 
 void
-Simulation::deliverSpikesOne(nidx_t source, delay_t delay)
+Simulation::deliverSpikesRing()
 {
-	const nemo::Row& row = m_cm->getRow(source, delay);
+	size_t offset = (m_timer.elapsedSimulation() % m_ringDepth) * m_neuronCount;
+	m_fxCurrent.excitatory = &m_ringE[offset];
+	m_fxCurrent.inhibitory = &m_ringI[offset];
+}
+
+
+
+void
+Simulation::scatterSpikes(unsigned long cycle)
+{
+	int nfired = boost::numeric_cast<int, size_t>(m_firedLocal.size());
+
+	/* Different sources may share targets, so accumulate atomically. Since
+	 * fixed-point addition is associative the result does not depend on the
+	 * order in which the sources are processed. */
+#pragma omp parallel for default(shared) schedule(dynamic, 16)
+	for(int i=0; i < nfired; ++i) {
+		nidx_t source = m_firedLocal[i];
+		for(size_t d = m_ringDelayOffset[source]; d < m_ringDelayOffset[source+1]; ++d) {
+			delay_t delay = m_ringDelays[d];
+			size_t offset = ((cycle + delay - 1) % m_ringDepth) * m_neuronCount;
+			deliverSpikesOne(source, delay, &m_ringE[offset], &m_ringI[offset], true);
+		}
+	}
+}
+
+
+
+void
+Simulation::deliverSpikesOne(nidx_t source, delay_t delay,
+		wfix_t* currentE, wfix_t* currentI, bool atomic)
+{
+	if(m_cm->packed()) {
+		const nemo::PackedRow row = m_cm->getPackedRow(source, delay);
+		for(unsigned s=0; s < row.len; ++s) {
+			nidx_t target = row.target(s);
+			fix_t weight = row.weight(s);
+			assert(target < m_neuronCount);
+			wfix_t* current = weight >= 0 ? currentE : currentI;
+			if(atomic) {
+#pragma omp atomic
+				current[target] += weight;
+			} else {
+				current[target] += weight;
+			}
+			LOG("c%lu: n%u -> n%u: %+f (delay %u)\n",
+					elapsedSimulation(),
+					m_mapper.globalIdx(source),
+					m_mapper.globalIdx(target),
+					fx_toFloat(weight, getFractionalBits()), delay);
+		}
+		return;
+	}
+
+	const nemo::Row row = m_cm->getRow(source, delay);
 
 	for(unsigned s=0; s < row.len; ++s) {
 		const FAxonTerminal& terminal = row[s];
-		std::vector<wfix_t>& current = terminal.weight >= 0 ? mfx_currentE : mfx_currentI;
-		current.at(terminal.target) += terminal.weight;
+		assert(terminal.target < m_neuronCount);
+		wfix_t* current = terminal.weight >= 0 ? currentE : currentI;
+		if(atomic) {
+#pragma omp atomic
+			current[terminal.target] += terminal.weight;
+		} else {
+			current[terminal.target] += terminal.weight;
+		}
 		LOG("c%lu: n%u -> n%u: %+f (delay %u)\n",
 				elapsedSimulation(),
 				m_mapper.globalIdx(source),
@@ -12,14 +12,18 @@
 
 #include <vector>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <nemo/config.h>
 #include <nemo/internal_types.h>
 #include <nemo/internals.hpp>
 #include <nemo/ConnectivityMatrix.hpp>
 #include <nemo/FiringBuffer.hpp>
+#include <nemo/FiringHistory.hpp>
+#include <nemo/InputGenerator.hpp>
 #include <nemo/Neurons.hpp>
 #include <nemo/RandomMapper.hpp>
+#include <nemo/RNG.hpp>
 #include <nemo/Timer.hpp>
 
 #include "Neurons.hpp"
@@ -75,6 +79,10 @@ class NEMO_CPU_DLL_PUBLIC Simulation : public nemo::SimulationBackend
 		/*! \copydoc nemo::SimulationBackend::applyStdp */
 		void applyStdp(float reward);
 
+		/*! \copydoc nemo::Simulation::addInputGenerator */
+		void addInputGenerator(const InputGenerator& generator,
+				const std::vector<unsigned>& neurons);
+
 		/*! \copydoc nemo::SimulationBackend::setNeuron */
 		void setNeuron(unsigned idx, unsigned nargs, const float args[]);
 
@@ -124,6 +132,15 @@ class NEMO_CPU_DLL_PUBLIC Simulation : public nemo::SimulationBackend
 
 		RandomMapper<nidx_t> m_mapper;
 
+		/* Global index of each local neuron. This is the same mapping as
+		 * m_mapper.globalIdx, in a form cheap enough for the firing path */
+		std::vector<nidx_t> m_globalIdx;
+
+		/* Local index of each neuron, ordered by global index. Entry i refers
+		 * to the neuron with the i-th lowest global index. This is the
+		 * permutation applied to dense current stimulus. */
+		std::vector<nidx_t> m_denseLocalIdx;
+
 		typedef std::vector<fix_t> current_vector_t;
 
 		//! \todo can we get rid of this?
@@ -132,26 +149,110 @@ class NEMO_CPU_DLL_PUBLIC Simulation : public nemo::SimulationBackend
 		/* last cycles firing, one entry per neuron */
 		std::vector<unsigned> m_fired;
 
-		/* last 64 cycles worth of firing, one entry per neuron */
+		/* last 64 cycles worth of firing, one entry per neuron. This is
+		 * maintained by the neuron models. The simulation itself uses
+		 * m_history, which is not limited to 64 cycles. */
 		std::vector<uint64_t> m_recentFiring;
 
+		/* Firing history covering the maximum delay (and STDP window) */
+		FiringHistory m_history;
+
 		/* bit-mask containing delays at which neuron has *any* outoing
-		 * synapses */
+		 * synapses. Each neuron has m_delayWords consecutive words (see
+		 * OutgoingDelays::delayBits) */
 		std::vector<uint64_t> m_delays;
+		unsigned m_delayWords;
+
+		/* Local indices of neurons which have outgoing synapses and have
+		 * fired within the last maxDelay cycles, i.e. the only neurons which
+		 * may have spikes due for delivery. This is maintained incrementally
+		 * in setFiring, in no particular order. */
+		std::vector<nidx_t> m_activeSources;
 
 		boost::scoped_ptr<nemo::ConnectivityMatrix> m_cm;
 
-		/* Per-neuron accumulated current from EPSPs */
+		/* Spike delivery engine, see nemo::Configuration::setCpuDeliveryEngine */
+		cpu_delivery_t m_deliveryEngine;
+
+		/* User seed for all RNGs */
+		unsigned m_rngSeed;
+
+		/* Number of threads used for spike delivery and firing compaction,
+		 * fixed when the simulation is created. This is also the number of
+		 * per-thread current accumulators for the push engine. */
+		unsigned m_deliveryThreads;
+
+		/* Per-neuron accumulated current from EPSPs. For the push engine
+		 * this contains one accumulator per delivery thread, each of length
+		 * m_neuronCount. For the pull engine there is a single accumulator,
+		 * and the ring engine does not use it. */
 		std::vector<wfix_t> mfx_currentE;
-		std::vector<float> m_currentE;
 
-		/* Per-neuron accumulated current from IPSPs */
+		/* Per-neuron accumulated current from IPSPs. Layout as mfx_currentE */
 		std::vector<wfix_t> mfx_currentI;
+
+		/* Accumulated current due for delivery in the current cycle, as set
+		 * by deliverSpikes. The neuron update reads the current from here
+		 * directly, and clears the accumulators. */
+		cpu_fx_current_t m_fxCurrent;
+
+		/* Floating-point current, only used for neuron types which cannot
+		 * read the fixed-point accumulators directly (see Neurons::update) */
+		std::vector<float> m_currentE;
 		std::vector<float> m_currentI;
 
+		/* Delayed current for the ring delivery engine. This is a circular
+		 * buffer with m_ringDepth slots, each containing one accumulator per
+		 * neuron. Slot (c % m_ringDepth) contains the current due for
+		 * delivery in cycle c. */
+		size_t m_ringDepth;
+		std::vector<wfix_t> m_ringE;
+		std::vector<wfix_t> m_ringI;
+
+		/* Delays at which each neuron has outgoing synapses, for the ring
+		 * delivery engine. CSR format, with the delays for local neuron n in
+		 * the range [m_ringDelayOffset[n], m_ringDelayOffset[n+1]) */
+		std::vector<size_t> m_ringDelayOffset;
+		std::vector<delay_t> m_ringDelays;
+
+		/* Local indices of the neurons which fired in the current cycle,
+		 * in increasing order */
+		std::vector<nidx_t> m_firedLocal;
+
+		/* Global indices corresponding to m_firedLocal */
+		std::vector<nidx_t> m_firedGlobal;
+
+		/* Per-thread lists of fired neurons (local indices), used to compact
+		 * the firing vector in parallel in setFiring. m_firedOffset[t] is the
+		 * position of thread t's list in m_firedLocal. There is one list for
+		 * each of the m_deliveryThreads threads. */
+		std::vector< std::vector<nidx_t> > m_firedThread;
+		std::vector<size_t> m_firedOffset;
+
 		/* Per-neuron user-provided input current */
 		std::vector<float> m_currentExt;
 
+		/* Input generator along with the state for each of its targets */
+		struct InputPopulation
+		{
+			boost::shared_ptr<InputGenerator> generator;
+
+			/* Local indices of target neurons */
+			std::vector<nidx_t> targets;
+
+			/* Generator state, with stateCount() consecutive values per target */
+			std::vector<float> state;
+
+			/* RNG with separate state for each target */
+			std::vector<RNG> rng;
+		};
+
+		std::vector<InputPopulation> m_inputs;
+
+		/*! Add the current from all input generators to \a m_currentExt.
+		 * The targets of each generator are evaluated in parallel. */
+		void generateInput(unsigned long cycle);
+
 		/*! firing stimulus (for a single cycle).
 		 *
 		 * This is really a boolean vector, but use unsigned to support
@@ -161,15 +262,87 @@ class NEMO_CPU_DLL_PUBLIC Simulation : public nemo::SimulationBackend
 
 		/*! Deliver spikes due for delivery.
 		 *
-		 * Updates m_currentE and m_currentI
+		 * Accumulates the current using the configured engine, and sets
+		 * m_fxCurrent to refer to the relevant accumulators. The current is
+		 * not converted to floating point here, but as part of the neuron
+		 * update.
 		 */
 		void deliverSpikes();
 
+		/*! Deliver spikes by walking the outgoing synapses of each active source
+		 *
+		 * Source neurons are distributed over threads, with each thread
+		 * accumulating into its own fixed-point buffer. Only the buffers
+		 * which received spikes in this cycle are summed during the neuron
+		 * update (m_fxCurrent.buffers is set accordingly). Since fixed-point
+		 * addition is associative the result is identical to
+		 * single-threaded delivery.
+		 */
+		void deliverSpikesPush();
+
+		/*! Deliver spikes by collecting the incoming synapses of each target
+		 *
+		 * Each thread owns a contiguous range of targets, so no per-thread
+		 * buffers are required.
+		 */
+		void deliverSpikesPull();
+
+		/*! Deliver spikes by selecting the slot in the ring buffer which
+		 * corresponds to the current cycle. The slot is cleared during the
+		 * neuron update. */
+		void deliverSpikesRing();
+
+		/*! Add the current due to the spikes in \a m_firedLocal to the ring
+		 * buffer
+		 *
+		 * \param cycle
+		 * 		simulation cycle in which spikes with a delay of one should be
+		 * 		delivered
+		 */
+		void scatterSpikes(unsigned long cycle);
+
+		/*! Record the current cycle's firing in the firing history and the
+		 * firing buffer and update the list of active sources
+		 *
+		 * The firing vector is compacted into m_firedLocal in parallel, with
+		 * each thread scanning a contiguous range of neurons into its own
+		 * list. The lists are concatenated in thread order, so the result is
+		 * the same as for a serial scan.
+		 */
 		void setFiring();
 
+		/*! Accumulate STDP statistics for the most recent cycle
+		 *
+		 * The targets are split into fixed-size contiguous ranges which are
+		 * processed in parallel. Only targets which fired do any work, so the
+		 * ranges are scheduled dynamically. Each accumulator belongs to a
+		 * single target, so the result does not depend on the thread count.
+		 *
+		 * \pre the current cycle's firing has been recorded in m_history
+		 */
+		void accumulateStdp();
+
+		/*! Remove sources with no more spikes due for delivery from the list
+		 * of active sources
+		 *
+		 * \pre the current cycle's firing has been recorded in m_history
+		 */
+		void pruneActiveSources();
+
+		/*! Add a neuron which fired in the current cycle to the list of active
+		 * sources, unless it is already there
+		 *
+		 * \pre the neuron's firing has been recorded in m_history
+		 */
+		void addActiveSource(nidx_t source);
+
 		FiringBuffer m_firingBuffer;
 
-		void deliverSpikesOne(nidx_t source, delay_t delay);
+		/*! Add the current from all synapses of a single row to the given
+		 * accumulators. If \a atomic is set the accumulation is safe with
+		 * respect to other threads writing to the same accumulators. */
+		void deliverSpikesOne(nidx_t source, delay_t delay,
+				wfix_t* currentE, wfix_t* currentI, bool atomic=false);
 
 		Timer m_timer;
 
@@ -21,23 +21,18 @@
 #include "neuron_model.h"
 
 
-extern "C"
-NEMO_PLUGIN_DLL_PUBLIC
+template<class Current>
 void
-cpu_update_neurons(
+updateNeurons(
 		unsigned start, unsigned end,
 		unsigned cycle,
 		float* paramBase, size_t paramStride,
 		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
-		unsigned fbits,
 		unsigned fstim[],
-		RNG rng[],
-		float currentEPSP[],
-		float currentIPSP[],
+		const Current& current,
 		float currentExternal[],
 		uint64_t recentFiring[],
-		unsigned fired[],
-		void* /* rcm */)
+		unsigned fired[])
 {
 	const float* p_v_rest     = paramBase + PARAM_V_REST     * paramStride;
 	const float* p_c_m        = paramBase + PARAM_C_M        * paramStride;
@@ -78,8 +73,8 @@ cpu_update_neurons(
 
 		//! \todo consider pre-multiplying tau_syn_E/tau_syn_I
 		//! \todo use euler method for the decay as well?
-		float Ie = ((1.0f - 1.0f/p_tau_syn_E[nl]) * Ie0[nl]) + currentEPSP[ng];
-		float Ii = ((1.0f - 1.0f/p_tau_syn_I[nl]) * Ii0[nl]) + currentIPSP[ng];
+		float Ie = ((1.0f - 1.0f/p_tau_syn_E[nl]) * Ie0[nl]) + current.excitatory(ng);
+		float Ii = ((1.0f - 1.0f/p_tau_syn_I[nl]) * Ii0[nl]) + current.inhibitory(ng);
 
 		/* Update the incoming current */
 		float I = Ie + Ii + currentExternal[ng] + p_I_offset[nl];
@@ -122,7 +117,61 @@ cpu_update_neurons(
 }
 
 
+
+
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned /* fbits */,
+		unsigned fstim[],
+		RNG /* rng */[],
+		float currentEPSP[],
+		float currentIPSP[],
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateNeurons(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, FloatCurrent(currentEPSP, currentIPSP), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons_fx(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG /* rng */[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateNeurons(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
+
+
 cpu_update_neurons_t* test = &cpu_update_neurons;
+cpu_update_neurons_fx_t* test_fx = &cpu_update_neurons_fx;
 
 
 #include "default_init.c"
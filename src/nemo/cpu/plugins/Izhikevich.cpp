@@ -1,22 +1,50 @@
 #include <cassert>
 #include <nemo/fixedpoint.hpp>
-#include <nemo/plugins/Izhikevich.h>
 
-#include "neuron_model.h"
+#include "Izhikevich_kernel.hpp"
 
-const unsigned SUBSTEPS = 4;
-const float SUBSTEP_MULT = 0.25f;
 
+/* Scalar reference kernel */
+template<class Current, class Noise>
+void
+updateIzhikevichScalar(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const Noise& noise,
+		const Current& current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[])
+{
+	const IzhikevichData p(cycle, paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride);
 
-extern "C"
-NEMO_PLUGIN_DLL_PUBLIC
+	/* Each neuron has two indices: a local index (within the group containing
+	 * neurons of the same type) and a global index. */
+
+	int nn = end-start;
+	assert(nn >= 0);
+
+#pragma omp parallel for default(shared)
+	for(int nl=0; nl < nn; nl++) {
+		updateIzhikevich(p, nl, start + nl, fstim, noise,
+				current, currentExternal, recentFiring, fired);
+	}
+}
+
+
+
+static
 void
-cpu_update_neurons(
+update_neurons_scalar(
 		unsigned start, unsigned end,
 		unsigned cycle,
 		float* paramBase, size_t paramStride,
 		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
-		unsigned fbits,
+		unsigned /* fbits */,
 		unsigned fstim[],
 		RNG rng[],
 		float currentEPSP[],
@@ -26,77 +54,192 @@ cpu_update_neurons(
 		unsigned fired[],
 		void* /* rcm */)
 {
-	const float* a = paramBase + PARAM_A * paramStride;
-	const float* b = paramBase + PARAM_B * paramStride;
-	const float* c = paramBase + PARAM_C * paramStride;
-	const float* d = paramBase + PARAM_D * paramStride;
-	const float* sigma = paramBase + PARAM_SIGMA * paramStride;
+	updateIzhikevichScalar(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FloatCurrent(currentEPSP, currentIPSP), currentExternal,
+			recentFiring, fired);
+}
 
-	const size_t historyLength = 1;
 
-	/* Current state */
-	size_t b0 = cycle % historyLength;
-	const float* u0 = stateBase + b0 * stateHistoryStride + STATE_U * stateVarStride;
-	const float* v0 = stateBase + b0 * stateHistoryStride + STATE_V * stateVarStride;
 
-	/* Next state */
-	size_t b1 = (cycle+1) % historyLength;
-	float* u1 = stateBase + b1 * stateHistoryStride + STATE_U * stateVarStride;
-	float* v1 = stateBase + b1 * stateHistoryStride + STATE_V * stateVarStride;
+static
+void
+update_neurons_fx_scalar(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG rng[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichScalar(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
 
-	/* Each neuron has two indices: a local index (within the group containing
-	 * neurons of the same type) and a global index. */
 
-	int nn = end-start;
-	assert(nn >= 0);
 
-#pragma omp parallel for default(shared)
-	for(int nl=0; nl < nn; nl++) {
+static
+void
+update_neurons_philox_scalar(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichScalar(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, CounterNoise(keys, cycle),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
 
-		unsigned ng = start + nl;
 
-		float I = currentEPSP[ng] + currentIPSP[ng] + currentExternal[ng];
 
-		/* no need to clear current?PSP. */
+/* Choose the widest vectorised kernel supported by both the build and the
+ * CPU we're running on. See Izhikevich_simd.hpp regarding the differences
+ * between the scalar and vectorised kernels. */
+template<typename K>
+K*
+selectKernel(K* scalar, K* avx2, K* avx512)
+{
+#if defined(NEMO_CPU_AVX512) || defined(NEMO_CPU_AVX2)
+	__builtin_cpu_init();
+#endif
+#ifdef NEMO_CPU_AVX512
+	if(__builtin_cpu_supports("avx512f")) {
+		return avx512;
+	}
+#endif
+#ifdef NEMO_CPU_AVX2
+	if(__builtin_cpu_supports("avx2")) {
+		return avx2;
+	}
+#endif
+	return scalar;
+}
+
 
-		//! \todo clear this outside kernel
-		currentExternal[ng] = 0.0f;
+#ifndef NEMO_CPU_AVX2
+#define update_neurons_avx2 NULL
+#define update_neurons_fx_avx2 NULL
+#define update_neurons_philox_avx2 NULL
+#endif
 
-		if(sigma[nl] != 0.0f) {
-			I += sigma[nl] * nrand(&rng[nl]);
-		}
+#ifndef NEMO_CPU_AVX512
+#define update_neurons_avx512 NULL
+#define update_neurons_fx_avx512 NULL
+#define update_neurons_philox_avx512 NULL
+#endif
 
-		fired[ng] = 0;
 
-		float u = u0[nl];
-		float v = v0[nl];
 
-		for(unsigned t=0; t<SUBSTEPS; ++t) {
-			if(!fired[ng]) {
-				v += SUBSTEP_MULT * ((0.04* v + 5.0) * v + 140.0- u + I);
-				u += SUBSTEP_MULT * (a[nl] * (b[nl] * v - u));
-				fired[ng] = v >= 30.0;
-			}
-		}
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fbits,
+		unsigned fstim[],
+		RNG rng[],
+		float currentEPSP[],
+		float currentIPSP[],
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* rcm)
+{
+	static cpu_update_neurons_t* kernel = selectKernel<cpu_update_neurons_t>(
+			&update_neurons_scalar, update_neurons_avx2, update_neurons_avx512);
+	kernel(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fbits, fstim, rng,
+			currentEPSP, currentIPSP, currentExternal,
+			recentFiring, fired, rcm);
+}
 
-		fired[ng] |= fstim[ng];
-		fstim[ng] = 0;
-		recentFiring[ng] = (recentFiring[ng] << 1) | (uint64_t) fired[ng];
 
-		if(fired[ng]) {
-			v = c[nl];
-			u += d[nl];
-			// LOG("c%lu: n%u fired\n", elapsedSimulation(), m_mapper.globalIdx(n));
-		}
 
-		u1[nl] = u;
-		v1[nl] = v;
-	}
+/* Fused update, reading the synaptic current directly from the fixed-point
+ * accumulators filled during spike delivery */
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons_fx(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG rng[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* rcm)
+{
+	static cpu_update_neurons_fx_t* kernel = selectKernel<cpu_update_neurons_fx_t>(
+			&update_neurons_fx_scalar, update_neurons_fx_avx2, update_neurons_fx_avx512);
+	kernel(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, rng, current, currentExternal,
+			recentFiring, fired, rcm);
+}
+
+
+/* Update using the counter-based RNG for the Gaussian noise */
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons_philox(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* rcm)
+{
+	static cpu_update_neurons_philox_t* kernel = selectKernel<cpu_update_neurons_philox_t>(
+			&update_neurons_philox_scalar, update_neurons_philox_avx2, update_neurons_philox_avx512);
+	kernel(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, keys, current, currentExternal,
+			recentFiring, fired, rcm);
 }
 
 
 cpu_update_neurons_t* test = &cpu_update_neurons;
+cpu_update_neurons_fx_t* test_fx = &cpu_update_neurons_fx;
+cpu_update_neurons_philox_t* test_philox = &cpu_update_neurons_philox;
 
 
 #include "default_init.c"
-
@@ -0,0 +1,79 @@
+/* Izhikevich kernel for CPUs supporting AVX2
+ *
+ * This file must be compiled with AVX2 code generation enabled. It should
+ * only be called after verifying CPU support at run-time.
+ */
+
+#include "Izhikevich_simd.hpp"
+
+void
+update_neurons_avx2(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned /* fbits */,
+		unsigned fstim[],
+		RNG rng[],
+		float currentEPSP[],
+		float currentIPSP[],
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx2>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FloatCurrent(currentEPSP, currentIPSP), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+void
+update_neurons_fx_avx2(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG rng[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx2>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+void
+update_neurons_philox_avx2(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx2>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, CounterNoise(keys, cycle),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
@@ -0,0 +1,95 @@
+/* Izhikevich kernel for CPUs supporting AVX-512
+ *
+ * This file must be compiled with AVX-512 code generation enabled. It should
+ * only be called after verifying CPU support at run-time.
+ */
+
+/* GCC's AVX-512 intrinsics header initialises the result of
+ * _mm512_undefined_* with itself, which is reported as a (maybe-)uninitialized
+ * use once the wrappers in simd.hpp are inlined at -O2. The value is never
+ * read, so the warning is suppressed for the intrinsics and the kernel. */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include "Izhikevich_simd.hpp"
+
+void
+update_neurons_avx512(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned /* fbits */,
+		unsigned fstim[],
+		RNG rng[],
+		float currentEPSP[],
+		float currentIPSP[],
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx512>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FloatCurrent(currentEPSP, currentIPSP), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+void
+update_neurons_fx_avx512(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG rng[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx512>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, StatefulNoise(rng),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+void
+update_neurons_philox_avx512(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	updateIzhikevichVector<nemo::cpu::simd::Avx512>(start, end, cycle,
+			paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride,
+			fstim, CounterNoise(keys, cycle),
+			FixedCurrent(current), currentExternal,
+			recentFiring, fired);
+}
+
+
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,136 @@
+#ifndef NEMO_CPU_PLUGIN_IZHIKEVICH_KERNEL_HPP
+#define NEMO_CPU_PLUGIN_IZHIKEVICH_KERNEL_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Izhikevich neuron update, shared between the scalar reference kernel and
+ * the vectorised kernels. */
+
+#include <nemo/plugins/Izhikevich.h>
+
+#include "neuron_model.h"
+
+const unsigned SUBSTEPS = 4;
+const float SUBSTEP_MULT = 0.25f;
+
+
+/* Parameter and state arrays for a contiguous range of neurons. The arrays
+ * are indexed by local neuron index */
+struct IzhikevichData
+{
+	IzhikevichData(
+			unsigned cycle,
+			float* paramBase, size_t paramStride,
+			float* stateBase, size_t stateHistoryStride, size_t stateVarStride)
+	{
+		a = paramBase + PARAM_A * paramStride;
+		b = paramBase + PARAM_B * paramStride;
+		c = paramBase + PARAM_C * paramStride;
+		d = paramBase + PARAM_D * paramStride;
+		sigma = paramBase + PARAM_SIGMA * paramStride;
+
+		const size_t historyLength = 1;
+
+		/* Current state */
+		size_t b0 = cycle % historyLength;
+		u0 = stateBase + b0 * stateHistoryStride + STATE_U * stateVarStride;
+		v0 = stateBase + b0 * stateHistoryStride + STATE_V * stateVarStride;
+
+		/* Next state */
+		size_t b1 = (cycle+1) % historyLength;
+		u1 = stateBase + b1 * stateHistoryStride + STATE_U * stateVarStride;
+		v1 = stateBase + b1 * stateHistoryStride + STATE_V * stateVarStride;
+	}
+
+	const float* a;
+	const float* b;
+	const float* c;
+	const float* d;
+	const float* sigma;
+
+	const float* u0;
+	const float* v0;
+
+	float* u1;
+	float* v1;
+};
+
+
+
+/* Scalar reference update of a single neuron
+ *
+ * \param nl local neuron index
+ * \param ng global neuron index
+ */
+template<class Current, class Noise>
+inline
+void
+updateIzhikevich(const IzhikevichData& p,
+		unsigned nl, unsigned ng,
+		unsigned fstim[],
+		const Noise& noise,
+		const Current& current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[])
+{
+	float I = current.excitatory(ng) + current.inhibitory(ng) + currentExternal[ng];
+
+	/* no need to clear current?PSP. Fixed-point accumulators are cleared as
+	 * they are read. */
+
+	//! \todo clear this outside kernel
+	currentExternal[ng] = 0.0f;
+
+	if(p.sigma[nl] != 0.0f) {
+		I += p.sigma[nl] * noise.normal(nl);
+	}
+
+	fired[ng] = 0;
+
+	float u = p.u0[nl];
+	float v = p.v0[nl];
+
+	for(unsigned t=0; t<SUBSTEPS; ++t) {
+		if(!fired[ng]) {
+			v += SUBSTEP_MULT * ((0.04* v + 5.0) * v + 140.0- u + I);
+			u += SUBSTEP_MULT * (p.a[nl] * (p.b[nl] * v - u));
+			fired[ng] = v >= 30.0;
+		}
+	}
+
+	fired[ng] |= fstim[ng];
+	fstim[ng] = 0;
+	recentFiring[ng] = (recentFiring[ng] << 1) | (uint64_t) fired[ng];
+
+	if(fired[ng]) {
+		v = p.c[nl];
+		u += p.d[nl];
+		// LOG("c%lu: n%u fired\n", elapsedSimulation(), m_mapper.globalIdx(n));
+	}
+
+	p.u1[nl] = u;
+	p.v1[nl] = v;
+}
+
+
+#ifdef NEMO_CPU_AVX2
+cpu_update_neurons_t update_neurons_avx2;
+cpu_update_neurons_fx_t update_neurons_fx_avx2;
+cpu_update_neurons_philox_t update_neurons_philox_avx2;
+#endif
+
+#ifdef NEMO_CPU_AVX512
+cpu_update_neurons_t update_neurons_avx512;
+cpu_update_neurons_fx_t update_neurons_fx_avx512;
+cpu_update_neurons_philox_t update_neurons_philox_avx512;
+#endif
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef NEMO_CPU_PLUGIN_IZHIKEVICH_SIMD_HPP
+#define NEMO_CPU_PLUGIN_IZHIKEVICH_SIMD_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Vectorised Izhikevich neuron update
+ *
+ * This kernel processes V::WIDTH neurons at a time. It differs from the
+ * scalar reference kernel in that
+ *
+ * - all arithmetic is done in single precision (the reference kernel
+ *   evaluates the v update in double precision)
+ * - the Gaussian noise uses polynomial approximations of log and sin
+ *
+ * The RNG streams are advanced exactly as in the reference kernel (or, for
+ * the counter-based RNG, evaluated for the same keys and counters), so the
+ * uniform random numbers are identical. After a single step the state
+ * variables agree with the reference kernel to within a relative error of
+ * about 1e-5 (more precisely, a few single-precision ulp per substep). Since
+ * a neuron fires when crossing a threshold, this means that a neuron whose
+ * membrane potential ends up within this tolerance of the threshold may fire
+ * in one kernel but not in the other. Over long simulations of recurrent
+ * networks the firing can therefore diverge, while statistics such as
+ * firing rates remain the same.
+ */
+
+#include <cassert>
+
+#include "Izhikevich_kernel.hpp"
+#include "simd.hpp"
+
+/* Vector load of the synaptic input current, for each of the current
+ * sources in Izhikevich_kernel.hpp */
+template<class V>
+typename V::vf
+loadCurrent(const FloatCurrent& current, unsigned ng)
+{
+	return V::add(V::load(current.e + ng), V::load(current.i + ng));
+}
+
+
+/* Fixed-point accumulators may be split over several buffers, so are summed
+ * and converted lane by lane. */
+template<class V>
+typename V::vf
+loadCurrent(const FixedCurrent& current, unsigned ng)
+{
+	float e[V::WIDTH];
+	float i[V::WIDTH];
+	for(unsigned lane=0; lane < V::WIDTH; ++lane) {
+		e[lane] = current.excitatory(ng + lane);
+		i[lane] = current.inhibitory(ng + lane);
+	}
+	return V::add(V::load(e), V::load(i));
+}
+
+
+
+/* Vector draw of the Gaussian noise, for each of the noise sources in
+ * neuron_model.h. Only the lanes in \a noisy advance the stateful
+ * generators. */
+template<class V>
+typename V::vf
+loadNoise(const StatefulNoise& noise, unsigned nl, typename V::mask noisy)
+{
+	return nemo::cpu::simd::nrand<V>(noise.rng + nl, noisy);
+}
+
+
+template<class V>
+typename V::vf
+loadNoise(const CounterNoise& noise, unsigned nl, typename V::mask /* noisy */)
+{
+	return nemo::cpu::simd::philox_nrand<V>(noise.keys + nl, noise.cycle, 0);
+}
+
+
+
+template<class V, class Current, class Noise>
+void
+updateIzhikevichVector(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const Noise& noise,
+		const Current& current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[])
+{
+	typedef typename V::vf vf;
+	typedef typename V::mask mask;
+
+	const IzhikevichData p(cycle, paramBase, paramStride,
+			stateBase, stateHistoryStride, stateVarStride);
+
+	int nn = end-start;
+	assert(nn >= 0);
+
+	/* Full vectors first, then the remaining neurons with the scalar code.
+	 * The parameter and state arrays are aligned (see neuron_model.h), but
+	 * the current arrays are indexed by global neuron index and need not
+	 * be. */
+	int nv = nn / V::WIDTH;
+
+#pragma omp parallel for default(shared)
+	for(int iv=0; iv < nv; iv++) {
+
+		unsigned nl = iv * V::WIDTH;
+		unsigned ng = start + nl;
+
+		const vf zero = V::set1(0.0f);
+		const vf mult = V::set1(SUBSTEP_MULT);
+
+		vf I = V::add(loadCurrent<V>(current, ng), V::load(currentExternal + ng));
+		V::store(currentExternal + ng, zero);
+
+		vf sigma = V::loada(p.sigma + nl);
+		mask noisy = V::cmpneq(sigma, zero);
+		if(V::bits(noisy)) {
+			vf n = V::mul(sigma, loadNoise<V>(noise, nl, noisy));
+			I = V::select(noisy, V::add(I, n), I);
+		}
+
+		vf u = V::loada(p.u0 + nl);
+		vf v = V::loada(p.v0 + nl);
+		const vf a = V::loada(p.a + nl);
+		const vf b = V::loada(p.b + nl);
+
+		/* Neurons stop updating within the cycle once they have fired */
+		const mask all = V::fromBits((1U << V::WIDTH) - 1);
+		mask firing = V::none();
+		for(unsigned t=0; t<SUBSTEPS; ++t) {
+			mask active = V::mandnot(firing, all);
+			vf dv = V::add(V::mul(V::add(V::mul(V::set1(0.04f), v), V::set1(5.0f)), v), V::set1(140.0f));
+			dv = V::add(V::sub(dv, u), I);
+			vf vn = V::add(v, V::mul(mult, dv));
+			vf un = V::add(u, V::mul(mult, V::mul(a, V::sub(V::mul(b, vn), u))));
+			v = V::select(active, vn, v);
+			u = V::select(active, un, u);
+			firing = V::mor(firing, V::mand(active, V::cmpge(v, V::set1(30.0f))));
+		}
+
+		unsigned bits = V::bits(firing);
+		for(unsigned lane=0; lane < V::WIDTH; ++lane) {
+			unsigned n = ng + lane;
+			fired[n] = ((bits >> lane) & 0x1) | fstim[n];
+			fstim[n] = 0;
+			recentFiring[n] = (recentFiring[n] << 1) | (uint64_t) fired[n];
+			bits |= fired[n] << lane;
+		}
+
+		firing = V::fromBits(bits);
+		v = V::select(firing, V::loada(p.c + nl), v);
+		u = V::select(firing, V::add(u, V::loada(p.d + nl)), u);
+
+		V::storea(p.u1 + nl, u);
+		V::storea(p.v1 + nl, v);
+	}
+
+	for(int nl = nv * V::WIDTH; nl < nn; nl++) {
+		updateIzhikevich(p, nl, start + nl, fstim, noise,
+				current, currentExternal, recentFiring, fired);
+	}
+}
+
+#endif
@@ -59,18 +59,14 @@ loadIncoming(const nemo::runtime::RCM& rcm,
 	sourcePhase.resize(indegree);
 
 	if(indegree) {
-		unsigned si = 0U;
-		const std::vector<size_t>& warps = rcm.warps(target);
-		for(std::vector<size_t>::const_iterator wi = warps.begin();
-				wi != warps.end(); ++wi) {
-
-			const nemo::RSynapse* rsynapse_p = rcm.data(*wi);
-			const float* weight_p = rcm.weight(*wi);
-
-			for(unsigned ri=0; ri < rcm.WIDTH && si < indegree; ri++, si++) {
-				weight[si] = weight_p[ri];
-				sourcePhase[si] = phase(phaseBase, phaseStride, cycle-int(rsynapse_p[ri].delay-1))[rsynapse_p[ri].source];
-			}
+		/* The warps for a single target are contiguous */
+		size_t warp = rcm.warp_begin(target);
+		const nemo::RSynapse* rsynapse_p = rcm.data(warp);
+		const float* weight_p = rcm.weight(warp);
+
+		for(unsigned si=0; si < indegree; si++) {
+			weight[si] = weight_p[si];
+			sourcePhase[si] = phase(phaseBase, phaseStride, cycle-int(rsynapse_p[si].delay-1))[rsynapse_p[si].source];
 		}
 	}
 	return indegree;
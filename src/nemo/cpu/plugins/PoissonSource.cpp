@@ -30,6 +30,39 @@ cpu_update_neurons(
 }
 
 
+/* As above, but drawing the random numbers from the counter-based RNG. Any
+ * synaptic input is discarded. */
+extern "C"
+NEMO_PLUGIN_DLL_PUBLIC
+void
+cpu_update_neurons_philox(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t /* paramStride */,
+		float* /* stateBase */, size_t /* stateHistoryStride */, size_t /* stateVarStride */,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float /*currentExternal*/[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* /* rcm */)
+{
+	const float* rate = paramBase;
+
+	for(unsigned ng=start, nl=0U; ng < end; ng++, nl++) {
+		cpu_fx_consume(current, current->excitatory, ng);
+		cpu_fx_consume(current, current->inhibitory, ng);
+		unsigned p0 = unsigned(rate[nl] * float(1<<16));
+		unsigned p1 = philox_urand(&keys[nl], cycle, 0) & 0xffff;
+		fired[ng] = p1 < p0 || fstim[ng];
+		fstim[ng] = 0;
+		recentFiring[ng] = (recentFiring[ng] << 1) | (uint64_t) fired[ng];
+	}
+}
+
+
 cpu_update_neurons_t* test = &cpu_update_neurons;
+cpu_update_neurons_philox_t* test_philox = &cpu_update_neurons_philox;
 
 #include "default_init.c"
@@ -11,6 +11,40 @@
 extern "C" {
 #endif
 
+
+/*! \name Layout of parameter and state arrays
+ *
+ * The parameter and state arrays passed to the plugin functions are stored
+ * in a structure-of-arrays format. Parameter \a p for the neuron with local
+ * index \a n (i.e. \a n - \a start) is found at
+ *
+ * 	paramBase[p * paramStride + n]
+ *
+ * and state variable \a v in history slot \a h is found at
+ *
+ * 	stateBase[h * stateHistoryStride + v * stateVarStride + n]
+ *
+ * The base pointers are aligned to NEMO_CPU_NEURON_ALIGNMENT bytes, and all
+ * strides are multiples of NEMO_CPU_NEURON_PADDING floats, so each array
+ * starts on an aligned boundary. Plugins may therefore use aligned vector
+ * loads and stores of up to NEMO_CPU_NEURON_PADDING floats at local indices
+ * which are multiples of the vector width. Each array is padded with zeros to
+ * the stride. The padding may be read and written, but is otherwise unused.
+ *
+ * No such guarantee is made for the other arrays. The arrays indexed by
+ * global neuron index (currents and firing) may start at any offset, and the
+ * RNG array is not padded.
+ * @{ */
+
+/*! Alignment of parameter and state arrays, in bytes */
+#define NEMO_CPU_NEURON_ALIGNMENT 64
+
+/*! Parameter and state strides are multiples of this many floats */
+#define NEMO_CPU_NEURON_PADDING 16
+
+/*! @} */
+
+
 /*! Update a number of neurons in a contigous range
  *
  * \param currentEPSP input current due to EPSPs
@@ -38,6 +72,109 @@ typedef void cpu_update_neurons_t(
 		void* rcm_ptr);
 
 
+/*! Accumulated synaptic input current in fixed-point format
+ *
+ * The current for each neuron may be split over several buffers (e.g. one
+ * per thread used for spike delivery), which need to be summed. Buffer \a b
+ * for neuron with global index \a n is found at
+ *
+ * 	excitatory[b * stride + n]
+ *
+ * and likewise for \a inhibitory. Use cpu_fx_consume to read the current.
+ */
+typedef struct {
+	wfix_t* excitatory;
+	wfix_t* inhibitory;
+	size_t stride;
+	unsigned buffers;
+	unsigned fbits;
+} cpu_fx_current_t;
+
+
+
+/*! \return the total current in a set of fixed-point accumulators for a
+ * single neuron (see cpu_fx_current_t), converted to floating point. The
+ * accumulators are cleared.
+ *
+ * \param acc either the excitatory or the inhibitory accumulators
+ * \param n global neuron index
+ */
+static inline
+float
+cpu_fx_consume(const cpu_fx_current_t* current, wfix_t* acc, unsigned n)
+{
+	wfix_t sum = 0;
+	unsigned b;
+	for(b = 0; b < current->buffers; ++b) {
+		sum += acc[b * current->stride + n];
+		acc[b * current->stride + n] = 0;
+	}
+#ifdef NEMO_WEIGHT_FIXED_POINT_SATURATION
+	/* Same conversion as wfx_toFloat */
+	if(sum > (wfix_t) 0x7fffffff) {
+		sum = (wfix_t) 0x7fffffff;
+	}
+	if(sum < -(wfix_t) 0x7fffffff - 1) {
+		sum = -(wfix_t) 0x7fffffff - 1;
+	}
+#endif
+	return (float) sum / (float) (1 << current->fbits);
+}
+
+
+
+/*! Update a number of neurons in a contigous range, reading the synaptic
+ * input current directly from the fixed-point accumulators
+ *
+ * This is an optional alternative to cpu_update_neurons_t, which avoids a
+ * separate pass over all neurons to convert the current. Plugins which
+ * provide it should export it as 'cpu_update_neurons_fx'. Apart from the
+ * input current the semantics are as for cpu_update_neurons_t.
+ *
+ * \post the accumulators in \a current for neurons in the range are all 0
+ */
+typedef void cpu_update_neurons_fx_t(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		RNG rng[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* rcm_ptr);
+
+
+
+/*! Update a number of neurons in a contigous range, using the counter-based
+ * RNG for any random numbers
+ *
+ * This is used instead of the other update functions when the simulation is
+ * configured with NEMO_CPU_RNG_PHILOX. Plugins for neuron types which use
+ * random numbers should export it as 'cpu_update_neurons_philox' in order to
+ * support this configuration. Instead of mutable per-neuron RNG state, each
+ * neuron has a fixed key (indexed by local neuron index). The random numbers
+ * for a neuron during a cycle should be a function of only the key and the
+ * cycle (see philox_nrand). Apart from this the semantics are as for
+ * cpu_update_neurons_fx_t.
+ */
+typedef void cpu_update_neurons_philox_t(
+		unsigned start, unsigned end,
+		unsigned cycle,
+		float* paramBase, size_t paramStride,
+		float* stateBase, size_t stateHistoryStride, size_t stateVarStride,
+		unsigned fstim[],
+		const PhiloxKey keys[],
+		const cpu_fx_current_t* current,
+		float currentExternal[],
+		uint64_t recentFiring[],
+		unsigned fired[],
+		void* rcm_ptr);
+
+
+
 /*! Initialise all neurons in the network 
  *
  * For neuron types which requires some state history this may be required,
@@ -53,6 +190,55 @@ typedef void cpu_init_neurons_t(
 
 #ifdef __cplusplus
 }
+
+
+/* Synaptic input current in C++ kernels, either in floating point (already
+ * converted by the caller) or in fixed-point (converted as it is read). Both
+ * are indexed by global neuron index. Kernels templated over the current
+ * source can thus implement both cpu_update_neurons_t and
+ * cpu_update_neurons_fx_t. */
+struct FloatCurrent
+{
+	FloatCurrent(float* e, float* i) : e(e), i(i) { }
+	float excitatory(unsigned n) const { return e[n]; }
+	float inhibitory(unsigned n) const { return i[n]; }
+	float* e;
+	float* i;
+};
+
+
+struct FixedCurrent
+{
+	FixedCurrent(const cpu_fx_current_t* c) : c(c) { }
+	float excitatory(unsigned n) const { return cpu_fx_consume(c, c->excitatory, n); }
+	float inhibitory(unsigned n) const { return cpu_fx_consume(c, c->inhibitory, n); }
+	const cpu_fx_current_t* c;
+};
+
+
+
+/* Per-neuron random numbers in C++ kernels, either from the stateful
+ * per-neuron generators or from the counter-based generator. Both are
+ * indexed by local neuron index. Kernels templated over the noise source can
+ * thus implement both cpu_update_neurons_fx_t and cpu_update_neurons_philox_t. */
+struct StatefulNoise
+{
+	StatefulNoise(RNG* rng) : rng(rng) { }
+	unsigned uniform(unsigned nl) const { return urand(rng + nl); }
+	float normal(unsigned nl) const { return nrand(rng + nl); }
+	RNG* rng;
+};
+
+
+struct CounterNoise
+{
+	CounterNoise(const PhiloxKey* keys, unsigned cycle) : keys(keys), cycle(cycle) { }
+	unsigned uniform(unsigned nl) const { return philox_urand(keys + nl, cycle, 0); }
+	float normal(unsigned nl) const { return philox_nrand(keys + nl, cycle, 0); }
+	const PhiloxKey* keys;
+	unsigned cycle;
+};
+
 #endif
 
 #endif
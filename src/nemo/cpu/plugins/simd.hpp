@@ -0,0 +1,419 @@
+#ifndef NEMO_CPU_PLUGIN_SIMD_HPP
+#define NEMO_CPU_PLUGIN_SIMD_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Thin wrappers around x86 vector intrinsics, for use in vectorised neuron
+ * update kernels. The kernels are written as templates over one of the
+ * wrapper classes below. Each wrapper is only available if the translation
+ * unit is compiled with the relevant instruction set enabled, so the caller
+ * must check for CPU support at run-time before calling into such a kernel.
+ *
+ * The wrappers provide float vectors (vf), 32-bit integer vectors (vi) and
+ * lane masks (mask).
+ */
+
+#include <immintrin.h>
+
+#include <nemo/RNG.hpp>
+
+namespace nemo {
+	namespace cpu {
+		namespace simd {
+
+
+#ifdef __AVX2__
+
+struct Avx2
+{
+	enum { WIDTH = 8 };
+
+	typedef __m256 vf;
+	typedef __m256i vi;
+	typedef __m256 mask;
+
+	static vf load(const float* p) { return _mm256_loadu_ps(p); }
+	static void store(float* p, vf x) { _mm256_storeu_ps(p, x); }
+	static vf loada(const float* p) { return _mm256_load_ps(p); }
+	static void storea(float* p, vf x) { _mm256_store_ps(p, x); }
+	static vf set1(float x) { return _mm256_set1_ps(x); }
+
+	static vf add(vf a, vf b) { return _mm256_add_ps(a, b); }
+	static vf sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+	static vf mul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+	static vf sqrt(vf a) { return _mm256_sqrt_ps(a); }
+	static vf max(vf a, vf b) { return _mm256_max_ps(a, b); }
+
+	static vf and_(vf a, vf b) { return _mm256_and_ps(a, b); }
+	static vf or_(vf a, vf b) { return _mm256_or_ps(a, b); }
+	static vf xor_(vf a, vf b) { return _mm256_xor_ps(a, b); }
+
+	static mask cmpge(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static mask cmplt(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static mask cmpneq(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+	static mask cmpeq(vi a, vi b) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)); }
+
+	/*! \return a where m is set, b elsewhere */
+	static vf select(mask m, vf a, vf b) { return _mm256_blendv_ps(b, a, m); }
+
+	static mask mand(mask a, mask b) { return _mm256_and_ps(a, b); }
+	static mask mor(mask a, mask b) { return _mm256_or_ps(a, b); }
+	static mask mandnot(mask a, mask b) { return _mm256_andnot_ps(a, b); }
+	static mask none() { return _mm256_setzero_ps(); }
+	static unsigned bits(mask m) { return unsigned(_mm256_movemask_ps(m)); }
+
+	static mask fromBits(unsigned b) {
+		const vi lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		vi set = _mm256_and_si256(_mm256_set1_epi32(b), lanes);
+		return _mm256_castsi256_ps(_mm256_cmpeq_epi32(set, lanes));
+	}
+
+	static vi loadi(const unsigned* p) { return _mm256_loadu_si256((const __m256i*) p); }
+	static void storei(unsigned* p, vi x) { _mm256_storeu_si256((__m256i*) p, x); }
+	static vi set1i(int x) { return _mm256_set1_epi32(x); }
+	static vi addi(vi a, vi b) { return _mm256_add_epi32(a, b); }
+	static vi subi(vi a, vi b) { return _mm256_sub_epi32(a, b); }
+	static vi andi(vi a, vi b) { return _mm256_and_si256(a, b); }
+	static vi andnoti(vi a, vi b) { return _mm256_andnot_si256(a, b); }
+	static vi xori(vi a, vi b) { return _mm256_xor_si256(a, b); }
+	template<int n> static vi slli(vi a) { return _mm256_slli_epi32(a, n); }
+	template<int n> static vi srli(vi a) { return _mm256_srli_epi32(a, n); }
+
+	/*! Full 32x32 -> 64-bit unsigned multiplication in each lane, split
+	 * into the high and low words. _mm256_mul_epu32 only multiplies the
+	 * even lanes, so the odd lanes are shifted down and done separately. */
+	static void mulhilo(vi a, vi b, vi& hi, vi& lo) {
+		vi even = _mm256_mul_epu32(a, b);
+		vi odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+		lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+		hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xaa);
+	}
+
+	static vi castfi(vf a) { return _mm256_castps_si256(a); }
+	static vf castif(vi a) { return _mm256_castsi256_ps(a); }
+	static vf cvtif(vi a) { return _mm256_cvtepi32_ps(a); }
+	static vi cvttfi(vf a) { return _mm256_cvttps_epi32(a); }
+
+	/* There is no unsigned conversion in AVX2. Both halves are converted
+	 * exactly, so the final addition is the only rounding step, just as in a
+	 * direct conversion. */
+	static vf cvtuf(vi a) {
+		vf hi = cvtif(srli<16>(a));
+		vf lo = cvtif(andi(a, set1i(0xffff)));
+		return add(mul(hi, set1(65536.0f)), lo);
+	}
+};
+
+#endif
+
+
+
+#ifdef __AVX512F__
+
+struct Avx512
+{
+	enum { WIDTH = 16 };
+
+	typedef __m512 vf;
+	typedef __m512i vi;
+	typedef __mmask16 mask;
+
+	static vf load(const float* p) { return _mm512_loadu_ps(p); }
+	static void store(float* p, vf x) { _mm512_storeu_ps(p, x); }
+	static vf loada(const float* p) { return _mm512_load_ps(p); }
+	static void storea(float* p, vf x) { _mm512_store_ps(p, x); }
+	static vf set1(float x) { return _mm512_set1_ps(x); }
+
+	static vf add(vf a, vf b) { return _mm512_add_ps(a, b); }
+	static vf sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+	static vf mul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+	static vf sqrt(vf a) { return _mm512_sqrt_ps(a); }
+	static vf max(vf a, vf b) { return _mm512_max_ps(a, b); }
+
+	/* AVX-512F lacks bitwise float operations, so go via integers */
+	static vf and_(vf a, vf b) { return castif(_mm512_and_si512(castfi(a), castfi(b))); }
+	static vf or_(vf a, vf b) { return castif(_mm512_or_si512(castfi(a), castfi(b))); }
+	static vf xor_(vf a, vf b) { return castif(_mm512_xor_si512(castfi(a), castfi(b))); }
+
+	static mask cmpge(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+	static mask cmplt(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	static mask cmpneq(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_UQ); }
+	static mask cmpeq(vi a, vi b) { return _mm512_cmpeq_epi32_mask(a, b); }
+
+	/*! \return a where m is set, b elsewhere */
+	static vf select(mask m, vf a, vf b) { return _mm512_mask_blend_ps(m, b, a); }
+
+	static mask mand(mask a, mask b) { return a & b; }
+	static mask mor(mask a, mask b) { return a | b; }
+	static mask mandnot(mask a, mask b) { return ~a & b; }
+	static mask none() { return 0; }
+	static unsigned bits(mask m) { return unsigned(m); }
+	static mask fromBits(unsigned b) { return mask(b); }
+
+	static vi loadi(const unsigned* p) { return _mm512_loadu_si512((const void*) p); }
+	static void storei(unsigned* p, vi x) { _mm512_storeu_si512((void*) p, x); }
+	static vi set1i(int x) { return _mm512_set1_epi32(x); }
+	static vi addi(vi a, vi b) { return _mm512_add_epi32(a, b); }
+	static vi subi(vi a, vi b) { return _mm512_sub_epi32(a, b); }
+	static vi andi(vi a, vi b) { return _mm512_and_si512(a, b); }
+	static vi andnoti(vi a, vi b) { return _mm512_andnot_si512(a, b); }
+	static vi xori(vi a, vi b) { return _mm512_xor_si512(a, b); }
+	template<int n> static vi slli(vi a) { return _mm512_slli_epi32(a, n); }
+	template<int n> static vi srli(vi a) { return _mm512_srli_epi32(a, n); }
+
+	/*! Full 32x32 -> 64-bit unsigned multiplication in each lane, split
+	 * into the high and low words. See Avx2::mulhilo */
+	static void mulhilo(vi a, vi b, vi& hi, vi& lo) {
+		vi even = _mm512_mul_epu32(a, b);
+		vi odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+		lo = _mm512_mask_blend_epi32(0xaaaa, even, _mm512_slli_epi64(odd, 32));
+		hi = _mm512_mask_blend_epi32(0xaaaa, _mm512_srli_epi64(even, 32), odd);
+	}
+
+	static vi castfi(vf a) { return _mm512_castps_si512(a); }
+	static vf castif(vi a) { return _mm512_castsi512_ps(a); }
+	static vf cvtif(vi a) { return _mm512_cvtepi32_ps(a); }
+	static vi cvttfi(vf a) { return _mm512_cvttps_epi32(a); }
+	static vf cvtuf(vi a) { return _mm512_cvtepu32_ps(a); }
+};
+
+#endif
+
+
+
+/*! Natural logarithm for positive arguments
+ *
+ * Cephes-style polynomial approximation, accurate to a few ulp in float. */
+template<class V>
+inline
+typename V::vf
+log(typename V::vf x)
+{
+	typedef typename V::vf vf;
+	typedef typename V::vi vi;
+
+	/* ignore denormals */
+	x = V::max(x, V::castif(V::set1i(0x00800000)));
+
+	vi ix = V::castfi(x);
+	vi exponent = V::subi(V::template srli<23>(ix), V::set1i(0x7f));
+
+	/* mantissa in [0.5, 1) */
+	x = V::castif(V::andnoti(V::set1i(0x7f800000), ix));
+	x = V::or_(x, V::set1(0.5f));
+
+	vf e = V::add(V::cvtif(exponent), V::set1(1.0f));
+
+	/* Shift mantissa to [sqrt(0.5), sqrt(2)) */
+	typename V::mask small = V::cmplt(x, V::set1(0.707106781186547524f));
+	vf tmp = V::select(small, x, V::set1(0.0f));
+	x = V::sub(x, V::set1(1.0f));
+	e = V::sub(e, V::select(small, V::set1(1.0f), V::set1(0.0f)));
+	x = V::add(x, tmp);
+
+	vf z = V::mul(x, x);
+
+	vf y = V::set1(7.0376836292E-2f);
+	y = V::add(V::mul(y, x), V::set1(-1.1514610310E-1f));
+	y = V::add(V::mul(y, x), V::set1(1.1676998740E-1f));
+	y = V::add(V::mul(y, x), V::set1(-1.2420140846E-1f));
+	y = V::add(V::mul(y, x), V::set1(1.4249322787E-1f));
+	y = V::add(V::mul(y, x), V::set1(-1.6668057665E-1f));
+	y = V::add(V::mul(y, x), V::set1(2.0000714765E-1f));
+	y = V::add(V::mul(y, x), V::set1(-2.4999993993E-1f));
+	y = V::add(V::mul(y, x), V::set1(3.3333331174E-1f));
+	y = V::mul(V::mul(y, x), z);
+
+	y = V::add(y, V::mul(e, V::set1(-2.12194440e-4f)));
+	y = V::sub(y, V::mul(z, V::set1(0.5f)));
+	x = V::add(x, y);
+	x = V::add(x, V::mul(e, V::set1(0.693359375f)));
+	return x;
+}
+
+
+
+/*! Sine
+ *
+ * Cephes-style polynomial approximation. Accurate to a few ulp in float for
+ * arguments of moderate magnitude, such as the [0, 2pi) range used here */
+template<class V>
+inline
+typename V::vf
+sin(typename V::vf x)
+{
+	typedef typename V::vf vf;
+	typedef typename V::vi vi;
+
+	const vf signMask = V::castif(V::set1i(0x80000000));
+
+	vf sign = V::and_(x, signMask);
+	x = V::xor_(x, sign); // abs
+
+	/* octant */
+	vi j = V::cvttfi(V::mul(x, V::set1(1.27323954473516f))); // 4/pi
+	j = V::andi(V::addi(j, V::set1i(1)), V::set1i(~1));
+	vf y = V::cvtif(j);
+
+	/* swap sign in octants 4-7 */
+	sign = V::xor_(sign, V::castif(V::template slli<29>(V::andi(j, V::set1i(4)))));
+
+	/* use the sine polynomial in octants 0, 3, 4, 7 */
+	typename V::mask usePolySin = V::cmpeq(V::andi(j, V::set1i(2)), V::set1i(0));
+
+	/* extended precision modular arithmetic */
+	x = V::sub(x, V::mul(y, V::set1(0.78515625f)));
+	x = V::sub(x, V::mul(y, V::set1(2.4187564849853515625e-4f)));
+	x = V::sub(x, V::mul(y, V::set1(3.77489497744594108e-8f)));
+
+	vf z = V::mul(x, x);
+
+	vf yc = V::set1(2.443315711809948E-005f);
+	yc = V::add(V::mul(yc, z), V::set1(-1.388731625493765E-003f));
+	yc = V::add(V::mul(yc, z), V::set1(4.166664568298827E-002f));
+	yc = V::mul(V::mul(yc, z), z);
+	yc = V::sub(yc, V::mul(z, V::set1(0.5f)));
+	yc = V::add(yc, V::set1(1.0f));
+
+	vf ys = V::set1(-1.9515295891E-4f);
+	ys = V::add(V::mul(ys, z), V::set1(8.3321608736E-3f));
+	ys = V::add(V::mul(ys, z), V::set1(-1.6666654611E-1f));
+	ys = V::mul(V::mul(ys, z), x);
+	ys = V::add(ys, x);
+
+	y = V::select(usePolySin, ys, yc);
+	return V::xor_(y, sign);
+}
+
+
+
+/*! Box-Muller transform of two vectors of uniform random words, as in the
+ * scalar nrand */
+template<class V>
+inline
+typename V::vf
+boxMuller(typename V::vi r0, typename V::vi r1)
+{
+	typedef typename V::vf vf;
+	vf a = V::mul(V::cvtuf(r0), V::set1(1.4629180792671596810513378043098e-9f));
+	vf b = V::mul(V::cvtuf(r1), V::set1(0.00000000023283064365386962890625f));
+	vf rad = V::sqrt(V::mul(V::set1(-2.0f), log<V>(V::sub(V::set1(1.0f), b))));
+	return V::mul(sin<V>(a), rad);
+}
+
+
+
+/*! Draw one normally distributed sample per lane, using the same per-neuron
+ * RNG streams and the same Box-Muller transform as the scalar nrand.
+ *
+ * \param rng RNG state for V::WIDTH consecutive neurons
+ * \param commit lanes for which the RNG state should be advanced. Other lanes
+ * 		leave the RNG state untouched, as if no sample had been drawn.
+ */
+template<class V>
+inline
+typename V::vf
+nrand(RNG rng[], typename V::mask commit)
+{
+	typedef typename V::vi vi;
+
+	/* transpose from array-of-structures */
+	unsigned s[4][V::WIDTH];
+	for(unsigned lane=0; lane < V::WIDTH; ++lane) {
+		for(unsigned plane=0; plane < 4; ++plane) {
+			s[plane][lane] = rng[lane].state[plane];
+		}
+	}
+
+	vi x0 = V::loadi(s[0]);
+	vi x1 = V::loadi(s[1]);
+	vi x2 = V::loadi(s[2]);
+	vi x3 = V::loadi(s[3]);
+
+	vi r[2];
+	for(unsigned i=0; i < 2; ++i) {
+		/* xorshift, as urand */
+		vi t = V::xori(x0, V::template slli<11>(x0));
+		x0 = x1;
+		x1 = x2;
+		x2 = x3;
+		x3 = V::xori(V::xori(x3, V::template srli<19>(x3)), V::xori(t, V::template srli<8>(t)));
+		r[i] = x3;
+	}
+
+	V::storei(s[0], x0);
+	V::storei(s[1], x1);
+	V::storei(s[2], x2);
+	V::storei(s[3], x3);
+	unsigned bits = V::bits(commit);
+	for(unsigned lane=0; lane < V::WIDTH; ++lane) {
+		if(bits & (1U << lane)) {
+			for(unsigned plane=0; plane < 4; ++plane) {
+				rng[lane].state[plane] = s[plane][lane];
+			}
+		}
+	}
+
+	return boxMuller<V>(r[0], r[1]);
+}
+
+
+
+/*! Draw one normally distributed sample per lane from the counter-based
+ * generator, with the same random words as the scalar philox_nrand.
+ *
+ * \param keys keys for V::WIDTH consecutive neurons
+ */
+template<class V>
+inline
+typename V::vf
+philox_nrand(const PhiloxKey keys[], unsigned cycle, unsigned stream)
+{
+	typedef typename V::vi vi;
+
+	unsigned k[2][V::WIDTH];
+	for(unsigned lane=0; lane < V::WIDTH; ++lane) {
+		k[0][lane] = keys[lane].key[0];
+		k[1][lane] = keys[lane].key[1];
+	}
+	vi k0 = V::loadi(k[0]);
+	vi k1 = V::loadi(k[1]);
+
+	vi c0 = V::set1i(int(cycle));
+	vi c1 = V::set1i(int(stream));
+	vi c2 = V::set1i(0);
+	vi c3 = V::set1i(0);
+
+	const vi m0 = V::set1i(int(PHILOX_M0));
+	const vi m1 = V::set1i(int(PHILOX_M1));
+	const vi w0 = V::set1i(int(PHILOX_W0));
+	const vi w1 = V::set1i(int(PHILOX_W1));
+
+	for(unsigned r=0; r < PHILOX_ROUNDS; ++r) {
+		vi hi0, lo0, hi1, lo1;
+		V::mulhilo(m0, c0, hi0, lo0);
+		V::mulhilo(m1, c2, hi1, lo1);
+		c0 = V::xori(V::xori(hi1, c1), k0);
+		c1 = lo1;
+		c2 = V::xori(V::xori(hi0, c3), k1);
+		c3 = lo0;
+		k0 = V::addi(k0, w0);
+		k1 = V::addi(k1, w1);
+	}
+
+	return boxMuller<V>(c0, c1);
+}
+
+
+		} // end namespace simd
+	} // end namespace cpu
+} // end namespace nemo
+
+#endif
@@ -29,6 +29,8 @@ struct DeviceIdx
 		pidx_t partition;
 		nidx_t neuron;
 
+		DeviceIdx() : partition(0), neuron(0) {}
+
 		DeviceIdx(pidx_t p, nidx_t n) : partition(p), neuron(n) {}
 };
 
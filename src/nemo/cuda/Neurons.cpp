@@ -28,7 +28,8 @@ namespace nemo {
 
 Neurons::Neurons(const network::Generator& net,
 		unsigned type_id,
-		const Mapper& mapper) :
+		const Mapper& mapper,
+		unsigned rngSeed) :
 	m_type(net.neuronType(type_id)),
 	m_param(m_type.parameterCount(), mapper.partitionCount(type_id), mapper.partitionSize(), true, false),
 	m_state(m_type.stateVarCount() * m_type.stateHistory(),
@@ -51,9 +52,8 @@ Neurons::Neurons(const network::Generator& net,
 	std::map<pidx_t, nidx_t> maxPartitionNeuron;
 
 	/* Create all the RNG seeds */
-	//! \todo seed this from configuration
 	std::vector<RNG> rngs(mapper.maxHandledGlobalIdx() - mapper.minHandledGlobalIdx() + 1);
-	initialiseRng(mapper.minHandledGlobalIdx(), mapper.maxHandledGlobalIdx(), rngs);
+	initialiseRng(mapper.minHandledGlobalIdx(), mapper.maxHandledGlobalIdx(), rngSeed, rngs);
 
 	for(network::neuron_iterator i = net.neuron_begin(type_id), i_end = net.neuron_end(type_id);
 			i != i_end; ++i) {
@@ -51,7 +51,7 @@ class Neurons : boost::noncopyable
 {
 	public:
 
-		Neurons(const nemo::network::Generator&, unsigned type_id, const Mapper&);
+		Neurons(const nemo::network::Generator&, unsigned type_id, const Mapper&, unsigned rngSeed);
 
 		/*! Initialise the state of all neurons */
 		cudaError_t initHistory(
@@ -9,6 +9,7 @@
 
 #include "Simulation.hpp"
 
+#include <algorithm>
 #include <vector>
 
 #include <boost/format.hpp>
@@ -42,6 +43,7 @@ mapCompact(const nemo::network::Generator& net, unsigned partitionSize)
 	using namespace nemo::network;
 
 	Mapper mapper(partitionSize);
+	mapper.reserve(net);
 
 	pidx_t pidx = 0;
 
@@ -133,7 +135,7 @@ Simulation::Simulation(
 
 		//! \todo could do mapping here to avoid two passes over neurons
 		/* Wrap in smart pointer to ensure the class is not copied */
-		boost::shared_ptr<Neurons> ns(new Neurons(net, type_id, m_mapper));
+		boost::shared_ptr<Neurons> ns(new Neurons(net, type_id, m_mapper, conf.rngSeed()));
 		checkPitch(ns->wordPitch32(), pitch32);
 		checkPitch(ns->wordPitch1(), pitch1);
 		//! \todo verify contigous range
@@ -141,6 +143,20 @@ Simulation::Simulation(
 		m_neurons.push_back(ns);
 	}
 	h_partitionSize.resize(MAX_PARTITION_COUNT, 0); // extend
+
+	std::vector<nidx_t> globalIdx;
+	globalIdx.reserve(net.neuronCount());
+	for(unsigned type_id=0, id_end=net.neuronTypeCount(); type_id < id_end; ++type_id) {
+		for(network::neuron_iterator i = net.neuron_begin(type_id), i_end = net.neuron_end(type_id);
+				i != i_end; ++i) {
+			globalIdx.push_back(i->first);
+		}
+	}
+	std::sort(globalIdx.begin(), globalIdx.end());
+	m_denseDeviceIdx.reserve(globalIdx.size());
+	for(std::vector<nidx_t>::const_iterator i = globalIdx.begin(); i != globalIdx.end(); ++i) {
+		m_denseDeviceIdx.push_back(m_mapper.deviceIdx(*i));
+	}
 	memcpyToDevice(md_partitionSize.get(), h_partitionSize);
 
 	if(m_stdp) {
@@ -252,11 +268,21 @@ Simulation::finalizeCurrentStimulus(size_t count)
 void
 Simulation::setCurrentStimulus(const std::vector<float>& current)
 {
+	using boost::format;
+
 	if(current.empty()) {
 		md_istim = NULL;
 		return;
 	}
-	m_currentStimulus.set(current);
+	if(current.size() != m_denseDeviceIdx.size()) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("current stimulus vector has %u entries, but the network has %u neurons")
+					% current.size() % m_denseDeviceIdx.size()));
+	}
+	for(size_t i=0; i < current.size(); ++i) {
+		const DeviceIdx& dev = m_denseDeviceIdx[i];
+		m_currentStimulus.setNeuron(dev.partition, dev.neuron, current[i]);
+	}
 	m_currentStimulus.copyToDeviceAsync(m_streamCopy);
 	md_istim = m_currentStimulus.deviceData();
 	CUDA_SAFE_CALL(cudaEventRecord(m_currentStimulusDone, m_streamCopy));
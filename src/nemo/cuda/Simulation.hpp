@@ -315,6 +315,10 @@ class Simulation : public nemo::SimulationBackend
 		FiringStimulus m_firingStimulus;
 
 		NVector<float> m_currentStimulus; // user-provided
+
+		/* Device index of each neuron, ordered by global index. This is the
+		 * permutation applied to dense current stimulus. */
+		std::vector<DeviceIdx> m_denseDeviceIdx;
 		NVector<float> m_current;         // driven by simulation
 
 		/* The firing buffer keeps data for a certain duration. One bit is
@@ -26,6 +26,10 @@ simulationBackend(const network::Generator&, const ConfigurationImpl& conf);
 SimulationBackend*
 simulationBackend(const Network& net, const Configuration& conf);
 
+
+SimulationBackend*
+simulationBackend(const std::string& filename, const Configuration& conf);
+
 void
 setDefaultHardware(nemo::ConfigurationImpl& conf);
 
@@ -14,6 +14,7 @@
 #include <nemo/internals.hpp>
 #include <nemo/exception.hpp>
 #include <nemo/network/Generator.hpp>
+#include <nemo/network/mapped/Generator.hpp>
 #include <nemo/NetworkImpl.hpp>
 
 #ifdef NEMO_CUDA_ENABLED
@@ -115,11 +116,12 @@ simulationBackend(const network::Generator& net, const ConfigurationImpl& conf)
 		return NULL;
 	}
 
-	conf.verifyStdp(net.maxDelay());
-
 	switch(conf.backend()) {
 #ifdef NEMO_CUDA_ENABLED
 		case NEMO_BACKEND_CUDA:
+			/* The CUDA backend's firing history is limited to 64 cycles. The
+			 * CPU backend's firing history grows with the maximum delay. */
+			conf.verifyStdp(net.maxDelay());
 			return cudaSimulation(net, conf);
 #else
 		case NEMO_BACKEND_CUDA:
@@ -147,6 +149,30 @@ simulation(const Network& net, const Configuration& conf)
 }
 
 
+Simulation*
+simulation(const network::Generator& net, const Configuration& conf)
+{
+	return dynamic_cast<Simulation*>(simulationBackend(net, *conf.m_impl));
+}
+
+
+/* The mapping is only needed during construction, as the backends copy the
+ * network into their own data structures */
+SimulationBackend*
+simulationBackend(const std::string& filename, const Configuration& conf)
+{
+	network::mapped::Generator net(filename);
+	return simulationBackend(net, *conf.m_impl);
+}
+
+
+Simulation*
+simulation(const std::string& filename, const Configuration& conf)
+{
+	return dynamic_cast<Simulation*>(simulationBackend(filename, conf));
+}
+
+
 
 
 /* Set the default CUDA device if possible. Throws if anything goes wrong or if
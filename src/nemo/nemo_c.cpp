@@ -159,6 +159,26 @@ nemo_new_simulation(nemo_network_t net_ptr, nemo_configuration_t conf_ptr)
 
 
 
+nemo_simulation_t
+nemo_new_simulation_from_file(const char* filename, nemo_configuration_t conf_ptr)
+{
+	try {
+		nemo::Configuration* conf = static_cast<nemo::Configuration*>(conf_ptr);
+		return static_cast<nemo_simulation_t>(nemo::simulationBackend(std::string(filename), *conf));
+	} catch(nemo::exception& e) {
+		setResult(e.what(), e.errorNumber());
+		return NULL;
+	} catch(std::exception& e) {
+		setResult(e.what(), NEMO_UNKNOWN_ERROR);
+		return NULL;
+	} catch(...) {
+		setResult("Unknown error", NEMO_UNKNOWN_ERROR);
+		return NULL;
+	}
+}
+
+
+
 void
 nemo_delete_simulation(nemo_simulation_t sim)
 {
@@ -198,6 +218,17 @@ nemo_add_neuron(nemo_network_t net,
 
 
 
+nemo_status_t
+nemo_add_neurons(nemo_network_t net,
+		unsigned type,
+		unsigned idx[], size_t count,
+		unsigned nargs, float* args[])
+{
+	CATCH_(net, addNeurons(type, count, idx, nargs, args));
+}
+
+
+
 nemo_status_t
 nemo_add_synapse(nemo_network_t net,
 		unsigned source,
@@ -217,6 +248,21 @@ nemo_add_synapse(nemo_network_t net,
 
 
 
+nemo_status_t
+nemo_add_synapses(nemo_network_t net,
+		unsigned sources[],
+		unsigned targets[],
+		unsigned delays[],
+		float weights[],
+		unsigned char is_plastic[],
+		size_t count,
+		synapse_id ids[])
+{
+	CATCH_(net, addSynapses(count, sources, targets, delays, weights, is_plastic, ids));
+}
+
+
+
 nemo_status_t
 nemo_neuron_count(nemo_network_t net, unsigned* ncount)
 {
@@ -225,6 +271,14 @@ nemo_neuron_count(nemo_network_t net, unsigned* ncount)
 
 
 
+nemo_status_t
+nemo_save_network(nemo_network_t net, const char* filename)
+{
+	CATCH_(net, save(filename));
+}
+
+
+
 nemo_status_t
 nemo_get_membrane_potential(nemo_simulation_t sim, unsigned neuron, float* v)
 {
@@ -477,6 +531,88 @@ nemo_step(nemo_simulation_t sim,
 
 
 
+void
+stepDense(nemo::SimulationBackend* sim,
+		const std::vector<unsigned>& fstim,
+		const std::vector<float>& istim,
+		unsigned *fired[], size_t* fired_len)
+{
+	const std::vector<unsigned>& fired_ = sim->step(fstim, istim);
+	if(fired != NULL) {
+		*fired = fired_.empty() ? NULL : const_cast<unsigned*>(&fired_[0]);
+	}
+	if(fired_len != NULL) {
+		*fired_len = fired_.size();
+	}
+}
+
+
+
+nemo_status_t
+nemo_step_dense(nemo_simulation_t sim,
+		unsigned fstim_nidx[], size_t fstim_count,
+		float istim_current[], size_t istim_count,
+		unsigned* fired[], size_t* fired_count)
+{
+	CALL(stepDense(sim,
+			std::vector<unsigned>(fstim_nidx, fstim_nidx + fstim_count),
+			std::vector<float>(istim_current, istim_current + istim_count),
+			fired, fired_count));
+	return g_lastCallStatus;
+}
+
+
+
+template<typename T>
+T*
+vectorPtr(const std::vector<T>& vec)
+{
+	return vec.empty() ? NULL : const_cast<T*>(&vec[0]);
+}
+
+
+void
+run(nemo::SimulationBackend* sim, unsigned nsteps,
+		const nemo::Simulation::stimulus_schedule& schedule,
+		uint64_t* cycles[], unsigned* fired[], size_t* fired_count,
+		uint64_t* offsets[])
+{
+	const nemo::Simulation::firing_record& record = sim->run(nsteps, schedule);
+	if(cycles != NULL) {
+		*cycles = vectorPtr(record.cycles);
+	}
+	if(fired != NULL) {
+		*fired = vectorPtr(record.neurons);
+	}
+	if(fired_count != NULL) {
+		*fired_count = record.neurons.size();
+	}
+	if(offsets != NULL) {
+		*offsets = vectorPtr(record.offsets);
+	}
+}
+
+
+
+nemo_status_t
+nemo_run(nemo_simulation_t sim, unsigned nsteps,
+		unsigned fstim_step[], unsigned fstim_nidx[], size_t fstim_count,
+		unsigned istim_step[], unsigned istim_nidx[], float istim_current[], size_t istim_count,
+		uint64_t* cycles[], unsigned* fired[], size_t* fired_count,
+		uint64_t* offsets[])
+{
+	nemo::Simulation::stimulus_schedule schedule;
+	schedule.firingSteps.assign(fstim_step, fstim_step + fstim_count);
+	schedule.firingNeurons.assign(fstim_nidx, fstim_nidx + fstim_count);
+	schedule.currentSteps.assign(istim_step, istim_step + istim_count);
+	schedule.currentNeurons.assign(istim_nidx, istim_nidx + istim_count);
+	schedule.currents.assign(istim_current, istim_current + istim_count);
+	CALL(run(sim, nsteps, schedule, cycles, fired, fired_count, offsets));
+	return g_lastCallStatus;
+}
+
+
+
 nemo_status_t
 nemo_apply_stdp(nemo_simulation_t sim, float reward)
 {
@@ -549,6 +685,30 @@ nemo_set_cpu_backend(nemo_configuration_t conf)
 
 
 
+nemo_status_t
+nemo_set_cpu_delivery_engine(nemo_configuration_t conf, cpu_delivery_t engine)
+{
+	CATCH_(conf, setCpuDeliveryEngine(engine));
+}
+
+
+
+nemo_status_t
+nemo_set_cpu_rng(nemo_configuration_t conf, cpu_rng_t rng)
+{
+	CATCH_(conf, setCpuRng(rng));
+}
+
+
+
+nemo_status_t
+nemo_set_cpu_compact_synapses(nemo_configuration_t conf, unsigned char enabled)
+{
+	CATCH_(conf, setCpuCompactSynapses(enabled != 0));
+}
+
+
+
 nemo_status_t
 nemo_set_cuda_backend(nemo_configuration_t conf, int dev)
 {
@@ -587,6 +747,14 @@ nemo_set_write_only_synapses(nemo_configuration_t conf)
 }
 
 
+
+nemo_status_t
+nemo_set_rng_seed(nemo_configuration_t conf, unsigned seed)
+{
+	CATCH_(conf, setRngSeed(seed));
+}
+
+
 const char*
 nemo_strerror()
 {
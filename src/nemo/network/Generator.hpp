@@ -1,6 +1,8 @@
 #ifndef NEMO_NETWORK_GENERATOR_HPP
 #define NEMO_NETWORK_GENERATOR_HPP
 
+#include <vector>
+
 #include <nemo/config.h>
 #include <nemo/types.hpp>
 #include <nemo/network/iterator.hpp>
@@ -10,6 +12,77 @@
 namespace nemo {
 	namespace network {
 
+
+/*! Block of synapses stored contiguously as a structure-of-arrays, for bulk
+ * export from a network generator. Source and target are global neuron
+ * indices. The arrays are owned either by the generator or by the \a
+ * SynapseBuffer passed to \a Generator::synapseBlock. */
+struct SynapseBlock
+{
+	SynapseBlock() :
+		size(0), source(NULL), target(NULL), delay(NULL),
+		weight(NULL), plastic(NULL), id(NULL) { }
+
+	size_t size;
+	const nidx_t* source;
+	const nidx_t* target;
+	const delay_t* delay;
+	const float* weight;
+	const unsigned char* plastic;
+	const id32_t* id;
+};
+
+
+
+/*! Caller-owned storage for synapse blocks which are computed on demand
+ * rather than stored in the generator */
+struct SynapseBuffer
+{
+	std::vector<nidx_t> source;
+	std::vector<nidx_t> target;
+	std::vector<delay_t> delay;
+	std::vector<float> weight;
+	std::vector<unsigned char> plastic;
+	std::vector<id32_t> id;
+
+	void add(nidx_t s, nidx_t t, delay_t d, float w, unsigned char p, id32_t i) {
+		source.push_back(s);
+		target.push_back(t);
+		delay.push_back(d);
+		weight.push_back(w);
+		plastic.push_back(p);
+		id.push_back(i);
+	}
+
+	void clear() {
+		source.clear();
+		target.clear();
+		delay.clear();
+		weight.clear();
+		plastic.clear();
+		id.clear();
+	}
+
+	size_t size() const { return source.size(); }
+
+	/*! \return block referring to the buffer's current contents */
+	SynapseBlock block() const {
+		SynapseBlock b;
+		b.size = source.size();
+		if(b.size != 0) {
+			b.source = &source[0];
+			b.target = &target[0];
+			b.delay = &delay[0];
+			b.weight = &weight[0];
+			b.plastic = &plastic[0];
+			b.id = &id[0];
+		}
+		return b;
+	}
+};
+
+
+
 /* A network generator is simply a class which can produce a sequence of
  * neurons and a sequence of synapses. Network generators are expected to
  * provide all neurons first, then all synapses. Furthermore neurons are
@@ -37,6 +110,26 @@ class NEMO_BASE_DLL_PUBLIC Generator
 		virtual synapse_iterator synapse_begin() const = 0;
 		virtual synapse_iterator synapse_end() const = 0;
 
+		/*! \return number of synapse blocks for bulk export of synapses.
+		 * Together the blocks contain the same synapses, in the same order,
+		 * as the range [synapse_begin, synapse_end). Generators which do not
+		 * support bulk export return 0, in which case the synapse iterators
+		 * should be used instead. */
+		virtual size_t synapseBlockCount() const { return 0; }
+
+		/*! \return the ith synapse block
+		 *
+		 * The block refers either to data owned by the generator or to data
+		 * written to \a buffer. Different blocks may be requested
+		 * concurrently, as long as each thread uses its own buffer. The block
+		 * remains valid until the buffer is modified.
+		 *
+		 * \pre 0 <= i < synapseBlockCount
+		 */
+		virtual SynapseBlock synapseBlock(size_t /* i */, SynapseBuffer& /* buffer */) const {
+			return SynapseBlock();
+		}
+
 		/*! \return number of neurons in the network */
 		virtual unsigned neuronCount() const = 0;
 
@@ -0,0 +1,304 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Generator.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/format.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <nemo/exception.hpp>
+#include <nemo/network/synapse_block_iterator.hpp>
+#include "neuron_iterator.hpp"
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+
+const unsigned Generator::SOURCES_PER_BLOCK;
+
+
+Generator::Generator(const std::string& filename) :
+	m_filename(filename),
+	m_header(NULL),
+	m_typeHeader(NULL),
+	m_rowOffset(NULL),
+	m_target(NULL),
+	m_delay(NULL),
+	m_weight(NULL),
+	m_plastic(NULL),
+	m_id(NULL)
+{
+	using boost::format;
+	namespace bip = boost::interprocess;
+
+	try {
+		bip::file_mapping file(filename.c_str(), bip::read_only);
+		bip::mapped_region region(file, bip::read_only);
+		m_file.swap(file);
+		m_region.swap(region);
+	} catch(bip::interprocess_exception& e) {
+		throw nemo::exception(NEMO_IO_ERROR,
+				str(format("Failed to open network file %s: %s") % filename % e.what()));
+	}
+
+	m_header = section<FileHeader>(0, 1, "file header");
+	const FileHeader& h = *m_header;
+
+	if(memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("%s is not a NeMo network file") % filename));
+	}
+	if(h.byteOrder != BYTE_ORDER_MARK) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s was written on a machine with a different byte order") % filename));
+	}
+	if(h.version != VERSION) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s has unsupported version %u (expected %u)")
+					% filename % h.version % VERSION));
+	}
+	if(h.minNeuronIndex > h.maxNeuronIndex
+			|| h.rowCount != uint64_t(h.maxNeuronIndex) - h.minNeuronIndex + 1) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s has an invalid neuron index range") % filename));
+	}
+
+	m_typeHeader = section<TypeHeader>(h.typeOffset, h.neuronTypeCount, "neuron types");
+
+	uint64_t neuronCount = 0;
+	for(unsigned t=0; t < h.neuronTypeCount; ++t) {
+		const TypeHeader& th = m_typeHeader[t];
+		if(memchr(th.name, '\0', TYPE_NAME_LENGTH) == NULL) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Network file %s has an invalid neuron type name") % filename));
+		}
+		m_types.push_back(NeuronType(th.name));
+		const NeuronType& type = m_types.back();
+		if(type.parameterCount() != th.parameterCount || type.stateVarCount() != th.stateCount) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Neuron type %s in network file %s does not match the installed neuron type")
+						% th.name % filename));
+		}
+		m_neuronIndex.push_back(section<uint32_t>(th.indexOffset, th.neuronCount, "neuron indices"));
+		m_neuronParam.push_back(section<float>(th.parameterOffset,
+					th.parameterCount * th.neuronCount, "neuron parameters"));
+		m_neuronState.push_back(section<float>(th.stateOffset,
+					th.stateCount * th.neuronCount, "neuron state"));
+		neuronCount += th.neuronCount;
+	}
+	if(neuronCount != h.neuronCount || neuronCount == 0) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s has an invalid neuron count") % filename));
+	}
+
+	m_rowOffset = section<uint64_t>(h.rowOffsetOffset, h.rowCount + 1, "synapse rows");
+	m_target = section<uint32_t>(h.targetOffset, h.synapseCount, "synapse targets");
+	m_delay = section<uint32_t>(h.delayOffset, h.synapseCount, "synapse delays");
+	m_weight = section<float>(h.weightOffset, h.synapseCount, "synapse weights");
+	m_plastic = section<unsigned char>(h.plasticOffset, h.synapseCount, "synapse plasticity");
+	m_id = section<uint32_t>(h.idOffset, h.synapseCount, "synapse ids");
+
+	validateRows();
+}
+
+
+
+template<typename T>
+const T*
+Generator::section(uint64_t offset, uint64_t count, const char* name) const
+{
+	using boost::format;
+
+	const uint64_t size = m_region.get_size();
+	if(offset % boost::alignment_of<T>::value != 0 || offset > size || count > (size - offset) / sizeof(T)) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s is truncated or corrupt (%s)") % m_filename % name));
+	}
+	return reinterpret_cast<const T*>(static_cast<const char*>(m_region.get_address()) + offset);
+}
+
+
+
+/* The row offsets are checked up front, as a corrupt row structure would
+ * lead to out-of-bounds accesses in any block */
+void
+Generator::validateRows() const
+{
+	using boost::format;
+
+	const uint64_t rowCount = m_header->rowCount;
+	bool valid = m_rowOffset[0] == 0 && m_rowOffset[rowCount] == m_header->synapseCount;
+	for(uint64_t r=0; valid && r < rowCount; ++r) {
+		valid = m_rowOffset[r] <= m_rowOffset[r+1];
+	}
+	if(!valid) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Network file %s has invalid synapse row offsets") % m_filename));
+	}
+}
+
+
+
+size_t
+Generator::synapseBlockCount() const
+{
+	return size_t((m_header->rowCount + SOURCES_PER_BLOCK - 1) / SOURCES_PER_BLOCK);
+}
+
+
+
+/* Only the source indices are written to the buffer, as the file stores them
+ * implicitly in the row structure. The delays and targets are checked here
+ * rather than when opening the file, so that only the blocks which are used
+ * are ever read from disk. */
+SynapseBlock
+Generator::synapseBlock(size_t i, SynapseBuffer& buffer) const
+{
+	using boost::format;
+
+	const uint64_t rowBegin = uint64_t(i) * SOURCES_PER_BLOCK;
+	const uint64_t rowEnd = std::min(m_header->rowCount, rowBegin + SOURCES_PER_BLOCK);
+	const uint64_t first = m_rowOffset[rowBegin];
+	const uint64_t last = m_rowOffset[rowEnd];
+
+	SynapseBlock block;
+	buffer.clear();
+	if(first == last) {
+		return block;
+	}
+
+	const nidx_t minIdx = m_header->minNeuronIndex;
+	const nidx_t maxIdx = m_header->maxNeuronIndex;
+	const delay_t maxDelay = m_header->maxDelay;
+
+	buffer.source.resize(last - first);
+	for(uint64_t r = rowBegin; r < rowEnd; ++r) {
+		std::fill(buffer.source.begin() + (m_rowOffset[r] - first),
+				buffer.source.begin() + (m_rowOffset[r+1] - first),
+				nidx_t(minIdx + r));
+	}
+
+	for(uint64_t s = first; s < last; ++s) {
+		if(m_delay[s] < 1 || m_delay[s] > maxDelay
+				|| m_target[s] < minIdx || m_target[s] > maxIdx) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Network file %s contains an invalid synapse (%u -> %u, delay %u)")
+						% m_filename % buffer.source[s - first] % m_target[s] % m_delay[s]));
+		}
+	}
+
+	block.size = last - first;
+	block.source = &buffer.source[0];
+	block.target = m_target + first;
+	block.delay = m_delay + first;
+	block.weight = m_weight + first;
+	block.plastic = m_plastic + first;
+	block.id = m_id + first;
+	return block;
+}
+
+
+
+synapse_iterator
+Generator::synapse_begin() const
+{
+	return synapse_iterator(new synapse_block_iterator(*this, 0));
+}
+
+
+
+synapse_iterator
+Generator::synapse_end() const
+{
+	return synapse_iterator(
+			new synapse_block_iterator(*this, synapseBlockCount()));
+}
+
+
+
+network::neuron_iterator
+Generator::neuron_begin(unsigned i) const
+{
+	return network::neuron_iterator(new mapped::neuron_iterator(m_types.at(i),
+				m_typeHeader[i].neuronCount, 0,
+				m_neuronIndex[i], m_neuronParam[i], m_neuronState[i]));
+}
+
+
+
+network::neuron_iterator
+Generator::neuron_end(unsigned i) const
+{
+	size_t count = m_typeHeader[i].neuronCount;
+	return network::neuron_iterator(new mapped::neuron_iterator(m_types.at(i),
+				count, count,
+				m_neuronIndex[i], m_neuronParam[i], m_neuronState[i]));
+}
+
+
+
+unsigned
+Generator::neuronCount() const
+{
+	return unsigned(m_header->neuronCount);
+}
+
+
+
+unsigned
+Generator::neuronCount(unsigned type) const
+{
+	return unsigned(m_typeHeader[type].neuronCount);
+}
+
+
+
+unsigned
+Generator::maxDelay() const
+{
+	return m_header->maxDelay;
+}
+
+
+
+unsigned
+Generator::minNeuronIndex() const
+{
+	return m_header->minNeuronIndex;
+}
+
+
+
+unsigned
+Generator::maxNeuronIndex() const
+{
+	return m_header->maxNeuronIndex;
+}
+
+
+
+unsigned
+Generator::neuronTypeCount() const
+{
+	return unsigned(m_types.size());
+}
+
+
+
+const NeuronType&
+Generator::neuronType(unsigned i) const
+{
+	return m_types.at(i);
+}
+
+}	}	}
@@ -0,0 +1,115 @@
+#ifndef NEMO_NETWORK_MAPPED_GENERATOR_HPP
+#define NEMO_NETWORK_MAPPED_GENERATOR_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nemo/config.h>
+#include <nemo/network/Generator.hpp>
+#include "format.hpp"
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+/*! \brief Network generator reading from a memory-mapped network file
+ *
+ * The file (see format.hpp and \a mapped::write) is mapped read-only into
+ * memory, and the neurons and synapses are read directly from the mapping.
+ * A backend can thus be constructed from a network file without first
+ * loading the network into a \a nemo::Network, and the operating system only
+ * reads those parts of the file which are actually accessed.
+ *
+ * The synapses are exported in blocks, each containing the synapses of a
+ * fixed-size range of source neurons. Apart from the source indices, the
+ * blocks refer directly to the mapped file.
+ *
+ * The header and the row structure are validated when the file is opened,
+ * and the delays and targets of each block when the block is read.
+ */
+class NEMO_BASE_DLL_PUBLIC Generator : public network::Generator
+{
+	public :
+
+		/*! Open a network file
+		 *
+		 * \throws nemo::exception if the file cannot be opened, or is not a
+		 * 		valid network file for this version of NeMo and this machine
+		 */
+		explicit Generator(const std::string& filename);
+
+		neuron_iterator neuron_begin(unsigned i) const;
+		neuron_iterator neuron_end(unsigned i) const;
+
+		synapse_iterator synapse_begin() const;
+		synapse_iterator synapse_end() const;
+
+		/*! \copydoc nemo::network::Generator::synapseBlockCount */
+		size_t synapseBlockCount() const;
+
+		/*! \copydoc nemo::network::Generator::synapseBlock */
+		SynapseBlock synapseBlock(size_t i, SynapseBuffer& buffer) const;
+
+		unsigned neuronCount() const;
+		unsigned neuronCount(unsigned type) const;
+		unsigned maxDelay() const;
+		unsigned minNeuronIndex() const;
+		unsigned maxNeuronIndex() const;
+		unsigned neuronTypeCount() const;
+		const class NeuronType& neuronType(unsigned i) const;
+
+		/*! \return total number of synapses in the network */
+		uint64_t synapseCount() const { return m_header->synapseCount; }
+
+		/*! Number of source neurons in each block of synapses */
+		static const unsigned SOURCES_PER_BLOCK = 1024;
+
+	private :
+
+		std::string m_filename;
+
+		boost::interprocess::file_mapping m_file;
+		boost::interprocess::mapped_region m_region;
+
+		const FileHeader* m_header;
+		const TypeHeader* m_typeHeader;
+
+		/* Per neuron type */
+		std::vector<NeuronType> m_types;
+		std::vector<const uint32_t*> m_neuronIndex;
+		std::vector<const float*> m_neuronParam;
+		std::vector<const float*> m_neuronState;
+
+		const uint64_t* m_rowOffset;
+		const uint32_t* m_target;
+		const uint32_t* m_delay;
+		const float* m_weight;
+		const unsigned char* m_plastic;
+		const uint32_t* m_id;
+
+		/*! \return pointer to a section of \a count elements of type T */
+		template<typename T>
+		const T* section(uint64_t offset, uint64_t count, const char* name) const;
+
+		void validateRows() const;
+
+		// undefined
+		Generator(const Generator&);
+		Generator& operator=(const Generator&);
+};
+
+}	}	}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef NEMO_NETWORK_MAPPED_FORMAT_HPP
+#define NEMO_NETWORK_MAPPED_FORMAT_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/static_assert.hpp>
+
+#include <nemo/types.hpp>
+
+/*! \file format.hpp
+ *
+ * \brief On-disk layout of memory-mapped network files
+ *
+ * A network file consists of a fixed-size \a FileHeader followed by a number
+ * of sections, each of which starts at an offset (in bytes from the start of
+ * the file) given in a header. Sections are aligned to \a SECTION_ALIGNMENT
+ * bytes, so that they can be accessed directly in the mapped file. All values
+ * are stored in the byte order of the machine which wrote the file.
+ *
+ * The neurons are stored separately for each neuron type, as a \a TypeHeader
+ * and three arrays: the neuron indices, the parameters, and the state
+ * variables. Parameters and state variables are stored as one array per
+ * variable (i.e. parameter \e p of the \e k th neuron of a type is found at
+ * index p*neuronCount + k).
+ *
+ * The synapses are stored in compressed sparse row format, with one row for
+ * each neuron index in [minNeuronIndex, maxNeuronIndex]. The synapses of
+ * source neuron \e n are found at [rowOffset[r], rowOffset[r+1]) in the target,
+ * delay, weight, plastic, and id arrays, where r = n - minNeuronIndex. Within a
+ * row the synapses are in the order in which they were exported by the
+ * generator which wrote the file.
+ */
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+const char MAGIC[8] = { 'N', 'E', 'M', 'O', 'N', 'E', 'T', '\0' };
+
+/*! Incremented whenever the layout changes */
+const uint32_t VERSION = 1;
+
+/*! Written as a 32-bit value, for detecting files written on machines with a
+ * different byte order */
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+const uint64_t SECTION_ALIGNMENT = 64;
+
+const unsigned TYPE_NAME_LENGTH = 64;
+
+
+struct FileHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+
+	uint32_t neuronTypeCount;
+	uint32_t maxDelay;
+	uint32_t minNeuronIndex;
+	uint32_t maxNeuronIndex;
+
+	uint64_t neuronCount;
+	uint64_t synapseCount;
+
+	/*! Number of rows in the synapse arrays, i.e. maxNeuronIndex -
+	 * minNeuronIndex + 1 */
+	uint64_t rowCount;
+
+	/*! TypeHeader[neuronTypeCount] */
+	uint64_t typeOffset;
+
+	/*! uint64_t[rowCount+1] */
+	uint64_t rowOffsetOffset;
+
+	/*! uint32_t[synapseCount] */
+	uint64_t targetOffset;
+
+	/*! uint32_t[synapseCount] */
+	uint64_t delayOffset;
+
+	/*! float[synapseCount] */
+	uint64_t weightOffset;
+
+	/*! uint8_t[synapseCount] */
+	uint64_t plasticOffset;
+
+	/*! uint32_t[synapseCount] */
+	uint64_t idOffset;
+};
+
+
+
+struct TypeHeader
+{
+	/*! Null-terminated name of the neuron type, as passed to \a
+	 * Network::addNeuronType */
+	char name[TYPE_NAME_LENGTH];
+
+	uint32_t parameterCount;
+	uint32_t stateCount;
+	uint64_t neuronCount;
+
+	/*! uint32_t[neuronCount] */
+	uint64_t indexOffset;
+
+	/*! float[parameterCount][neuronCount] */
+	uint64_t parameterOffset;
+
+	/*! float[stateCount][neuronCount] */
+	uint64_t stateOffset;
+};
+
+
+/* The synapse arrays are handed to the backends without conversion */
+BOOST_STATIC_ASSERT(sizeof(nidx_t) == sizeof(uint32_t));
+BOOST_STATIC_ASSERT(sizeof(delay_t) == sizeof(uint32_t));
+BOOST_STATIC_ASSERT(sizeof(id32_t) == sizeof(uint32_t));
+BOOST_STATIC_ASSERT(sizeof(float) == 4);
+
+/* No padding, so that the layout does not depend on the compiler */
+BOOST_STATIC_ASSERT(sizeof(FileHeader) == 112);
+BOOST_STATIC_ASSERT(sizeof(TypeHeader) == 104);
+
+}	}	}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef NEMO_NETWORK_MAPPED_NEURON_ITERATOR_HPP
+#define NEMO_NETWORK_MAPPED_NEURON_ITERATOR_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <typeinfo>
+
+#include <nemo/network/iterator.hpp>
+#include <nemo/NeuronType.hpp>
+
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+/* Iterator over the neurons of a single type in a mapped network file. The
+ * parameters and state variables are stored with one array per variable,
+ * each of length \a count */
+class NEMO_BASE_DLL_PUBLIC neuron_iterator : public abstract_neuron_iterator
+{
+	public :
+
+		neuron_iterator(const NeuronType& type, size_t count, size_t pos,
+				const uint32_t* index, const float* param, const float* state) :
+			m_nt(type), m_count(count), m_pos(pos),
+			m_index(index), m_param(param), m_state(state) {}
+
+		void set_value() const {
+			m_data.second = Neuron(m_nt);
+			m_data.first = m_index[m_pos];
+			for(size_t i=0; i < m_nt.parameterCount(); ++i) {
+				m_data.second.setParameter(i, m_param[i*m_count + m_pos]);
+			}
+			for(size_t i=0; i < m_nt.stateVarCount(); ++i) {
+				m_data.second.setState(i, m_state[i*m_count + m_pos]);
+			}
+		}
+
+		const value_type& operator*() const {
+			set_value();
+			return m_data;
+		}
+
+		const value_type* operator->() const {
+			set_value();
+			return &m_data;
+		}
+
+		nemo::network::abstract_neuron_iterator* clone() const {
+			return new neuron_iterator(*this);
+		}
+
+		nemo::network::abstract_neuron_iterator& operator++() {
+			++m_pos;
+			return *this;
+		}
+
+		bool operator==(const abstract_neuron_iterator& rhs_) const {
+			if(typeid(*this) != typeid(rhs_)) {
+				return false;
+			}
+			const neuron_iterator& rhs = static_cast<const neuron_iterator&>(rhs_);
+			return m_index == rhs.m_index && m_pos == rhs.m_pos;
+		}
+
+		bool operator!=(const abstract_neuron_iterator& rhs) const {
+			return !(*this == rhs);
+		}
+
+	private :
+
+		mutable value_type m_data;
+
+		const NeuronType m_nt;
+
+		size_t m_count;
+		size_t m_pos;
+
+		const uint32_t* m_index;
+		const float* m_param;
+		const float* m_state;
+};
+
+}	}	}
+
+#endif
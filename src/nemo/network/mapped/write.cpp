@@ -0,0 +1,326 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "write.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <nemo/exception.hpp>
+#include "format.hpp"
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+
+/* Number of synapses buffered at a time when reading synapses from a
+ * generator which does not provide synapse blocks */
+const size_t ITERATOR_BLOCK_SIZE = 65536;
+
+
+/* Call visit for every synapse block in the network */
+template<class Visitor>
+void
+forEachBlock(const network::Generator& net, Visitor& visit)
+{
+	SynapseBuffer buffer;
+	size_t blockCount = net.synapseBlockCount();
+	if(blockCount != 0) {
+		for(size_t i=0; i < blockCount; ++i) {
+			visit(net.synapseBlock(i, buffer));
+		}
+		return;
+	}
+
+	synapse_iterator end = net.synapse_end();
+	for(synapse_iterator i = net.synapse_begin(); i != end; ++i) {
+		buffer.add(i->source, i->target(), i->delay, i->weight(), i->plastic(), i->id());
+		if(buffer.size() == ITERATOR_BLOCK_SIZE) {
+			visit(buffer.block());
+			buffer.clear();
+		}
+	}
+	if(buffer.size() != 0) {
+		visit(buffer.block());
+	}
+}
+
+
+
+/* Count the synapses of each row. The count for row r is stored at r+1, so
+ * that the prefix sum gives the row offsets in place */
+class RowCounter
+{
+	public :
+
+		RowCounter(std::vector<uint64_t>& count, nidx_t minIdx, nidx_t maxIdx) :
+			m_count(count), m_minIdx(minIdx), m_maxIdx(maxIdx) { }
+
+		void operator()(const SynapseBlock& block) {
+			using boost::format;
+			for(size_t s=0; s < block.size; ++s) {
+				nidx_t source = block.source[s];
+				if(source < m_minIdx || source > m_maxIdx) {
+					throw nemo::exception(NEMO_INVALID_INPUT,
+							str(format("Synapse source neuron %u is outside the range of neuron indices [%u, %u]")
+								% source % m_minIdx % m_maxIdx));
+				}
+				m_count[source - m_minIdx + 1] += 1;
+			}
+		}
+
+	private :
+
+		std::vector<uint64_t>& m_count;
+		nidx_t m_minIdx;
+		nidx_t m_maxIdx;
+};
+
+
+
+/* Write each synapse to the next free slot in the row of its source */
+class RowWriter
+{
+	public :
+
+		RowWriter(const uint64_t* rowOffset, size_t rowCount, nidx_t minIdx,
+				uint32_t* target, uint32_t* delay, float* weight,
+				unsigned char* plastic, uint32_t* id) :
+			m_rowOffset(rowOffset),
+			m_next(rowOffset, rowOffset + rowCount),
+			m_minIdx(minIdx),
+			m_target(target), m_delay(delay), m_weight(weight),
+			m_plastic(plastic), m_id(id) { }
+
+		void operator()(const SynapseBlock& block) {
+			for(size_t s=0; s < block.size; ++s) {
+				size_t row = block.source[s] - m_minIdx;
+				if(row >= m_next.size() || m_next[row] == m_rowOffset[row+1]) {
+					throw nemo::exception(NEMO_LOGIC_ERROR,
+							"Network generator returned different synapses when read a second time");
+				}
+				uint64_t i = m_next[row]++;
+				m_target[i] = block.target[s];
+				m_delay[i] = block.delay[s];
+				m_weight[i] = block.weight[s];
+				m_plastic[i] = block.plastic[s];
+				m_id[i] = block.id[s];
+			}
+		}
+
+		/*! \return true if every row has been filled */
+		bool complete() const {
+			for(size_t r=0; r < m_next.size(); ++r) {
+				if(m_next[r] != m_rowOffset[r+1]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private :
+
+		const uint64_t* m_rowOffset;
+		std::vector<uint64_t> m_next;
+		nidx_t m_minIdx;
+
+		uint32_t* m_target;
+		uint32_t* m_delay;
+		float* m_weight;
+		unsigned char* m_plastic;
+		uint32_t* m_id;
+};
+
+
+
+inline
+uint64_t
+align(uint64_t offset)
+{
+	return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+
+
+/* \return offset of a new section of the given size, starting at offset */
+inline
+uint64_t
+allocate(uint64_t& offset, uint64_t bytes)
+{
+	uint64_t section = offset;
+	offset = align(offset + bytes);
+	return section;
+}
+
+
+
+/* Create a zero-filled file of the given size */
+void
+createFile(const std::string& filename, uint64_t size)
+{
+	using boost::format;
+
+	std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(file.good()) {
+		file.seekp(std::streamoff(size - 1));
+		file.put('\0');
+	}
+	file.close();
+	if(file.fail()) {
+		throw nemo::exception(NEMO_IO_ERROR,
+				str(format("Failed to create network file %s") % filename));
+	}
+}
+
+
+
+/* Write the neurons of a single type. The neuron iterator yields each neuron
+ * as a Neuron object, which is split up into the per-variable arrays */
+void
+writeNeurons(const network::Generator& net, unsigned type,
+		const TypeHeader& th, char* base)
+{
+	uint32_t* index = reinterpret_cast<uint32_t*>(base + th.indexOffset);
+	float* param = reinterpret_cast<float*>(base + th.parameterOffset);
+	float* state = reinterpret_cast<float*>(base + th.stateOffset);
+
+	const uint64_t n = th.neuronCount;
+	uint64_t k = 0;
+	neuron_iterator end = net.neuron_end(type);
+	for(neuron_iterator i = net.neuron_begin(type); i != end; ++i, ++k) {
+		if(k == n) {
+			break;
+		}
+		index[k] = i->first;
+		for(unsigned p=0; p < th.parameterCount; ++p) {
+			param[p*n + k] = i->second.getParameter(p);
+		}
+		for(unsigned s=0; s < th.stateCount; ++s) {
+			state[s*n + k] = i->second.getState(s);
+		}
+	}
+	if(k != n) {
+		throw nemo::exception(NEMO_LOGIC_ERROR,
+				"Network generator returned an inconsistent number of neurons");
+	}
+}
+
+
+
+void
+write(const network::Generator& net, const std::string& filename)
+{
+	using boost::format;
+	namespace bip = boost::interprocess;
+
+	if(net.neuronCount() == 0) {
+		throw nemo::exception(NEMO_INVALID_INPUT, "Cannot write an empty network");
+	}
+
+	FileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.neuronTypeCount = net.neuronTypeCount();
+	header.maxDelay = net.maxDelay();
+	header.minNeuronIndex = net.minNeuronIndex();
+	header.maxNeuronIndex = net.maxNeuronIndex();
+	header.neuronCount = net.neuronCount();
+	header.rowCount = uint64_t(header.maxNeuronIndex) - header.minNeuronIndex + 1;
+
+	/* Pass 1: row sizes */
+	std::vector<uint64_t> rowOffset(header.rowCount + 1, 0);
+	RowCounter counter(rowOffset, header.minNeuronIndex, header.maxNeuronIndex);
+	forEachBlock(net, counter);
+	for(size_t r=0; r < header.rowCount; ++r) {
+		rowOffset[r+1] += rowOffset[r];
+	}
+	header.synapseCount = rowOffset.back();
+
+	/* Layout */
+	uint64_t offset = align(sizeof(FileHeader));
+	header.typeOffset = allocate(offset, header.neuronTypeCount * sizeof(TypeHeader));
+
+	std::vector<TypeHeader> types(header.neuronTypeCount);
+	for(unsigned t=0; t < header.neuronTypeCount; ++t) {
+		TypeHeader& th = types[t];
+		memset(&th, 0, sizeof(th));
+		const NeuronType& type = net.neuronType(t);
+		std::string name = type.name();
+		if(name.size() >= TYPE_NAME_LENGTH) {
+			throw nemo::exception(NEMO_INVALID_INPUT,
+					str(format("Neuron type name '%s' too long for network file") % name));
+		}
+		strncpy(th.name, name.c_str(), TYPE_NAME_LENGTH);
+		th.parameterCount = type.parameterCount();
+		th.stateCount = type.stateVarCount();
+		th.neuronCount = net.neuronCount(t);
+		th.indexOffset = allocate(offset, th.neuronCount * sizeof(uint32_t));
+		th.parameterOffset = allocate(offset, th.parameterCount * th.neuronCount * sizeof(float));
+		th.stateOffset = allocate(offset, th.stateCount * th.neuronCount * sizeof(float));
+	}
+
+	const uint64_t S = header.synapseCount;
+	header.rowOffsetOffset = allocate(offset, (header.rowCount + 1) * sizeof(uint64_t));
+	header.targetOffset = allocate(offset, S * sizeof(uint32_t));
+	header.delayOffset = allocate(offset, S * sizeof(uint32_t));
+	header.weightOffset = allocate(offset, S * sizeof(float));
+	header.plasticOffset = allocate(offset, S * sizeof(unsigned char));
+	header.idOffset = allocate(offset, S * sizeof(uint32_t));
+
+	createFile(filename, offset);
+
+	try {
+		bip::file_mapping file(filename.c_str(), bip::read_write);
+		bip::mapped_region region(file, bip::read_write);
+		char* base = static_cast<char*>(region.get_address());
+
+		if(header.neuronTypeCount != 0) {
+			memcpy(base + header.typeOffset, &types[0],
+					header.neuronTypeCount * sizeof(TypeHeader));
+		}
+		for(unsigned t=0; t < header.neuronTypeCount; ++t) {
+			writeNeurons(net, t, types[t], base);
+		}
+
+		uint64_t* mappedRowOffset = reinterpret_cast<uint64_t*>(base + header.rowOffsetOffset);
+		std::copy(rowOffset.begin(), rowOffset.end(), mappedRowOffset);
+
+		/* Pass 2: synapses */
+		RowWriter writer(mappedRowOffset, header.rowCount, header.minNeuronIndex,
+				reinterpret_cast<uint32_t*>(base + header.targetOffset),
+				reinterpret_cast<uint32_t*>(base + header.delayOffset),
+				reinterpret_cast<float*>(base + header.weightOffset),
+				reinterpret_cast<unsigned char*>(base + header.plasticOffset),
+				reinterpret_cast<uint32_t*>(base + header.idOffset));
+		forEachBlock(net, writer);
+		if(!writer.complete()) {
+			throw nemo::exception(NEMO_LOGIC_ERROR,
+					"Network generator returned different synapses when read a second time");
+		}
+
+		/* The header is written last, so that an incomplete file is never
+		 * mistaken for a valid one */
+		memcpy(base, &header, sizeof(header));
+		region.flush();
+	} catch(bip::interprocess_exception& e) {
+		throw nemo::exception(NEMO_IO_ERROR,
+				str(format("Failed to write network file %s: %s") % filename % e.what()));
+	}
+}
+
+}	}	}
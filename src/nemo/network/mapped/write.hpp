@@ -0,0 +1,39 @@
+#ifndef NEMO_NETWORK_MAPPED_WRITE_HPP
+#define NEMO_NETWORK_MAPPED_WRITE_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+
+#include <nemo/config.h>
+#include <nemo/network/Generator.hpp>
+
+namespace nemo {
+	namespace network {
+		namespace mapped {
+
+/*! Write a network to a file in the memory-mapped network format (see
+ * format.hpp), replacing any existing file
+ *
+ * The synapses are read from the generator twice: once to count the synapses
+ * of each source neuron, and once to write them. The synapse blocks are used
+ * if the generator provides them, and the synapse iterators otherwise.
+ *
+ * \throws nemo::exception if the network is empty, if any synapse has a
+ * 		source neuron outside the range of neuron indices, or if the file
+ * 		could not be written
+ */
+NEMO_BASE_DLL_PUBLIC
+void
+write(const network::Generator& net, const std::string& filename);
+
+}	}	}
+
+#endif
@@ -0,0 +1,300 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Connectivity.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <boost/format.hpp>
+
+#include <nemo/exception.hpp>
+#include <nemo/util.h>
+
+namespace nemo {
+	namespace network {
+		namespace procedural {
+
+
+const unsigned Torus::PATCH_WIDTH;
+const unsigned Torus::PATCH_HEIGHT;
+const unsigned Torus::MAX_DELAY;
+
+
+/* \return uniform random number in [0, 1) */
+inline
+double
+uniform(RNG& rng)
+{
+	return urand(&rng) * 2.3283064365386962890625e-10;
+}
+
+
+
+/* Finaliser from SplitMix64, used as the Feistel round function */
+inline
+uint64_t
+mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+
+const unsigned FEISTEL_ROUNDS = 4;
+
+
+/* Inverse of the pseudo-random permutation of [0, 2^(2*halfBits)) given by
+ * a balanced Feistel network with the rounds (l, r) -> (r, l ^ f(r)). Only
+ * the inverse is ever needed. */
+inline
+uint64_t
+feistelInverse(uint64_t x, uint64_t key, unsigned halfBits)
+{
+	const uint64_t mask = (uint64_t(1) << halfBits) - 1;
+	uint64_t l = x >> halfBits;
+	uint64_t r = x & mask;
+	for(unsigned round=FEISTEL_ROUNDS; round-- > 0; ) {
+		uint64_t t = l;
+		l = r ^ (mix(key + (uint64_t(round) << 56) + l) & mask);
+		r = t;
+	}
+	return (l << halfBits) | r;
+}
+
+
+
+FixedInDegree::FixedInDegree(
+		nidx_t sourceBegin, nidx_t sourceEnd,
+		nidx_t targetBegin, nidx_t targetEnd,
+		unsigned inDegree,
+		float minWeight, float maxWeight,
+		delay_t minDelay, delay_t maxDelay,
+		bool plastic) :
+	m_sourceBegin(sourceBegin),
+	m_sourceEnd(sourceEnd),
+	m_targetBegin(targetBegin),
+	m_targetEnd(targetEnd),
+	m_inDegree(inDegree),
+	m_minWeight(minWeight),
+	m_maxWeight(maxWeight),
+	m_minDelay(minDelay),
+	m_maxDelay(maxDelay),
+	m_plastic(plastic),
+	m_slots(uint64_t(inDegree) * (targetEnd - targetBegin)),
+	m_halfBits(1)
+{
+	if(sourceBegin >= sourceEnd || targetBegin >= targetEnd) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Empty source or target range in fixed in-degree connectivity");
+	}
+	if(minDelay < 1 || minDelay > maxDelay) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Invalid delay range in fixed in-degree connectivity");
+	}
+	if(minWeight > maxWeight) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Invalid weight range in fixed in-degree connectivity");
+	}
+	if(m_slots > (uint64_t(1) << 62)) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Too many synapses in fixed in-degree connectivity");
+	}
+	while((uint64_t(1) << (2*m_halfBits)) < m_slots) {
+		m_halfBits += 1;
+	}
+}
+
+
+
+/* Slot q = k * targetCount + t is the kth synapse of the tth target. The
+ * permutation maps slots to positions, and position p belongs to the source
+ * p mod sourceCount. Slots are permuted over a domain which is a power of
+ * four, and positions outside [0, slots) are skipped by repeated application
+ * of the permutation (cycle walking), which gives a permutation of [0,
+ * slots). The slots of a source are thus found by applying the inverse
+ * permutation to each of its positions. */
+void
+FixedInDegree::generate(nidx_t source, uint64_t key, RNG& rng, SynapseBuffer& out) const
+{
+	const uint64_t sourceCount = m_sourceEnd - m_sourceBegin;
+	const uint64_t targetCount = m_targetEnd - m_targetBegin;
+	const unsigned delayRange = m_maxDelay - m_minDelay + 1;
+	const uint64_t pkey = mix(key);
+
+	for(uint64_t p = source - m_sourceBegin; p < m_slots; p += sourceCount) {
+		uint64_t q = p;
+		do {
+			q = feistelInverse(q, pkey, m_halfBits);
+		} while(q >= m_slots);
+		nidx_t target = m_targetBegin + nidx_t(q % targetCount);
+		float weight = m_minWeight + float(uniform(rng) * (m_maxWeight - m_minWeight));
+		delay_t delay = m_minDelay + urand(&rng) % delayRange;
+		out.add(source, target, delay, weight, m_plastic, 0);
+	}
+}
+
+
+
+Torus::Torus(nidx_t first, unsigned pcount,
+		nidx_t sourceBegin, nidx_t sourceEnd,
+		unsigned outDegree, float sigma,
+		float minWeight, float maxWeight,
+		bool plastic) :
+	m_first(first),
+	m_pcount(pcount),
+	m_sourceBegin(sourceBegin),
+	m_sourceEnd(sourceEnd),
+	m_outDegree(outDegree),
+	m_sigma(sigma),
+	m_minWeight(minWeight),
+	m_maxWeight(maxWeight),
+	m_plastic(plastic)
+{
+	nidx_t end = first + pcount * PATCH_WIDTH * PATCH_HEIGHT;
+	if(pcount == 0 || sourceBegin >= sourceEnd || sourceBegin < first || sourceEnd > end) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Invalid source range in torus connectivity");
+	}
+	if(minWeight > maxWeight) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Invalid weight range in torus connectivity");
+	}
+}
+
+
+
+/* Round to nearest integer away from zero */
+inline
+double
+roundAway(double r) {
+	return (r > 0.0) ? floor(r + 0.5) : ceil(r - 0.5);
+}
+
+
+
+void
+Torus::generate(nidx_t source, uint64_t /* key */, RNG& rng, SynapseBuffer& out) const
+{
+	const unsigned patchSize = PATCH_WIDTH * PATCH_HEIGHT;
+	const int torusWidth = int(PATCH_WIDTH * m_pcount);
+
+	unsigned local = source - m_first;
+	unsigned patch = local / patchSize;
+	int sourceX = int(patch * PATCH_WIDTH + local % PATCH_WIDTH);
+	int sourceY = int((local % patchSize) / PATCH_WIDTH);
+
+	for(unsigned s=0; s < m_outDegree; ++s) {
+
+		double dist = 1.0 + fabs(m_sigma * nrand(&rng));
+		double theta = 2.0 * M_PI * uniform(rng);
+
+		int x = (sourceX + int(roundAway(dist * cos(theta)))) % torusWidth;
+		int y = (sourceY + int(roundAway(dist * sin(theta)))) % int(PATCH_HEIGHT);
+		if(x < 0) {
+			x += torusWidth;
+		}
+		if(y < 0) {
+			y += PATCH_HEIGHT;
+		}
+
+		nidx_t target = m_first
+			+ (x / PATCH_WIDTH) * patchSize + y * PATCH_WIDTH + x % PATCH_WIDTH;
+		unsigned d = unsigned(dist);
+		delay_t delay = d >= MAX_DELAY * PATCH_WIDTH ? MAX_DELAY : 1 + d / PATCH_WIDTH;
+		float weight = m_minWeight + float(uniform(rng) * (m_maxWeight - m_minWeight));
+		out.add(source, target, delay, weight, m_plastic, 0);
+	}
+}
+
+
+
+Blocks::Blocks(nidx_t first, const std::vector<unsigned>& sizes) :
+	m_offset(1, first),
+	m_projections(sizes.size()),
+	m_maxDelay(0)
+{
+	if(sizes.empty()) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				"Block connectivity requires at least one block");
+	}
+	for(std::vector<unsigned>::const_iterator i = sizes.begin(); i != sizes.end(); ++i) {
+		m_offset.push_back(m_offset.back() + *i);
+	}
+}
+
+
+
+void
+Blocks::connect(unsigned source, unsigned target,
+		float probability, float weight, delay_t delay, bool plastic)
+{
+	using boost::format;
+
+	if(source >= m_projections.size() || target >= m_projections.size()) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Invalid block projection (%u -> %u)") % source % target));
+	}
+	if(probability < 0.0f || probability > 1.0f) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Invalid connection probability (%f)") % probability));
+	}
+	if(delay < 1) {
+		throw nemo::exception(NEMO_INVALID_INPUT,
+				str(format("Invalid delay (%u) for block projection") % delay));
+	}
+	Projection p;
+	p.target = target;
+	p.probability = probability;
+	p.weight = weight;
+	p.delay = delay;
+	p.plastic = plastic;
+	m_projections[source].push_back(p);
+	m_maxDelay = std::max(m_maxDelay, delay);
+}
+
+
+
+/* Rather than drawing a random number for each potential target, the gaps
+ * between consecutive targets are drawn from the geometric distribution */
+void
+Blocks::generate(nidx_t source, uint64_t /* key */, RNG& rng, SynapseBuffer& out) const
+{
+	unsigned block = unsigned(std::upper_bound(m_offset.begin(), m_offset.end(), source)
+			- m_offset.begin()) - 1;
+	const std::vector<Projection>& projections = m_projections.at(block);
+
+	for(std::vector<Projection>::const_iterator p = projections.begin();
+			p != projections.end(); ++p) {
+		nidx_t begin = m_offset[p->target];
+		nidx_t end = m_offset[p->target+1];
+		if(p->probability <= 0.0f) {
+			continue;
+		}
+		if(p->probability >= 1.0f) {
+			for(nidx_t t = begin; t < end; ++t) {
+				out.add(source, t, p->delay, p->weight, p->plastic, 0);
+			}
+			continue;
+		}
+		double logq = log(1.0 - p->probability);
+		for(double t = begin; ; t += 1.0) {
+			/* uniform in (0, 1] */
+			double u = 1.0 - uniform(rng);
+			t += floor(log(u) / logq);
+			if(t >= end) {
+				break;
+			}
+			out.add(source, nidx_t(t), p->delay, p->weight, p->plastic, 0);
+		}
+	}
+}
+
+}	}	}
@@ -0,0 +1,230 @@
+#ifndef NEMO_NETWORK_PROCEDURAL_CONNECTIVITY_HPP
+#define NEMO_NETWORK_PROCEDURAL_CONNECTIVITY_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+
+#include <nemo/config.h>
+#include <nemo/network/Generator.hpp>
+#include <nemo/RNG.hpp>
+
+namespace nemo {
+	namespace network {
+		namespace procedural {
+
+/*! \brief Rule for computing the synapses of a range of source neurons
+ *
+ * A connectivity rule never stores the synapses. Instead it computes all the
+ * synapses of a single source neuron on demand, using only the source index,
+ * a per-rule key, and a random number generator which the caller seeds for
+ * each source. The synapses of any source can thus be computed independently
+ * of (and in parallel with) those of any other source, and repeated calls
+ * give the same result.
+ *
+ * Rules are added to a \a procedural::Generator, which stores a copy.
+ */
+class NEMO_BASE_DLL_PUBLIC Connectivity
+{
+	public :
+
+		virtual ~Connectivity() { }
+
+		virtual Connectivity* clone() const = 0;
+
+		/*! \return index of the first source neuron */
+		virtual nidx_t sourceBegin() const = 0;
+
+		/*! \return index one past the last source neuron */
+		virtual nidx_t sourceEnd() const = 0;
+
+		/*! \return maximum delay of any generated synapse */
+		virtual delay_t maxDelay() const = 0;
+
+		/*! Append all synapses from \a source to \a out
+		 *
+		 * The synapse ids written here are ignored, as ids are assigned by
+		 * the generator.
+		 *
+		 * \param key
+		 * 		identifies the rule within the generator and the generator's
+		 * 		seed. Randomness shared between sources should be derived
+		 * 		from this.
+		 * \param rng generator seeded for this rule and source
+		 *
+		 * \pre sourceBegin() <= source < sourceEnd()
+		 */
+		virtual void generate(nidx_t source, uint64_t key,
+				RNG& rng, SynapseBuffer& out) const = 0;
+};
+
+
+
+/*! \brief Random connectivity where each target has the same in-degree
+ *
+ * Each target neuron in [targetBegin, targetEnd) receives exactly \a inDegree
+ * synapses from sources in [sourceBegin, sourceEnd). The sources are chosen
+ * by a pseudo-random permutation of all (target, k) synapse slots, which can
+ * be inverted for each source, so that the synapses can be generated per
+ * source. The out-degrees therefore differ by at most one. Self-connections
+ * and multiple synapses between the same pair of neurons are allowed.
+ *
+ * Weights are uniformly distributed in [minWeight, maxWeight] and delays in
+ * [minDelay, maxDelay].
+ */
+class NEMO_BASE_DLL_PUBLIC FixedInDegree : public Connectivity
+{
+	public :
+
+		FixedInDegree(
+				nidx_t sourceBegin, nidx_t sourceEnd,
+				nidx_t targetBegin, nidx_t targetEnd,
+				unsigned inDegree,
+				float minWeight, float maxWeight,
+				delay_t minDelay, delay_t maxDelay,
+				bool plastic = false);
+
+		Connectivity* clone() const { return new FixedInDegree(*this); }
+
+		nidx_t sourceBegin() const { return m_sourceBegin; }
+		nidx_t sourceEnd() const { return m_sourceEnd; }
+		delay_t maxDelay() const { return m_maxDelay; }
+
+		void generate(nidx_t source, uint64_t key, RNG& rng, SynapseBuffer& out) const;
+
+	private :
+
+		nidx_t m_sourceBegin;
+		nidx_t m_sourceEnd;
+		nidx_t m_targetBegin;
+		nidx_t m_targetEnd;
+		unsigned m_inDegree;
+		float m_minWeight;
+		float m_maxWeight;
+		delay_t m_minDelay;
+		delay_t m_maxDelay;
+		bool m_plastic;
+
+		/* Number of synapse slots, i.e. inDegree * number of targets */
+		uint64_t m_slots;
+
+		/* Half the number of bits in the permutation domain */
+		unsigned m_halfBits;
+};
+
+
+
+/*! \brief Distance-dependent connectivity on a torus
+ *
+ * The neurons are laid out as in the 'torus' example: \a pcount patches of
+ * 32x32 neurons are placed side by side to form a torus, and neuron (x, y) of
+ * patch p has index first + p*1024 + y*32 + x. Each source in [sourceBegin,
+ * sourceEnd) has \a outDegree synapses. The distance to each target is
+ * 1 + |N(0, sigma)| in a uniformly random direction, and the delay grows by
+ * 1ms for every 32 units of distance, up to 20ms. Weights are uniformly
+ * distributed in [minWeight, maxWeight].
+ */
+class NEMO_BASE_DLL_PUBLIC Torus : public Connectivity
+{
+	public :
+
+		Torus(nidx_t first, unsigned pcount,
+				nidx_t sourceBegin, nidx_t sourceEnd,
+				unsigned outDegree, float sigma,
+				float minWeight, float maxWeight,
+				bool plastic = false);
+
+		Connectivity* clone() const { return new Torus(*this); }
+
+		nidx_t sourceBegin() const { return m_sourceBegin; }
+		nidx_t sourceEnd() const { return m_sourceEnd; }
+		delay_t maxDelay() const { return MAX_DELAY; }
+
+		void generate(nidx_t source, uint64_t key, RNG& rng, SynapseBuffer& out) const;
+
+		static const unsigned PATCH_WIDTH = 32;
+		static const unsigned PATCH_HEIGHT = 32;
+		static const unsigned MAX_DELAY = 20;
+
+	private :
+
+		nidx_t m_first;
+		unsigned m_pcount;
+		nidx_t m_sourceBegin;
+		nidx_t m_sourceEnd;
+		unsigned m_outDegree;
+		float m_sigma;
+		float m_minWeight;
+		float m_maxWeight;
+		bool m_plastic;
+};
+
+
+
+/*! \brief Block-structured random connectivity
+ *
+ * The neurons are divided into consecutive blocks (populations), and
+ * projections are specified between pairs of blocks. For each projection,
+ * each neuron in the source block connects to each neuron in the target
+ * block independently with a given probability, with a fixed weight and
+ * delay.
+ */
+class NEMO_BASE_DLL_PUBLIC Blocks : public Connectivity
+{
+	public :
+
+		/*!
+		 * \param first index of the first neuron in the first block
+		 * \param sizes number of neurons in each block
+		 */
+		Blocks(nidx_t first, const std::vector<unsigned>& sizes);
+
+		/*! Add a projection between two blocks
+		 *
+		 * \param source index of source block
+		 * \param target index of target block
+		 * \param probability connection probability for each pair of neurons
+		 */
+		void connect(unsigned source, unsigned target,
+				float probability, float weight, delay_t delay,
+				bool plastic = false);
+
+		Connectivity* clone() const { return new Blocks(*this); }
+
+		nidx_t sourceBegin() const { return m_offset.front(); }
+		nidx_t sourceEnd() const { return m_offset.back(); }
+		delay_t maxDelay() const { return m_maxDelay; }
+
+		void generate(nidx_t source, uint64_t key, RNG& rng, SynapseBuffer& out) const;
+
+	private :
+
+		struct Projection
+		{
+			unsigned target;
+			float probability;
+			float weight;
+			delay_t delay;
+			bool plastic;
+		};
+
+		/* Neuron index of the first neuron in each block, followed by one
+		 * past the last neuron */
+		std::vector<nidx_t> m_offset;
+
+		/* Projections from each block */
+		std::vector< std::vector<Projection> > m_projections;
+
+		delay_t m_maxDelay;
+};
+
+}	}	}
+
+#endif
@@ -0,0 +1,189 @@
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Generator.hpp"
+
+#include <algorithm>
+
+#include <nemo/Network.hpp>
+#include <nemo/NetworkImpl.hpp>
+#include <nemo/RNG.hpp>
+#include <nemo/network/synapse_block_iterator.hpp>
+
+namespace nemo {
+	namespace network {
+		namespace procedural {
+
+
+const unsigned Generator::SOURCES_PER_BLOCK;
+
+
+Generator::Generator(const nemo::Network& net, unsigned seed) :
+	m_net(*net.m_impl),
+	m_seed(seed),
+	m_sourceBegin(0),
+	m_sourceEnd(0),
+	m_maxDelay(0)
+{
+	;
+}
+
+
+
+void
+Generator::add(const Connectivity& rule)
+{
+	if(m_rules.empty()) {
+		m_sourceBegin = rule.sourceBegin();
+		m_sourceEnd = rule.sourceEnd();
+	} else {
+		m_sourceBegin = std::min(m_sourceBegin, rule.sourceBegin());
+		m_sourceEnd = std::max(m_sourceEnd, rule.sourceEnd());
+	}
+	m_maxDelay = std::max(m_maxDelay, rule.maxDelay());
+	m_rules.push_back(rule.clone());
+}
+
+
+
+size_t
+Generator::synapseBlockCount() const
+{
+	size_t sources = m_sourceEnd - m_sourceBegin;
+	return m_net.synapseBlockCount()
+		+ (sources + SOURCES_PER_BLOCK - 1) / SOURCES_PER_BLOCK;
+}
+
+
+
+/* The random number generator for each rule and source is seeded with the
+ * rule in the upper half of the key, so that the streams differ from those
+ * used for the neuron noise (which use the neuron index as key). */
+SynapseBlock
+Generator::synapseBlock(size_t i, SynapseBuffer& buffer) const
+{
+	size_t explicitBlocks = m_net.synapseBlockCount();
+	if(i < explicitBlocks) {
+		return m_net.synapseBlock(i, buffer);
+	}
+
+	nidx_t begin = m_sourceBegin + nidx_t(i - explicitBlocks) * SOURCES_PER_BLOCK;
+	nidx_t end = std::min(m_sourceEnd, begin + SOURCES_PER_BLOCK);
+
+	buffer.clear();
+	for(nidx_t source = begin; source < end; ++source) {
+		size_t first = buffer.size();
+		for(size_t r = 0; r < m_rules.size(); ++r) {
+			const Connectivity& rule = m_rules[r];
+			if(source < rule.sourceBegin() || source >= rule.sourceEnd()) {
+				continue;
+			}
+			RNG rng;
+			seedRng(m_seed, (uint64_t(r+1) << 32) | source, rng);
+			uint64_t key = (uint64_t(m_seed) << 32) | r;
+			rule.generate(source, key, rng, buffer);
+		}
+		id32_t id = m_net.outdegree(source);
+		for(size_t s = first; s < buffer.size(); ++s) {
+			buffer.id[s] = id++;
+		}
+	}
+	return buffer.block();
+}
+
+
+
+synapse_iterator
+Generator::synapse_begin() const
+{
+	return synapse_iterator(new synapse_block_iterator(*this, 0));
+}
+
+
+
+synapse_iterator
+Generator::synapse_end() const
+{
+	return synapse_iterator(
+			new synapse_block_iterator(*this, synapseBlockCount()));
+}
+
+
+
+neuron_iterator
+Generator::neuron_begin(unsigned i) const
+{
+	return m_net.neuron_begin(i);
+}
+
+
+
+neuron_iterator
+Generator::neuron_end(unsigned i) const
+{
+	return m_net.neuron_end(i);
+}
+
+
+
+unsigned
+Generator::neuronCount() const
+{
+	return m_net.neuronCount();
+}
+
+
+
+unsigned
+Generator::neuronCount(unsigned type) const
+{
+	return m_net.neuronCount(type);
+}
+
+
+
+unsigned
+Generator::maxDelay() const
+{
+	return std::max(m_net.maxDelay(), m_maxDelay);
+}
+
+
+
+unsigned
+Generator::minNeuronIndex() const
+{
+	return m_net.minNeuronIndex();
+}
+
+
+
+unsigned
+Generator::maxNeuronIndex() const
+{
+	return m_net.maxNeuronIndex();
+}
+
+
+
+unsigned
+Generator::neuronTypeCount() const
+{
+	return m_net.neuronTypeCount();
+}
+
+
+
+const NeuronType&
+Generator::neuronType(unsigned i) const
+{
+	return m_net.neuronType(i);
+}
+
+}	}	}
@@ -0,0 +1,106 @@
+#ifndef NEMO_NETWORK_PROCEDURAL_GENERATOR_HPP
+#define NEMO_NETWORK_PROCEDURAL_GENERATOR_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <nemo/config.h>
+#include <nemo/network/Generator.hpp>
+#include "Connectivity.hpp"
+
+namespace nemo {
+
+	class Network;
+
+	namespace network {
+
+		class NetworkImpl;
+
+		namespace procedural {
+
+/*! \brief Network generator with procedurally generated synapses
+ *
+ * The neurons, and any synapses added explicitly, are taken from an existing
+ * network. Further synapses are computed on demand from a set of
+ * connectivity rules, and are never stored in the network. A backend thus
+ * only holds its own copy of the synapses (in its connectivity matrix).
+ *
+ * The computed synapses are exported in blocks, each containing the
+ * synapses of a fixed-size range of source neurons. The random number
+ * generator for each rule and source is seeded from the user seed, the rule
+ * index, and the source index alone, so each block can be computed
+ * independently and in parallel, and the network is the same regardless of
+ * the order in which blocks are computed.
+ *
+ * The ids of the computed synapses of each source follow on from the ids of
+ * the synapses added explicitly to the network for the same source.
+ */
+class NEMO_BASE_DLL_PUBLIC Generator : public network::Generator
+{
+	public :
+
+		/*!
+		 * \param net
+		 * 		network containing the neurons. The network must outlive the
+		 * 		generator, and should not be modified while in use.
+		 * \param seed seed for the connectivity rules
+		 */
+		Generator(const nemo::Network& net, unsigned seed = 0);
+
+		/*! Add a connectivity rule. The generator stores a copy. */
+		void add(const Connectivity& rule);
+
+		neuron_iterator neuron_begin(unsigned i) const;
+		neuron_iterator neuron_end(unsigned i) const;
+
+		/*! \copydoc nemo::network::Generator::synapse_begin
+		 *
+		 * Each block of synapses is computed when reached, so iteration
+		 * should be avoided in favour of \a synapseBlock where possible.
+		 */
+		synapse_iterator synapse_begin() const;
+		synapse_iterator synapse_end() const;
+
+		/*! \copydoc nemo::network::Generator::synapseBlockCount */
+		size_t synapseBlockCount() const;
+
+		/*! \copydoc nemo::network::Generator::synapseBlock */
+		SynapseBlock synapseBlock(size_t i, SynapseBuffer& buffer) const;
+
+		unsigned neuronCount() const;
+		unsigned neuronCount(unsigned type) const;
+		unsigned maxDelay() const;
+		unsigned minNeuronIndex() const;
+		unsigned maxNeuronIndex() const;
+		unsigned neuronTypeCount() const;
+		const class NeuronType& neuronType(unsigned i) const;
+
+		/*! Number of source neurons in each block of computed synapses */
+		static const unsigned SOURCES_PER_BLOCK = 1024;
+
+	private :
+
+		const NetworkImpl& m_net;
+
+		unsigned m_seed;
+
+		boost::ptr_vector<Connectivity> m_rules;
+
+		/* Union of the source ranges of all rules */
+		nidx_t m_sourceBegin;
+		nidx_t m_sourceEnd;
+
+		delay_t m_maxDelay;
+};
+
+}	}	}
+
+#endif
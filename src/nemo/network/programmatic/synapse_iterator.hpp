@@ -3,34 +3,29 @@
 
 #include <typeinfo>
 #include <nemo/network/iterator.hpp>
-#include <nemo/NetworkImpl.hpp>
+#include <nemo/Synapses.hpp>
 
 namespace nemo {
 	namespace network {
 
-		class NetworkImpl;
-
 		namespace programmatic {
 
+/* Iterator over the synapses of a NetworkImpl, in insertion order. Bulk
+ * access to the same data is available via Generator::synapseBlock */
 class NEMO_BASE_DLL_PUBLIC synapse_iterator : public abstract_synapse_iterator
 {
 	public :
 
-		synapse_iterator(
-				NetworkImpl::fcm_t::const_iterator ni,
-				NetworkImpl::fcm_t::const_iterator ni_end,
-				id32_t gi,
-				id32_t gi_end) :
-			ni(ni), ni_end(ni_end), 
-			gi(gi), gi_end(gi_end) { }
+		synapse_iterator(const Synapses& synapses, size_t pos) :
+			m_synapses(synapses), m_pos(pos) { }
 
 		const value_type& operator*() const {
-			m_data = ni->second.getSynapse(ni->first, gi);
+			m_data = m_synapses.get(m_pos);
 			return m_data;
 		}
 
 		const value_type* operator->() const {
-			m_data = ni->second.getSynapse(ni->first, gi);
+			m_data = m_synapses.get(m_pos);
 			return &m_data;
 		}
 
@@ -39,18 +34,7 @@ class NEMO_BASE_DLL_PUBLIC synapse_iterator : public abstract_synapse_iterator
 		}
 
 		abstract_synapse_iterator& operator++() {
-			++gi;
-			if(gi == gi_end) {
-				++ni;
-				if(ni == ni_end) {
-					/* When reaching the end, all three iterators are at
-					 * their respective ends. Further increments leads to
-					 * undefined behaviour */
-					return *this;
-				}
-				gi = 0;
-				gi_end = ni->second.size();
-			}
+			++m_pos;
 			return *this;
 		 }
 
@@ -59,8 +43,7 @@ class NEMO_BASE_DLL_PUBLIC synapse_iterator : public abstract_synapse_iterator
 				return false;
 			}
 			const synapse_iterator& rhs = static_cast<const synapse_iterator&>(rhs_);
-			return ni == rhs.ni && ni_end == rhs.ni_end
-				&& gi == rhs.gi && gi_end == rhs.gi_end;
+			return &m_synapses == &rhs.m_synapses && m_pos == rhs.m_pos;
 		}
 
 		bool operator!=(const abstract_synapse_iterator& rhs) const {
@@ -69,10 +52,8 @@ class NEMO_BASE_DLL_PUBLIC synapse_iterator : public abstract_synapse_iterator
 
 	private :
 
-		NetworkImpl::fcm_t::const_iterator ni;
-		NetworkImpl::fcm_t::const_iterator ni_end;
-		id32_t gi;
-		id32_t gi_end;
+		const Synapses& m_synapses;
+		size_t m_pos;
 
 		mutable value_type m_data;
 };
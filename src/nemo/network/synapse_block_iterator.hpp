@@ -0,0 +1,112 @@
+#ifndef NEMO_NETWORK_SYNAPSE_BLOCK_ITERATOR_HPP
+#define NEMO_NETWORK_SYNAPSE_BLOCK_ITERATOR_HPP
+
+/* Copyright 2010 Imperial College London
+ *
+ * This file is part of NeMo.
+ *
+ * This software is licenced for non-commercial academic use under the GNU
+ * General Public Licence (GPL). You should have received a copy of this
+ * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <typeinfo>
+
+#include <nemo/network/Generator.hpp>
+#include <nemo/network/iterator.hpp>
+
+namespace nemo {
+	namespace network {
+
+/* Iterator over all synapses of a generator, in the same order as the
+ * synapse blocks, for generators whose blocks are computed or read on
+ * demand. Only one block is held at a time. */
+class NEMO_BASE_DLL_PUBLIC synapse_block_iterator : public abstract_synapse_iterator
+{
+	public :
+
+		synapse_block_iterator(const Generator& gen, size_t block) :
+			m_gen(gen), m_blockIdx(block), m_pos(0) {
+			load();
+		}
+
+		synapse_block_iterator(const synapse_block_iterator& other) :
+			abstract_synapse_iterator(),
+			m_gen(other.m_gen), m_blockIdx(other.m_blockIdx), m_pos(other.m_pos) {
+			/* The block may refer to the other iterator's buffer */
+			if(m_blockIdx < m_gen.synapseBlockCount()) {
+				m_block = m_gen.synapseBlock(m_blockIdx, m_buffer);
+			}
+		}
+
+		const value_type& operator*() const {
+			m_data = get();
+			return m_data;
+		}
+
+		const value_type* operator->() const {
+			m_data = get();
+			return &m_data;
+		}
+
+		abstract_synapse_iterator* clone() const {
+			return new synapse_block_iterator(*this);
+		}
+
+		abstract_synapse_iterator& operator++() {
+			++m_pos;
+			if(m_pos == m_block.size) {
+				++m_blockIdx;
+				m_pos = 0;
+				load();
+			}
+			return *this;
+		}
+
+		bool operator==(const abstract_synapse_iterator& rhs_) const {
+			if(typeid(*this) != typeid(rhs_)) {
+				return false;
+			}
+			const synapse_block_iterator& rhs = static_cast<const synapse_block_iterator&>(rhs_);
+			return &m_gen == &rhs.m_gen && m_blockIdx == rhs.m_blockIdx && m_pos == rhs.m_pos;
+		}
+
+		bool operator!=(const abstract_synapse_iterator& rhs) const {
+			return !(*this == rhs);
+		}
+
+	private :
+
+		const Generator& m_gen;
+
+		size_t m_blockIdx;
+		size_t m_pos;
+
+		SynapseBuffer m_buffer;
+		SynapseBlock m_block;
+
+		mutable value_type m_data;
+
+		/* Load the current block, skipping any empty blocks */
+		void load() {
+			size_t blockCount = m_gen.synapseBlockCount();
+			m_block = SynapseBlock();
+			for( ; m_blockIdx < blockCount; ++m_blockIdx) {
+				m_block = m_gen.synapseBlock(m_blockIdx, m_buffer);
+				if(m_block.size != 0) {
+					break;
+				}
+			}
+		}
+
+		Synapse get() const {
+			size_t i = m_pos;
+			return Synapse(m_block.source[i], m_block.delay[i],
+					AxonTerminal(m_block.id[i], m_block.target[i],
+						m_block.weight[i], m_block.plastic[i] != 0));
+		}
+};
+
+}	}
+
+#endif
@@ -1,21 +1,66 @@
 #include "RCM.hpp"
 
+#include <algorithm>
+
 namespace nemo {
 	namespace runtime {
 
 
-RCM::RCM(construction_t& rcm) :
-	m_warps(rcm.m_warps),
-	m_indegree(rcm.m_dataRowLength)
+/* Copy the warps of one plane of the construction-time RCM into target
+ * order. The input plane is released. */
+template<typename T>
+void
+reorderWarps(std::vector<T>& in, bool used,
+		const std::vector<const std::vector<size_t>*>& warps,
+		size_t warpCount,
+		std::vector<T>& out)
+{
+	const size_t width = RCM::WIDTH;
+	if(used && warpCount != 0) {
+		out.reserve(warpCount * width);
+		for(size_t t=0; t < warps.size(); ++t) {
+			if(warps[t] == NULL) {
+				continue;
+			}
+			for(std::vector<size_t>::const_iterator w = warps[t]->begin();
+					w != warps[t]->end(); ++w) {
+				out.insert(out.end(), in.begin() + *w * width, in.begin() + (*w+1) * width);
+			}
+		}
+	}
+	std::vector<T>().swap(in);
+}
+
+
+
+RCM::RCM(construction_t& rcm)
 {
-	/* Even if there are no connections, we still need an index if the kernel
-	 * assumes there /may/ be connections present. */
-	bool empty = rcm.synapseCount() == 0;
-
-	m_data.swap(rcm.m_data);
-	m_forward.swap(rcm.m_forward);
-	m_weights.swap(rcm.m_weights);
-	if(rcm.m_stdpEnabled && !empty) {
+	nidx_t targetCount = 0;
+	for(construction_t::warp_map::const_iterator i = rcm.m_warps.begin();
+			i != rcm.m_warps.end(); ++i) {
+		targetCount = std::max(targetCount, i->first + 1);
+	}
+
+	/* Dense index, with each target's warps placed back-to-back */
+	std::vector<const std::vector<size_t>*> warps(targetCount, NULL);
+	m_indegree.resize(targetCount, 0);
+	for(construction_t::warp_map::const_iterator i = rcm.m_warps.begin();
+			i != rcm.m_warps.end(); ++i) {
+		warps[i->first] = &i->second;
+		m_indegree[i->first] = rcm.m_dataRowLength[i->first];
+	}
+
+	m_warpOffset.resize(targetCount + 1, 0);
+	for(nidx_t t=0; t < targetCount; ++t) {
+		m_warpOffset[t+1] = m_warpOffset[t] + (warps[t] ? warps[t]->size() : 0);
+	}
+	size_t warpCount = m_warpOffset[targetCount];
+
+	reorderWarps(rcm.m_data, rcm.m_useData, warps, warpCount, m_data);
+	reorderWarps(rcm.m_forward, rcm.m_useForward, warps, warpCount, m_forward);
+	reorderWarps(rcm.m_weights, rcm.m_useWeights, warps, warpCount, m_weights);
+
+	if(rcm.m_stdpEnabled && warpCount != 0) {
 		m_accumulator.resize(m_data.size(), 0U);
 	}
 }
@@ -30,19 +75,18 @@ RCM::clearAccumulator()
 
 
 
-const std::vector<size_t>&
-RCM::warps(nidx_t target) const
+size_t
+RCM::warp_begin(nidx_t target) const
 {
-	return m_warps.at(target);
+	return target < m_indegree.size() ? m_warpOffset[target] : 0;
 }
 
 
 
-unsigned
-RCM::indegree(nidx_t target) const
+size_t
+RCM::warp_end(nidx_t target) const
 {
-	boost::unordered_map<nidx_t, unsigned>::const_iterator i = m_indegree.find(target);
-	return (i == m_indegree.end()) ? 0 : i->second;
+	return target < m_indegree.size() ? m_warpOffset[target+1] : 0;
 }
 
 
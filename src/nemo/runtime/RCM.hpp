@@ -10,7 +10,8 @@
  * licence along with nemo. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <boost/unordered_map.hpp>
+#include <vector>
+
 #include <nemo/construction/RCM.hpp>
 #include <nemo/types.hpp>
 
@@ -22,20 +23,22 @@ namespace nemo {
 
 	namespace runtime {
 
+/*! \brief Run-time reverse connectivity matrix for the CPU backend
+ *
+ * The warps of each target neuron are stored contiguously, in order of
+ * target index, and are found via a dense per-target index. The incoming
+ * synapses of target \a t are thus the first \a indegree(t) entries starting
+ * at warp \a warp_begin(t), and different threads can process disjoint
+ * ranges of targets without any shared lookup structure.
+ */
 class NEMO_BASE_DLL_PUBLIC RCM
 {
-	private :
-
-		typedef boost::unordered_map<nidx_t, std::vector<size_t> > warp_map;
-
 	public :
 
 		enum { WIDTH = 32 };
 
 		typedef nemo::construction::RCM<nidx_t, RSynapse, WIDTH> construction_t;
 
-		typedef warp_map::const_iterator warp_iterator;
-
 		/*! Create a runtime RCM 
 		 *
 		 * The data in the constrution-time RCM are freed as a side effect. In
@@ -46,17 +49,20 @@ class NEMO_BASE_DLL_PUBLIC RCM
 		/*! Set accumulator field to all zero */
 		void clearAccumulator();
 
-		/*! \return iterator to beginning of all warp indices */
-		warp_iterator warp_begin() const { return m_warps.begin(); }
+		/*! \return number of entries in the per-target index, i.e. one
+		 * more than the largest target with incoming synapses */
+		nidx_t targetCount() const { return nidx_t(m_indegree.size()); }
 
-		/*! \return iterator to end of all warp indices */
-		warp_iterator warp_end() const { return m_warps.end(); }
+		/*! \return index of the first warp of a specific target neuron */
+		size_t warp_begin(nidx_t target) const;
 
-		/*! \return reference to the warps of a specific target neuron */
-		const std::vector<size_t>& warps(nidx_t target) const;
+		/*! \return index beyond the last warp of a specific target neuron */
+		size_t warp_end(nidx_t target) const;
 
 		/*! \return number of incoming synapses for the given target neuron */
-		unsigned indegree(nidx_t target) const;
+		unsigned indegree(nidx_t target) const {
+			return target < m_indegree.size() ? m_indegree[target] : 0;
+		}
 
 		/*! \return a single warp of reverse synape data */
 		const RSynapse* data(size_t warp) const;
@@ -72,9 +78,10 @@ class NEMO_BASE_DLL_PUBLIC RCM
 
 	private :
 
-		warp_map m_warps;
+		/*! Warps of target t are [m_warpOffset[t], m_warpOffset[t+1]) */
+		std::vector<size_t> m_warpOffset;
 
-		boost::unordered_map<nidx_t, unsigned> m_indegree;
+		std::vector<unsigned> m_indegree;
 
 		/*! Main reverse synapse data: source partition, source neuron, delay */
 		std::vector<RSynapse> m_data;
@@ -66,6 +66,28 @@ enum {
 };
 
 typedef unsigned backend_t;
+
+/*! Spike delivery engines for the CPU backend */
+enum {
+	/*! Source-driven delivery via the forward connectivity matrix */
+	NEMO_CPU_DELIVERY_PUSH,
+	/*! Target-driven delivery via per-target incoming synapses */
+	NEMO_CPU_DELIVERY_PULL,
+	/*! Source-driven scatter into a circular buffer of delayed current */
+	NEMO_CPU_DELIVERY_RING
+};
+
+typedef unsigned cpu_delivery_t;
+
+/*! Random number generators for neuron noise on the CPU backend */
+enum {
+	/*! Stateful xorshift generator for each neuron */
+	NEMO_CPU_RNG_XORSHIFT,
+	/*! Counter-based Philox generator, keyed on neuron and cycle */
+	NEMO_CPU_RNG_PHILOX
+};
+
+typedef unsigned cpu_rng_t;
 typedef unsigned long long cycle_t;
 
 typedef uint64_t synapse_id;
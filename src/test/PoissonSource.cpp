@@ -22,7 +22,7 @@ testRate(backend_t backend, unsigned duration, bool otherNeurons)
 		nfired += fired.size();
 	}
 	unsigned expected = unsigned(fabsf(float(duration)*rate));
-	unsigned deviation = nfired - expected;
+	unsigned deviation = nfired > expected ? nfired - expected : expected - nfired;
 	//! \todo use a proper statistical test over a large number of runs
 	BOOST_REQUIRE(nfired > 0);
 	BOOST_REQUIRE(deviation < expected * 2);
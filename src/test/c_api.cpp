@@ -7,6 +7,7 @@
  * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdio>
 #include <utility>
 #include <boost/random.hpp>
 #include <boost/test/unit_test.hpp>
@@ -601,4 +602,289 @@ testGetSynapses(backend_t backend, unsigned n0)
 
 
 
+/*! Firing read in blocks using nemo_run should be the same as when using
+ * nemo_step, also with stimulus */
+void
+testRun(backend_t backend)
+{
+	nemo_network_t net = c_safeAlloc(nemo_new_network());
+
+	/* Noisy neurons, with sparse random connectivity */
+	rng_t rng;
+	uirng_t randomTarget(rng, boost::uniform_int<>(0, 999));
+	for(unsigned n = 0; n < 1000; ++n) {
+		c_safeCall(nemo_add_neuron_iz(net, n, 0.02f, 0.2f, -65.0f, 8.0f, -13.0f, -65.0f, 5.0f));
+		for(unsigned s = 0; s < 50; ++s) {
+			c_safeCall(nemo_add_synapse(net, n, randomTarget(), 1 + s%20, 1.0f, 0, NULL));
+		}
+	}
+
+	nemo_configuration_t conf = c_safeAlloc(nemo_new_configuration());
+	setBackend(conf, backend);
+	nemo_simulation_t sim1 = c_safeAlloc(nemo_new_simulation(net, conf));
+	nemo_simulation_t sim2 = c_safeAlloc(nemo_new_simulation(net, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+
+	/* Firing stimulus during cycle 10, current stimulus during cycle 300 */
+	unsigned fstim_nidx[] = { 100, 200 };
+	unsigned istim_nidx[] = { 20, 40 };
+	float istim_current[] = { 20.0f, 20.0f };
+
+	unsigned duration = 1000;
+	for(unsigned ms = 0; ms < duration; ++ms) {
+		unsigned* fired;
+		size_t fired_len;
+		c_safeCall(nemo_step(sim1,
+				fstim_nidx, ms == 10 ? 2 : 0,
+				istim_nidx, istim_current, ms == 300 ? 2 : 0,
+				&fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired_len, ms);
+	}
+
+	unsigned block = 250;
+	for(unsigned ms = 0; ms < duration; ms += block) {
+		uint64_t* cycles;
+		unsigned* fired;
+		size_t fired_len;
+		uint64_t* offsets;
+		/* Stimulus is keyed by the step within each block */
+		unsigned fstim_step[] = { 10, 10 };
+		unsigned istim_step[] = { 50, 50 };
+		c_safeCall(nemo_run(sim2, block,
+				fstim_step, fstim_nidx, ms == 0 ? 2 : 0,
+				istim_step, istim_nidx, istim_current, ms == 250 ? 2 : 0,
+				&cycles, &fired, &fired_len, &offsets));
+		BOOST_REQUIRE_EQUAL(offsets[0], 0U);
+		BOOST_REQUIRE_EQUAL(offsets[block], fired_len);
+		std::copy(fired, fired + fired_len, back_inserter(nidx2));
+		std::copy(cycles, cycles + fired_len, back_inserter(cycles2));
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	nemo_delete_simulation(sim1);
+	nemo_delete_simulation(sim2);
+	nemo_delete_configuration(conf);
+	nemo_delete_network(net);
+}
+
+
+
+/*! Dense current stimulus via nemo_step_dense should be the same as the
+ * equivalent sparse stimulus via nemo_step */
+void
+testDenseCurrentStimulus(backend_t backend)
+{
+	unsigned ncount = 1000;
+	nemo_network_t net = c_safeAlloc(nemo_new_network());
+	for(unsigned n = 0; n < ncount; ++n) {
+		c_safeCall(nemo_add_neuron_iz(net, n, 0.02f, 0.2f, -65.0f, 8.0f, 0.0f, -65.0f, 0.0f));
+	}
+
+	nemo_configuration_t conf = c_safeAlloc(nemo_new_configuration());
+	setBackend(conf, backend);
+	nemo_simulation_t sim1 = c_safeAlloc(nemo_new_simulation(net, conf));
+	nemo_simulation_t sim2 = c_safeAlloc(nemo_new_simulation(net, conf));
+
+	rng_t rng;
+	urng_t random(rng, boost::uniform_real<double>(0, 1));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	std::vector<unsigned> istim_nidx(ncount);
+	std::vector<float> istim_current(ncount);
+
+	for(unsigned ms = 0; ms < 500; ++ms) {
+		for(unsigned n = 0; n < ncount; ++n) {
+			istim_nidx[n] = n;
+			istim_current[n] = random() < 0.05 ? float(random() * 25.0) : 0.0f;
+		}
+
+		unsigned* fired;
+		size_t fired_len;
+		c_safeCall(nemo_step(sim1, NULL, 0,
+				&istim_nidx[0], &istim_current[0], ncount,
+				&fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired_len, ms);
+
+		c_safeCall(nemo_step_dense(sim2, NULL, 0,
+				&istim_current[0], ncount,
+				&fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired_len, ms);
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	/* Current vector of the wrong size */
+	BOOST_REQUIRE_NE(nemo_step_dense(sim2, NULL, 0, &istim_current[0], ncount-1, NULL, NULL), NEMO_OK);
+
+	nemo_delete_simulation(sim1);
+	nemo_delete_simulation(sim2);
+	nemo_delete_configuration(conf);
+	nemo_delete_network(net);
+}
+
+
+
+/*! Networks constructed using the bulk functions should be the same as
+ * networks constructed one neuron or synapse at a time */
+void
+testBulkConstruction(backend_t backend)
+{
+	const unsigned ncount = 1000;
+	const unsigned scount = 100;
+
+	rng_t rng;
+	urng_t random(rng, boost::uniform_real<double>(0, 1));
+
+	/* Izhikevich parameters and state, one array per argument */
+	std::vector<unsigned> idx(ncount);
+	std::vector< std::vector<float> > args(7, std::vector<float>(ncount));
+	for(unsigned n = 0; n < ncount; ++n) {
+		float r = float(random());
+		bool excitatory = n < ncount * 4 / 5;
+		idx[n] = n;
+		args[0][n] = excitatory ? 0.02f : 0.02f + 0.08f * r;
+		args[1][n] = excitatory ? 0.2f : 0.25f - 0.05f * r;
+		args[2][n] = excitatory ? -65.0f + 15.0f * r * r : -65.0f;
+		args[3][n] = excitatory ? 8.0f - 6.0f * r * r : 2.0f;
+		args[4][n] = excitatory ? 5.0f : 2.0f;
+		args[5][n] = args[1][n] * -65.0f;
+		args[6][n] = -65.0f;
+	}
+
+	std::vector<unsigned> sources, targets, delays;
+	std::vector<float> weights;
+	std::vector<unsigned char> plastic;
+	for(unsigned n = 0; n < ncount; ++n) {
+		for(unsigned s = 0; s < scount; ++s) {
+			sources.push_back(n);
+			targets.push_back(unsigned(random() * ncount) % ncount);
+			delays.push_back(1 + unsigned(random() * 20) % 20);
+			weights.push_back(n < ncount * 4 / 5 ? 0.5f * float(random()) : -float(random()));
+			plastic.push_back(0);
+		}
+	}
+	size_t synapseCount = sources.size();
+
+	nemo_network_t net1 = c_safeAlloc(nemo_new_network());
+	nemo_network_t net2 = c_safeAlloc(nemo_new_network());
+	unsigned type1, type2;
+	c_safeCall(nemo_add_neuron_type(net1, "Izhikevich", &type1));
+	c_safeCall(nemo_add_neuron_type(net2, "Izhikevich", &type2));
+
+	float nargs[7];
+	for(unsigned n = 0; n < ncount; ++n) {
+		for(unsigned a = 0; a < 7; ++a) {
+			nargs[a] = args[a][n];
+		}
+		c_safeCall(nemo_add_neuron(net1, type1, idx[n], 7, nargs));
+	}
+	float* argv[7];
+	for(unsigned a = 0; a < 7; ++a) {
+		argv[a] = &args[a][0];
+	}
+	c_safeCall(nemo_add_neurons(net2, type2, &idx[0], ncount, 7, argv));
+
+	std::vector<synapse_id> ids1(synapseCount), ids2(synapseCount);
+	for(size_t s = 0; s < synapseCount; ++s) {
+		c_safeCall(nemo_add_synapse(net1, sources[s], targets[s], delays[s],
+					weights[s], plastic[s], &ids1[s]));
+	}
+	c_safeCall(nemo_add_synapses(net2, &sources[0], &targets[0], &delays[0],
+				&weights[0], &plastic[0], synapseCount, &ids2[0]));
+	BOOST_REQUIRE(ids1 == ids2);
+
+	/* Invalid input is rejected */
+	unsigned badDelay = 0;
+	BOOST_REQUIRE_NE(nemo_add_synapses(net2, &sources[0], &targets[0], &badDelay,
+				&weights[0], &plastic[0], 1, NULL), NEMO_OK);
+	BOOST_REQUIRE_NE(nemo_add_neurons(net2, type2, &idx[0], 1, 6, argv), NEMO_OK);
+
+	nemo_configuration_t conf = c_safeAlloc(nemo_new_configuration());
+	setBackend(conf, backend);
+	nemo_simulation_t sim1 = c_safeAlloc(nemo_new_simulation(net1, conf));
+	nemo_simulation_t sim2 = c_safeAlloc(nemo_new_simulation(net2, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	for(unsigned ms = 0; ms < 500; ++ms) {
+		unsigned* fired;
+		size_t fired_len;
+		c_safeCall(nemo_step(sim1, NULL, 0, NULL, NULL, 0, &fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired_len, ms);
+		c_safeCall(nemo_step(sim2, NULL, 0, NULL, NULL, 0, &fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired_len, ms);
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	nemo_delete_simulation(sim1);
+	nemo_delete_simulation(sim2);
+	nemo_delete_configuration(conf);
+	nemo_delete_network(net1);
+	nemo_delete_network(net2);
+}
+
+
+
+/*! A simulation created from a saved network file should be the same as one
+ * created from the network itself */
+void
+testSaveAndLoad(backend_t backend)
+{
+	const char* filename = "test-c-api.nemo";
+
+	nemo_network_t net = c_safeAlloc(nemo_new_network());
+	rng_t rng;
+	uirng_t randomTarget(rng, boost::uniform_int<>(0, 999));
+	for(unsigned n = 0; n < 1000; ++n) {
+		c_safeCall(nemo_add_neuron_iz(net, n, 0.02f, 0.2f, -65.0f, 8.0f, -13.0f, -65.0f, 5.0f));
+		for(unsigned s = 0; s < 50; ++s) {
+			c_safeCall(nemo_add_synapse(net, n, randomTarget(), 1 + s%20, 1.0f, 0, NULL));
+		}
+	}
+	c_safeCall(nemo_save_network(net, filename));
+
+	nemo_configuration_t conf = c_safeAlloc(nemo_new_configuration());
+	setBackend(conf, backend);
+	nemo_simulation_t sim1 = c_safeAlloc(nemo_new_simulation(net, conf));
+	nemo_simulation_t sim2 = c_safeAlloc(nemo_new_simulation_from_file(filename, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	for(unsigned ms = 0; ms < 1000; ++ms) {
+		unsigned* fired;
+		size_t fired_len;
+		c_safeCall(nemo_step(sim1, NULL, 0, NULL, NULL, 0, &fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired_len, ms);
+		c_safeCall(nemo_step(sim2, NULL, 0, NULL, NULL, 0, &fired, &fired_len));
+		std::copy(fired, fired + fired_len, back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired_len, ms);
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	/* Missing files and empty networks are rejected */
+	BOOST_REQUIRE(nemo_new_simulation_from_file("no-such-file.nemo", conf) == NULL);
+	nemo_network_t empty = c_safeAlloc(nemo_new_network());
+	BOOST_REQUIRE_NE(nemo_save_network(empty, filename), NEMO_OK);
+
+	nemo_delete_simulation(sim1);
+	nemo_delete_simulation(sim2);
+	nemo_delete_configuration(conf);
+	nemo_delete_network(empty);
+	nemo_delete_network(net);
+	std::remove(filename);
+}
+
+
 }	}	}
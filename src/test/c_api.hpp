@@ -18,6 +18,10 @@ void compareWithCpp(bool useFstim, bool useIstim);
 void testSynapseId();
 void testSetNeuron();
 void testGetSynapses(backend_t, unsigned n0);
+void testRun(backend_t);
+void testDenseCurrentStimulus(backend_t);
+void testBulkConstruction(backend_t);
+void testSaveAndLoad(backend_t);
 
 }	}	}
 
@@ -15,6 +15,9 @@
 #include <boost/test/unit_test.hpp>
 
 #include <nemo.hpp>
+#include <nemo/StdpFunction.hpp>
+#include <nemo/StdpProcess.hpp>
+#include <nemo/fixedpoint.hpp>
 #include "utils.hpp"
 
 /* The test network consists of two groups of the same size. Connections
@@ -327,7 +330,9 @@ testInvalidStaticLength()
 
 
 
-/* Too long STDP window (considering max network delay) should throw */
+/* Too long STDP window (considering max network delay) should throw. The CPU
+ * backend keeps a firing history covering the maximum delay, so this only
+ * applies to the CUDA backend */
 void
 testInvalidDynamicLength(bool stdp)
 {
@@ -347,9 +352,43 @@ testInvalidDynamicLength(bool stdp)
 
 	boost::scoped_ptr<nemo::Simulation> sim;
 
-	if(stdp) {
+	if(stdp && conf.backend() == NEMO_BACKEND_CUDA) {
 		BOOST_REQUIRE_THROW(sim.reset(nemo::simulation(net, conf)), nemo::exception);
 	} else {
 		BOOST_REQUIRE_NO_THROW(sim.reset(nemo::simulation(net, conf)));
 	}
 }
+
+
+
+/* The bulk weight update used by the CPU backend should agree with the
+ * single-synapse update, including at the limits and for weights which
+ * change sign. */
+void
+testBulkWeightUpdate()
+{
+	const unsigned fbits = 20;
+	std::vector<float> window(3, 0.1f);
+	nemo::StdpFunction fn(window, window, 0.5f, 10.0f, -0.5f, -10.0f);
+	nemo::StdpProcess stdp(fn, fbits);
+
+	const float w[] = { 0.0f, 0.6f, 9.9f, 10.0f, 3.0f, -0.6f, -9.9f, -10.0f, -3.0f };
+	const float d[] = { -2.0f, -0.5f, 0.0f, 0.2f, 5.0f, -8.0f };
+	const unsigned nw = sizeof(w) / sizeof(float);
+	const unsigned nd = sizeof(d) / sizeof(float);
+
+	std::vector<fix_t> w_old, w_diff;
+	for(unsigned i=0; i < nw; ++i) {
+		for(unsigned j=0; j < nd; ++j) {
+			w_old.push_back(fx_toFix(w[i], fbits));
+			w_diff.push_back(fx_toFix(d[j], fbits));
+		}
+	}
+
+	std::vector<fix_t> w_new(w_old.size());
+	stdp.updatedWeights(w_old.size(), &w_old[0], &w_diff[0], &w_new[0]);
+	for(unsigned i=0; i < w_old.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(w_new[i], stdp.updatedWeight(w_old[i], w_diff[i]));
+	}
+}
+
@@ -9,10 +9,17 @@
  * licence along with NeMo. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <ctime>
+#include <fstream>
 #include <iostream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include <boost/math/special_functions/fpclassify.hpp> // isnan
 #include <boost/test/unit_test.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -20,6 +27,11 @@
 
 #include <nemo.hpp>
 #include <nemo/fixedpoint.hpp>
+#include <nemo/RandomMapper.hpp>
+#include <nemo/RNG.hpp>
+#include <nemo/network/mapped/Generator.hpp>
+#include <nemo/network/mapped/write.hpp>
+#include <nemo/network/procedural/Generator.hpp>
 #include <examples.hpp>
 
 #include "test.hpp"
@@ -289,21 +301,442 @@ testInvalidCurrentStimulus(backend_t backend)
 
 
 
+/* Dense current stimulus should have the same effect as the equivalent sparse
+ * stimulus. The neuron indices are not contigous, so the dense vector is
+ * indexed differently from the network. */
+void
+testDenseCurrentStimulus(backend_t backend)
+{
+	unsigned ncount = 1000;
+	nemo::Configuration conf = configuration(false, 1024, backend);
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		/* Add in reverse order so that neuron index and insertion order
+		 * differ as well */
+		addExcitatoryNeuron(1000 + 3 * (ncount-n-1), net);
+	}
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(net, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+
+	rng_t rng;
+	urng_t random(rng, boost::uniform_real<double>(0, 1));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+
+	for(unsigned ms=0; ms < 500; ++ms) {
+		nemo::Simulation::current_stimulus sparse;
+		nemo::Simulation::dense_current_stimulus dense(ncount, 0.0f);
+		for(unsigned n=0; n < ncount; ++n) {
+			if(random() < 0.05) {
+				float current = float(random() * 25.0);
+				sparse.push_back(std::make_pair(1000 + 3 * n, current));
+				dense[n] = current;
+			}
+		}
+		const std::vector<unsigned>& fired1 = sim1->step(sparse);
+		std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+		std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+		/* Alternate between the forms with and without firing stimulus */
+		const std::vector<unsigned>& fired2 = ms % 2
+			? sim2->step(nemo::Simulation::firing_stimulus(), dense)
+			: sim2->step(dense);
+		std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+		std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	/* An empty vector means no input */
+	sim2->step(nemo::Simulation::dense_current_stimulus());
+
+	BOOST_REQUIRE_THROW(sim2->step(nemo::Simulation::dense_current_stimulus(ncount-1, 1.0f)), nemo::exception);
+}
+
+
+
 BOOST_AUTO_TEST_SUITE(istim)
 	TEST_ALL_BACKENDS(single_injection, testCurrentStimulus)
 	TEST_ALL_BACKENDS(invalid_injection, testInvalidCurrentStimulus)
+	TEST_ALL_BACKENDS(dense, testDenseCurrentStimulus)
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+/* User-defined generator with per-target state: a linear ramp */
+class RampInput : public nemo::InputGenerator
+{
+	public :
+
+		nemo::InputGenerator* clone() const { return new RampInput(*this); }
+
+		unsigned stateCount() const { return 1; }
+
+		void initState(float state[]) const { state[0] = 0.0f; }
+
+		float current(unsigned long, float state[], RNG*) const {
+			state[0] += 0.02f;
+			return state[0];
+		}
+};
+
+
+
+/* Input generators should have the same effect as providing the same current
+ * explicitly in each step */
+void
+testInputGenerators()
+{
+	unsigned ncount = 1000;
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, net);
+	}
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(net, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+
+	nemo::SinusoidalInput sinusoid(10.0f, 20.0f, 0.5f, 2.0f);
+	std::vector<unsigned> half;
+	for(unsigned n=0; n < ncount; n += 2) {
+		half.push_back(n);
+	}
+	std::vector<unsigned> all;
+	for(unsigned n=0; n < ncount; ++n) {
+		all.push_back(n);
+	}
+	sim1->addInputGenerator(sinusoid, half);
+	sim1->addInputGenerator(RampInput(), all);
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	float ramp = 0.0f;
+
+	for(unsigned ms=0; ms < 500; ++ms) {
+		const std::vector<unsigned>& fired1 = sim1->step();
+		std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+		std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+
+		ramp += 0.02f;
+		float s = sinusoid.current(ms, NULL, NULL);
+		nemo::Simulation::current_stimulus istim;
+		for(unsigned n=0; n < ncount; ++n) {
+			istim.push_back(std::make_pair(n, n % 2 ? ramp : s + ramp));
+		}
+		const std::vector<unsigned>& fired2 = sim2->step(istim);
+		std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+		std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+}
+
+
+
+/* Poisson input should drive firing at roughly the input rate, and the
+ * result should not depend on anything but the network and generators */
+void
+testPoissonInput()
+{
+	unsigned ncount = 1000;
+	unsigned duration = 1000;
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, net);
+	}
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(net, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+
+	std::vector<unsigned> all;
+	for(unsigned n=0; n < ncount; ++n) {
+		all.push_back(n);
+	}
+	/* Each pulse is strong enough to cause firing */
+	nemo::PoissonInput poisson(20.0f, 1000.0f);
+	sim1->addInputGenerator(poisson, all);
+	sim2->addInputGenerator(poisson, all);
+
+	const nemo::Simulation::firing_record& record1 = sim1->run(duration);
+	std::vector<unsigned> cycles1(record1.cycles.begin(), record1.cycles.end());
+	std::vector<unsigned> nidx1(record1.neurons);
+	const nemo::Simulation::firing_record& record2 = sim2->run(duration);
+	std::vector<unsigned> cycles2(record2.cycles.begin(), record2.cycles.end());
+	std::vector<unsigned> nidx2(record2.neurons);
+
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	/* 20Hz, less a bit due to the refractory period */
+	double rate = double(nidx1.size()) / ncount / (duration / 1000.0);
+	BOOST_CHECK_GT(rate, 15.0);
+	BOOST_CHECK_LT(rate, 22.0);
+}
+
+
+
+/* Check the statistics of the built-in stochastic generators directly */
+void
+testStochasticGenerators()
+{
+	RNG rng;
+	nemo::seedRng(1234, rng);
+	unsigned nsamples = 100000;
+
+	nemo::OrnsteinUhlenbeckInput ou(5.0f, 2.0f, 10.0f);
+	BOOST_REQUIRE_EQUAL(ou.stateCount(), 1U);
+	float x;
+	ou.initState(&x);
+	BOOST_REQUIRE_EQUAL(x, 5.0f);
+	double sum = 0.0;
+	double sum2 = 0.0;
+	for(unsigned i=0; i < nsamples; ++i) {
+		double c = ou.current(i, &x, &rng);
+		sum += c;
+		sum2 += c * c;
+	}
+	double mean = sum / nsamples;
+	double sd = std::sqrt(sum2 / nsamples - mean * mean);
+	BOOST_CHECK_CLOSE(mean, 5.0, 4.0);
+	BOOST_CHECK_CLOSE(sd, 2.0, 10.0);
+
+	/* Rate-modulated Poisson input has the same mean rate */
+	nemo::PoissonInput poisson(50.0f, 3.0f, 1.0f, 10.0f);
+	unsigned pulses = 0;
+	for(unsigned i=0; i < nsamples; ++i) {
+		float c = poisson.current(i, NULL, &rng);
+		BOOST_REQUIRE(c == 0.0f || c == 3.0f);
+		pulses += c != 0.0f;
+	}
+	BOOST_CHECK_CLOSE(double(pulses) / nsamples, 0.05, 10.0);
+
+	BOOST_REQUIRE_THROW(nemo::OrnsteinUhlenbeckInput(0.0f, 1.0f, 0.0f), nemo::exception);
+	BOOST_REQUIRE_THROW(nemo::PoissonInput(10.0f, 1.0f, 2.0f), nemo::exception);
+}
+
+
+
+/* Records the RNG state passed to it for its (single) target neuron */
+class RngCaptureInput : public nemo::InputGenerator
+{
+	public :
+
+		explicit RngCaptureInput(RNG* out) : m_out(out) { }
+
+		nemo::InputGenerator* clone() const { return new RngCaptureInput(*this); }
+
+		float current(unsigned long cycle, float[], RNG* rng) const {
+			if(cycle == 0) {
+				*m_out = *rng;
+			}
+			return 0.0f;
+		}
+
+	private :
+
+		RNG* m_out;
+};
+
+
+
+bool
+sameRng(const RNG& a, const RNG& b)
+{
+	return std::equal(a.state, a.state + 4, b.state);
+}
+
+
+
+/* The random stream of an input generator should be unrelated to the
+ * intrinsic noise stream of its target neuron, and to the streams of other
+ * generators for the same neuron */
+void
+testInputGeneratorRngIndependence()
+{
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	conf.setRngSeed(17);
+	nemo::Network net;
+	for(unsigned n=0; n < 10; ++n) {
+		addExcitatoryNeuron(n, net);
+	}
+
+	for(unsigned n=0; n < 10; n += 3) {
+		boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+		RNG first, second;
+		std::vector<unsigned> target(1, n);
+		sim->addInputGenerator(RngCaptureInput(&first), target);
+		sim->addInputGenerator(RngCaptureInput(&second), target);
+		sim->step();
+
+		RNG own;
+		nemo::seedRng(conf.rngSeed(), n, own);
+		BOOST_REQUIRE(!sameRng(first, own));
+		BOOST_REQUIRE(!sameRng(second, own));
+		BOOST_REQUIRE(!sameRng(first, second));
+	}
+}
+
+
+
+void
+testInvalidInputGenerator()
+{
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Network> net(createRing(100));
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(*net, conf));
+
+	std::vector<unsigned> repeated(2, 10);
+	BOOST_REQUIRE_THROW(sim->addInputGenerator(nemo::SinusoidalInput(1.0f, 1.0f), repeated), nemo::exception);
+
+	std::vector<unsigned> invalid(1, 100);
+	BOOST_REQUIRE_THROW(sim->addInputGenerator(nemo::SinusoidalInput(1.0f, 1.0f), invalid), nemo::exception);
+}
+
+
+
+BOOST_AUTO_TEST_SUITE(input_generators)
+	BOOST_AUTO_TEST_CASE(explicit_equivalence) { testInputGenerators(); }
+	BOOST_AUTO_TEST_CASE(poisson) { testPoissonInput(); }
+	BOOST_AUTO_TEST_CASE(stochastic) { testStochasticGenerators(); }
+	BOOST_AUTO_TEST_CASE(rng_independence) { testInputGeneratorRngIndependence(); }
+	BOOST_AUTO_TEST_CASE(invalid) { testInvalidInputGenerator(); }
 BOOST_AUTO_TEST_SUITE_END()
 
 
 
+/* Running several cycles at a time should produce the same firing as
+ * stepping through the simulation one cycle at a time */
+void
+testRun(backend_t backend)
+{
+	nemo::Configuration conf = configuration(false, 1024, backend);
+
+	/* Noisy neurons, with sparse random connectivity */
+	nemo::Network net;
+	rng_t rng;
+	uirng_t randomTarget(rng, boost::uniform_int<>(0, 999));
+	for(unsigned n=0; n < 1000; ++n) {
+		addExcitatoryNeuron(n, net, 5.0f);
+		for(unsigned s=0; s < 50; ++s) {
+			net.addSynapse(n, randomTarget(), 1 + s%20, 1.0f, false);
+		}
+	}
+
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(net, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+
+	unsigned duration = 1000;
+	for(unsigned ms=0; ms < duration; ++ms) {
+		const std::vector<unsigned>& fired = sim1->step();
+		std::fill_n(back_inserter(cycles1), fired.size(), ms);
+		std::copy(fired.begin(), fired.end(), back_inserter(nidx1));
+	}
+
+	/* Vary the block size, including empty blocks */
+	unsigned blocks[] = { 1, 0, 299, 700 };
+	unsigned cycle = 0;
+	for(unsigned b=0; b < 4; ++b) {
+		const nemo::Simulation::firing_record& record = sim2->run(blocks[b]);
+		BOOST_REQUIRE_EQUAL(record.offsets.size(), blocks[b] + 1);
+		BOOST_REQUIRE_EQUAL(record.offsets.back(), record.neurons.size());
+		BOOST_REQUIRE_EQUAL(record.cycles.size(), record.neurons.size());
+		for(unsigned i=0; i < blocks[b]; ++i, ++cycle) {
+			for(uint64_t f = record.offsets[i]; f < record.offsets[i+1]; ++f) {
+				BOOST_REQUIRE_EQUAL(record.cycles[f], cycle);
+			}
+		}
+		std::copy(record.cycles.begin(), record.cycles.end(), back_inserter(cycles2));
+		std::copy(record.neurons.begin(), record.neurons.end(), back_inserter(nidx2));
+	}
+
+	BOOST_REQUIRE_EQUAL(sim2->elapsedSimulation(), duration);
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+}
+
+
+TEST_ALL_BACKENDS(run, testRun)
+
+
+
+/* Scheduled stimulus should have the same effect as stimulus provided in
+ * individual calls to step */
+void
+testRunSchedule(backend_t backend)
+{
+	unsigned ncount = 1000;
+	nemo::Configuration conf = configuration(false, 1024, backend);
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, net);
+	}
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(net, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+
+	rng_t rng;
+	urng_t random(rng, boost::uniform_real<double>(0, 1));
+
+	unsigned duration = 500;
+	unsigned block = 100;
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	std::vector<nemo::Simulation::stimulus_schedule> schedules(duration / block);
+
+	for(unsigned ms=0; ms < duration; ++ms) {
+		nemo::Simulation::firing_stimulus fstim;
+		nemo::Simulation::current_stimulus istim;
+		nemo::Simulation::stimulus_schedule& schedule = schedules[ms / block];
+		for(unsigned n=0; n < ncount; ++n) {
+			double r = random();
+			if(r < 0.005) {
+				fstim.push_back(n);
+				schedule.addFiring(ms % block, n);
+			} else if(r < 0.01) {
+				istim.push_back(std::make_pair(n, 20.0f));
+				schedule.addCurrent(ms % block, n, 20.0f);
+			}
+		}
+		const std::vector<unsigned>& fired = sim1->step(fstim, istim);
+		std::fill_n(back_inserter(cycles1), fired.size(), ms);
+		std::copy(fired.begin(), fired.end(), back_inserter(nidx1));
+	}
+
+	for(unsigned b=0; b < schedules.size(); ++b) {
+		const nemo::Simulation::firing_record& record = sim2->run(block, schedules[b]);
+		std::copy(record.cycles.begin(), record.cycles.end(), back_inserter(cycles2));
+		std::copy(record.neurons.begin(), record.neurons.end(), back_inserter(nidx2));
+	}
+
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	/* Stimulus outside the run */
+	nemo::Simulation::stimulus_schedule late;
+	late.addFiring(block, 0);
+	BOOST_REQUIRE_THROW(sim2->run(block, late), nemo::exception);
+
+	/* Stimulus out of order */
+	nemo::Simulation::stimulus_schedule unordered;
+	unordered.addCurrent(2, 0, 1.0f);
+	unordered.addCurrent(1, 0, 1.0f);
+	BOOST_REQUIRE_THROW(sim2->run(block, unordered), nemo::exception);
+}
+
+
+TEST_ALL_BACKENDS(run_schedule, testRunSchedule)
+
+
+
 void
-runRing(backend_t backend, unsigned ncount, unsigned delay)
+runRing(backend_t backend, unsigned ncount, unsigned delay,
+		cpu_delivery_t engine=NEMO_CPU_DELIVERY_PUSH)
 {
 	/* Make sure we go around the ring at least a couple of times */
 	const unsigned duration = ncount * 5 / 2;
 
 	nemo::Configuration conf = configuration(false, 1024);
 	setBackend(backend, conf);
+	conf.setCpuDeliveryEngine(engine);
 	boost::scoped_ptr<nemo::Network> net(createRing(ncount, 0, false, 1, delay));
 	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(*net, conf));
 
@@ -556,6 +989,64 @@ BOOST_AUTO_TEST_SUITE_END()
 
 
 
+/* Insert n neurons with global indices n0, n0+step, ... and verify the
+ * mapping in both directions */
+void
+testMapper(nemo::RandomMapper<nidx_t>& mapper, unsigned n0, unsigned step, unsigned n)
+{
+	for(unsigned l=0; l < n; ++l) {
+		mapper.insert(n0 + l*step, l);
+	}
+	for(unsigned l=0; l < n; ++l) {
+		BOOST_REQUIRE_EQUAL(mapper.localIdx(n0 + l*step), l);
+		BOOST_REQUIRE_EQUAL(mapper.globalIdx(l), n0 + l*step);
+	}
+	BOOST_REQUIRE_EQUAL(mapper.minGlobalIdx(), n0);
+	BOOST_REQUIRE_EQUAL(mapper.maxGlobalIdx(), n0 + (n-1)*step);
+	BOOST_REQUIRE_EQUAL(mapper.maxLocalIdx(), n-1);
+	BOOST_REQUIRE(!mapper.existingLocal(n));
+	BOOST_REQUIRE_THROW(mapper.globalIdx(n), nemo::exception);
+	if(step > 1) {
+		BOOST_REQUIRE(!mapper.existingGlobal(n0 + 1));
+		BOOST_REQUIRE_THROW(mapper.localIdx(n0 + 1), nemo::exception);
+	}
+	BOOST_REQUIRE_THROW(mapper.insert(n0, n), nemo::exception);
+	BOOST_REQUIRE_THROW(mapper.insert(n0 + n*step, 0), nemo::exception);
+}
+
+
+BOOST_AUTO_TEST_SUITE(mapper)
+
+	BOOST_AUTO_TEST_CASE(dense)
+	{
+		nemo::RandomMapper<nidx_t> mapper;
+		mapper.reserve(1000000, 1000000 + 2*999, 1000);
+		BOOST_REQUIRE(mapper.dense());
+		testMapper(mapper, 1000000, 2, 1000);
+	}
+
+	BOOST_AUTO_TEST_CASE(sparse)
+	{
+		nemo::RandomMapper<nidx_t> mapper;
+		mapper.reserve(0, 1000*999, 1000);
+		BOOST_REQUIRE(!mapper.dense());
+		testMapper(mapper, 0, 1000, 1000);
+	}
+
+	/* Indices outside the reserved range force a fallback to sparse mode */
+	BOOST_AUTO_TEST_CASE(fallback)
+	{
+		nemo::RandomMapper<nidx_t> mapper;
+		mapper.reserve(0, 999, 1000);
+		BOOST_REQUIRE(mapper.dense());
+		testMapper(mapper, 0, 3, 1000);
+		BOOST_REQUIRE(!mapper.dense());
+	}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
 /* Create simulation and verify that the simulation data contains the same
  * synapses as the input network. Neurons are assumed to lie in a contigous
  * range of indices starting at n0. */
@@ -644,6 +1135,97 @@ testGetSynapsesFromUnconnectedNeuron(backend_t backend)
 }
 
 
+/* Synapses with the same source are bucketed into rows by delay when setting
+ * up the simulation. Synapse queries should still refer to the synapses in the
+ * order they were added. */
+void
+testGetSynapsesInterleavedDelays()
+{
+	unsigned ncount = 100;
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		net.addNeuron(n, 0.02f, 0.2f, -65.0f, 8.0f, 0.2f*-65.0f, -65.0f, 0.0f);
+	}
+	for(unsigned n=0; n < ncount; ++n) {
+		for(unsigned s=0; s < 20; ++s) {
+			net.addSynapse(n, (n + s*7) % ncount, 1 + (s*3) % 11, float(s), s % 2 == 0);
+		}
+	}
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+
+	for(unsigned n=0; n < ncount; ++n) {
+		const std::vector<synapse_id> ids = sim->getSynapsesFrom(n);
+		BOOST_REQUIRE_EQUAL(ids.size(), 20U);
+		for(unsigned s=0; s < ids.size(); ++s) {
+			BOOST_REQUIRE_EQUAL(sim->getSynapseTarget(ids[s]), (n + s*7) % ncount);
+			BOOST_REQUIRE_EQUAL(sim->getSynapseDelay(ids[s]), 1 + (s*3) % 11);
+			BOOST_REQUIRE_EQUAL(sim->getSynapseWeight(ids[s]), float(s));
+			BOOST_REQUIRE_EQUAL(sim->getSynapsePlastic(ids[s]), s % 2 == 0);
+		}
+	}
+
+	synapse_id invalid = (uint64_t(0) << 32) | uint64_t(20);
+	BOOST_REQUIRE_THROW(sim->getSynapseTarget(invalid), nemo::exception);
+
+	/* Weights are converted to fixed-point in parallel, but an overflow
+	 * should still be reported to the caller */
+	net.addSynapse(0, 1, 1, 1.0e9f, false);
+	BOOST_REQUIRE_THROW(sim.reset(nemo::simulation(net, conf)), std::exception);
+}
+
+
+/* Synapses from different sources are interleaved in the network's synapse
+ * store, which spans several storage chunks here. Lookups by id should work
+ * both before and after more synapses are added. */
+void
+testNetworkSynapseStore()
+{
+	unsigned ncount = 7;
+	unsigned scount = 10000;
+	nemo::Network net;
+	for(unsigned n=0; n < ncount; ++n) {
+		net.addNeuron(n, 0.02f, 0.2f, -65.0f, 8.0f, 0.2f*-65.0f, -65.0f, 0.0f);
+	}
+
+	for(unsigned round=0; round < 2; ++round) {
+		for(unsigned s=0; s < scount; ++s) {
+			for(unsigned n=0; n < ncount; ++n) {
+				unsigned i = round * scount + s;
+				synapse_id id = net.addSynapse(n, (n+i) % ncount, 1 + i % 20, float(i % 100), i % 3 == 0);
+				BOOST_REQUIRE_EQUAL(id, (uint64_t(n) << 32) | uint64_t(i));
+			}
+		}
+
+		for(unsigned n=0; n < ncount; ++n) {
+			const std::vector<synapse_id>& ids = net.getSynapsesFrom(n);
+			BOOST_REQUIRE_EQUAL(ids.size(), (round+1) * scount);
+			for(unsigned i=0; i < ids.size(); ++i) {
+				BOOST_REQUIRE_EQUAL(net.getSynapseTarget(ids[i]), (n+i) % ncount);
+				BOOST_REQUIRE_EQUAL(net.getSynapseDelay(ids[i]), 1 + i % 20);
+				BOOST_REQUIRE_EQUAL(net.getSynapseWeight(ids[i]), float(i % 100));
+				BOOST_REQUIRE_EQUAL(net.getSynapsePlastic(ids[i]), i % 3 == 0);
+			}
+		}
+	}
+
+	BOOST_REQUIRE(net.getSynapsesFrom(ncount).empty());
+	BOOST_REQUIRE_THROW(net.getSynapseTarget(uint64_t(2*scount)), nemo::exception);
+	BOOST_REQUIRE_THROW(net.getSynapseTarget(uint64_t(ncount) << 32), nemo::exception);
+
+	/* The simulation reads the same synapses in bulk */
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+	const std::vector<synapse_id> ids = sim->getSynapsesFrom(3);
+	BOOST_REQUIRE_EQUAL(ids.size(), 2 * scount);
+	for(unsigned i=0; i < ids.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(sim->getSynapseTarget(ids[i]), (3+i) % ncount);
+		BOOST_REQUIRE_EQUAL(sim->getSynapseDelay(ids[i]), 1 + i % 20);
+	}
+}
+
+
 /* The network should contain the same synapses before and after setting up the
  * simulation. The order of the synapses may differ, though. */
 BOOST_AUTO_TEST_SUITE(get_synapses);
@@ -651,6 +1233,8 @@ BOOST_AUTO_TEST_SUITE(get_synapses);
 	TEST_ALL_BACKENDS_N(stdp, testGetSynapses, true)
 	TEST_ALL_BACKENDS(write_only, testWriteOnlySynapses)
 	TEST_ALL_BACKENDS(from_unconnected, testGetSynapsesFromUnconnectedNeuron)
+	BOOST_AUTO_TEST_CASE(interleaved_delays) { testGetSynapsesInterleavedDelays(); }
+	BOOST_AUTO_TEST_CASE(network_store) { testNetworkSynapseStore(); }
 BOOST_AUTO_TEST_SUITE_END();
 
 
@@ -676,6 +1260,7 @@ testStdpWithAllStatic(backend_t backend)
 void testInvalidBounds();
 void testInvalidStaticLength();
 void testInvalidDynamicLength(bool stdp);
+void testBulkWeightUpdate();
 
 
 BOOST_AUTO_TEST_SUITE(stdp);
@@ -685,6 +1270,7 @@ BOOST_AUTO_TEST_SUITE(stdp);
 	TEST_ALL_BACKENDS_N(noise_fractional_reward, testStdp, true, 0.9f)
 	TEST_ALL_BACKENDS(invalid, testInvalidStdpUsage)
 	TEST_ALL_BACKENDS(all_static, testStdpWithAllStatic)
+	BOOST_AUTO_TEST_CASE(bulk_update) { testBulkWeightUpdate(); }
 	BOOST_AUTO_TEST_SUITE(configuration)
 		BOOST_AUTO_TEST_CASE(limits) { testInvalidBounds(); }
 		BOOST_AUTO_TEST_CASE(dlength) { testInvalidStaticLength(); }
@@ -733,38 +1319,463 @@ BOOST_AUTO_TEST_SUITE_END()
 
 
 
-/* create basic network with a single neuron and verify that membrane potential
- * is set correctly initially */
+/* The CPU backend has several spike delivery engines, which should produce
+ * exactly the same firing. Without STDP, comparing push and pull delivery
+ * also compares the compact and the full encoding of the forward matrix, as
+ * pull delivery never uses the former. */
 void
-testVProbe(backend_t backend)
+testCpuDeliveryEngines(bool stdp, cpu_delivery_t engine)
 {
-	nemo::Network net;
-	float v0 = -65.0;
-	net.addNeuron(0, 0.02f, 0.2f, -65.0f+15.0f*0.25f, 8.0f-6.0f*0.25f, 0.2f*-65.0f, v0, 5.0f);
+	boost::scoped_ptr<nemo::Network> net(nemo::torus::construct(1, 100, stdp, 32, false));
+	nemo::Configuration push = configuration(stdp, 1024, NEMO_BACKEND_CPU);
+	nemo::Configuration other = configuration(stdp, 1024, NEMO_BACKEND_CPU);
+	other.setCpuDeliveryEngine(engine);
+	BOOST_REQUIRE_EQUAL(other.cpuDeliveryEngine(), engine);
+	compareSimulations(net.get(), push, net.get(), other, 1, stdp);
+}
 
-	nemo::Configuration conf = configuration(false, 1024, backend);
 
-	boost::scoped_ptr<nemo::Simulation> sim(simulation(net, conf));
-	BOOST_REQUIRE_EQUAL(v0, sim->getMembranePotential(0));
+
+/* Disabling the compact synapse encoding should not change the results */
+void
+testCpuCompactSynapses()
+{
+	boost::scoped_ptr<nemo::Network> net(nemo::torus::construct(1, 100, false, 32, false));
+	nemo::Configuration compact = configuration(false, 1024, NEMO_BACKEND_CPU);
+	nemo::Configuration full = configuration(false, 1024, NEMO_BACKEND_CPU);
+	BOOST_REQUIRE(compact.cpuCompactSynapses());
+	full.setCpuCompactSynapses(false);
+	BOOST_REQUIRE(!full.cpuCompactSynapses());
+	compareSimulations(net.get(), compact, net.get(), full, 1, false);
 }
 
 
-TEST_ALL_BACKENDS(vprobe, testVProbe)
+/* Weight changes must reach spikes which are already in flight, so apply
+ * STDP often and over several seconds. The ring engine reads the weights
+ * when spikes are generated, and so cannot be used with STDP at all. */
+void
+testCpuDeliveryEnginesPeriodicStdp()
+{
+	boost::scoped_ptr<nemo::Network> net(nemo::torus::construct(1, 100, true, 32, false));
+	nemo::Configuration push = configuration(true, 1024, NEMO_BACKEND_CPU);
+	nemo::Configuration pull = configuration(true, 1024, NEMO_BACKEND_CPU);
+	pull.setCpuDeliveryEngine(NEMO_CPU_DELIVERY_PULL);
+	nemo::Configuration ring = configuration(true, 1024, NEMO_BACKEND_CPU);
+	ring.setCpuDeliveryEngine(NEMO_CPU_DELIVERY_RING);
+
+	BOOST_REQUIRE_THROW(nemo::simulation(*net, ring), nemo::exception);
+
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(*net, push));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(*net, pull));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	for(unsigned ms=0; ms < 3000; ++ms) {
+		const std::vector<unsigned>& fired1 = sim1->step();
+		std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+		const std::vector<unsigned>& fired2 = sim2->step();
+		std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+		if(ms % 10 == 9) {
+			sim1->applyStdp(1.0);
+			sim2->applyStdp(1.0);
+		}
+	}
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	const std::vector<synapse_id>& ids = sim1->getSynapsesFrom(0);
+	for(std::vector<synapse_id>::const_iterator i = ids.begin(); i != ids.end(); ++i) {
+		BOOST_REQUIRE_EQUAL(sim1->getSynapseWeight(*i), sim2->getSynapseWeight(*i));
+	}
+}
 
 
-BOOST_AUTO_TEST_CASE(add_neuron)
+#ifdef _OPENMP
+/* The CPU backend sizes its per-thread buffers when the simulation is
+ * created, and should keep using that many threads even if the OpenMP thread
+ * count is changed later */
+void
+testCpuThreadCountChange(cpu_delivery_t engine)
 {
-	nemo::Network net;
-	unsigned iz = net.addNeuronType("Izhikevich");
-	std::vector<float> args(7, 0.0f);
-	/* Duplicate neuron indices should report an error */
-	net.addNeuron(iz, 0, args.size(), &args[0]);
-	BOOST_REQUIRE_THROW(net.addNeuron(iz, 0, args.size(), &args[0]), nemo::exception);
+	boost::scoped_ptr<nemo::Network> net(nemo::torus::construct(1, 100, false, 32, false));
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	conf.setCpuDeliveryEngine(engine);
+
+	int threads = omp_get_max_threads();
+	omp_set_num_threads(1);
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(*net, conf));
+	omp_set_num_threads(8);
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(*net, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	for(unsigned ms=0; ms < 1000; ++ms) {
+		const std::vector<unsigned>& fired1 = sim1->step();
+		std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+		const std::vector<unsigned>& fired2 = sim2->step();
+		std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+	}
+	omp_set_num_threads(threads);
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
 }
+#endif
 
 
+BOOST_AUTO_TEST_SUITE(cpu_delivery)
+	BOOST_AUTO_TEST_CASE(nostdp) { testCpuDeliveryEngines(false, NEMO_CPU_DELIVERY_PULL); }
+	BOOST_AUTO_TEST_CASE(stdp) { testCpuDeliveryEngines(true, NEMO_CPU_DELIVERY_PULL); }
+	BOOST_AUTO_TEST_CASE(ring_nostdp) { testCpuDeliveryEngines(false, NEMO_CPU_DELIVERY_RING); }
+	BOOST_AUTO_TEST_CASE(periodic_stdp) { testCpuDeliveryEnginesPeriodicStdp(); }
+	BOOST_AUTO_TEST_CASE(full_encoding) { testCpuCompactSynapses(); }
+#ifdef _OPENMP
+	BOOST_AUTO_TEST_CASE(push_thread_change) { testCpuThreadCountChange(NEMO_CPU_DELIVERY_PUSH); }
+	BOOST_AUTO_TEST_CASE(pull_thread_change) { testCpuThreadCountChange(NEMO_CPU_DELIVERY_PULL); }
+#endif
+	/* The firing history is not limited to 64 cycles on the CPU backend */
+	BOOST_AUTO_TEST_CASE(push_d200) { runRing(NEMO_BACKEND_CPU, 500, 200, NEMO_CPU_DELIVERY_PUSH); }
+	BOOST_AUTO_TEST_CASE(pull_d200) { runRing(NEMO_BACKEND_CPU, 500, 200, NEMO_CPU_DELIVERY_PULL); }
+	BOOST_AUTO_TEST_CASE(ring_d200) { runRing(NEMO_BACKEND_CPU, 500, 200, NEMO_CPU_DELIVERY_RING); }
+	BOOST_AUTO_TEST_CASE(invalid) {
+		nemo::Configuration conf;
+		BOOST_REQUIRE_THROW(conf.setCpuDeliveryEngine(~0U), nemo::exception);
+	}
+BOOST_AUTO_TEST_SUITE_END()
 
-/* Both the simulation and network classes have neuron setters. Here we perform
+
+
+/* Reference values from the Random123 known-answer tests */
+void
+testPhiloxKnownAnswer()
+{
+	unsigned ctr[4] = { 0, 0, 0, 0 };
+	unsigned key[2] = { 0, 0 };
+	unsigned out[4];
+	philox4x32(ctr, key, out);
+	BOOST_REQUIRE_EQUAL(out[0], 0x6627e8d5U);
+	BOOST_REQUIRE_EQUAL(out[1], 0xe169c58dU);
+	BOOST_REQUIRE_EQUAL(out[2], 0xbc57ac4cU);
+	BOOST_REQUIRE_EQUAL(out[3], 0x9b00dbd8U);
+}
+
+
+
+/* Noisy, sparsely connected excitatory Izhikevich population. The neurons
+ * are added in order of \a perm, with user index base + perm[i], and
+ * optionally after a population of another type, so that the simulation
+ * lays out the same neurons differently. The synapses only depend on the
+ * user indices. */
+nemo::Network*
+createNoisyNetwork(const std::vector<unsigned>& perm, unsigned base, bool otherFirst)
+{
+	nemo::Network* net = new nemo::Network();
+	if(otherFirst) {
+		unsigned poisson = net->addNeuronType("PoissonSource");
+		float rate = 0.0f;
+		for(unsigned n=0; n < 100; ++n) {
+			net->addNeuron(poisson, 5000 + n, 1, &rate);
+		}
+	}
+	unsigned iz = net->addNeuronType("Izhikevich");
+	const unsigned ncount = perm.size();
+	for(unsigned i=0; i < ncount; ++i) {
+		float args[7] = { 0.02f, 0.2f, -65.0f, 8.0f, -13.0f, -65.0f, 5.0f };
+		net->addNeuron(iz, base + perm[i], 7, args);
+	}
+	rng_t rng;
+	uirng_t target(rng, boost::uniform_int<>(0, ncount-1));
+	for(unsigned source=0; source < ncount; ++source) {
+		for(unsigned s=0; s < 20; ++s) {
+			net->addSynapse(base + source, base + target(), 1 + s % 10, 0.5f, false);
+		}
+	}
+	return net;
+}
+
+
+
+/* Run a simulation for a number of cycles and return the firing in terms
+ * of user indices relative to \a base, sorted within each cycle. */
+std::vector<std::vector<unsigned> >
+runNoisy(nemo::Network* net, const nemo::Configuration& conf,
+		unsigned base, unsigned duration)
+{
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(*net, conf));
+	std::vector<std::vector<unsigned> > firing(duration);
+	for(unsigned t=0; t < duration; ++t) {
+		const std::vector<unsigned>& fired = sim->step();
+		for(std::vector<unsigned>::const_iterator i = fired.begin(); i != fired.end(); ++i) {
+			if(*i >= base && *i < 5000) {
+				firing[t].push_back(*i - base);
+			}
+		}
+		std::sort(firing[t].begin(), firing[t].end());
+	}
+	return firing;
+}
+
+
+
+/* With the counter-based RNG the firing only depends on the user indices of
+ * the neurons and the synapses, and not on how the simulation lays out the
+ * neurons. The population size is a multiple of the widest vector, so that
+ * all neurons are updated by the same kernel in both layouts. */
+void
+testCounterRngLayout()
+{
+	const unsigned ncount = 1024;
+	const unsigned duration = 500;
+
+	std::vector<unsigned> perm(ncount);
+	for(unsigned n=0; n < ncount; ++n) {
+		perm[n] = n;
+	}
+	boost::scoped_ptr<nemo::Network> net0(createNoisyNetwork(perm, 0, false));
+	std::reverse(perm.begin(), perm.end());
+	boost::scoped_ptr<nemo::Network> net1(createNoisyNetwork(perm, 0, true));
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	conf.setCpuRng(NEMO_CPU_RNG_PHILOX);
+	BOOST_REQUIRE_EQUAL(conf.cpuRng(), unsigned(NEMO_CPU_RNG_PHILOX));
+
+	std::vector<std::vector<unsigned> > f0 = runNoisy(net0.get(), conf, 0, duration);
+	std::vector<std::vector<unsigned> > f1 = runNoisy(net1.get(), conf, 0, duration);
+
+	unsigned nfired = 0;
+	for(unsigned t=0; t < duration; ++t) {
+		BOOST_REQUIRE_EQUAL_COLLECTIONS(f0[t].begin(), f0[t].end(), f1[t].begin(), f1[t].end());
+		nfired += f0[t].size();
+	}
+	BOOST_REQUIRE(nfired > 0);
+
+	/* Different user indices give different random numbers */
+	std::reverse(perm.begin(), perm.end());
+	boost::scoped_ptr<nemo::Network> net2(createNoisyNetwork(perm, 1, false));
+	BOOST_REQUIRE(runNoisy(net2.get(), conf, 1, duration) != f0);
+}
+
+
+
+/* The firing rate is the same with either RNG, although the actual firing
+ * differs */
+void
+testCounterRngRate()
+{
+	const unsigned ncount = 1000;
+	const unsigned duration = 1000;
+
+	std::vector<unsigned> perm(ncount);
+	for(unsigned n=0; n < ncount; ++n) {
+		perm[n] = n;
+	}
+	boost::scoped_ptr<nemo::Network> net(createNoisyNetwork(perm, 0, false));
+
+	nemo::Configuration xorshift = configuration(false, 1024, NEMO_BACKEND_CPU);
+	nemo::Configuration philox = configuration(false, 1024, NEMO_BACKEND_CPU);
+	philox.setCpuRng(NEMO_CPU_RNG_PHILOX);
+
+	std::vector<std::vector<unsigned> > f0 = runNoisy(net.get(), xorshift, 0, duration);
+	std::vector<std::vector<unsigned> > f1 = runNoisy(net.get(), philox, 0, duration);
+	BOOST_REQUIRE(f0 != f1);
+
+	unsigned n0 = 0;
+	unsigned n1 = 0;
+	for(unsigned t=0; t < duration; ++t) {
+		n0 += f0[t].size();
+		n1 += f1[t].size();
+	}
+	BOOST_REQUIRE(n0 > 0);
+	BOOST_CHECK_CLOSE(double(n1), double(n0), 10.0);
+}
+
+
+
+/* Poisson sources driven by the counter-based RNG fire at the configured
+ * rate */
+void
+testCounterRngPoisson()
+{
+	const unsigned ncount = 1000;
+	const unsigned duration = 1000;
+	const float rate = 0.01f;
+
+	nemo::Network net;
+	unsigned poisson = net.addNeuronType("PoissonSource");
+	for(unsigned n=0; n < ncount; ++n) {
+		net.addNeuron(poisson, n, 1, &rate);
+	}
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	conf.setCpuRng(NEMO_CPU_RNG_PHILOX);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+	unsigned nfired = 0;
+	for(unsigned t=0; t < duration; ++t) {
+		nfired += sim->step().size();
+	}
+	BOOST_CHECK_CLOSE(double(nfired), double(ncount * duration) * rate, 5.0);
+}
+
+
+BOOST_AUTO_TEST_SUITE(cpu_rng)
+	BOOST_AUTO_TEST_CASE(philox_known_answer) { testPhiloxKnownAnswer(); }
+	BOOST_AUTO_TEST_CASE(layout) { testCounterRngLayout(); }
+	BOOST_AUTO_TEST_CASE(rate) { testCounterRngRate(); }
+	BOOST_AUTO_TEST_CASE(poisson) { testCounterRngPoisson(); }
+	BOOST_AUTO_TEST_CASE(invalid) {
+		nemo::Configuration conf;
+		BOOST_REQUIRE_THROW(conf.setCpuRng(~0U), nemo::exception);
+	}
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+/* The RNG state for a neuron only depends on the seed and its index, so
+ * initialising any sub-range gives the same state as initialising the whole
+ * range. This holds for arbitrarily large offsets. */
+void
+testRngSeedRange()
+{
+	std::vector<RNG> all(300);
+	nemo::initialiseRng(0, 299, 7, all);
+	std::vector<RNG> part(100);
+	nemo::initialiseRng(100, 199, 7, part);
+	for(unsigned i=0; i < 100; ++i) {
+		BOOST_REQUIRE_EQUAL_COLLECTIONS(part[i].state, part[i].state+4,
+				all[100+i].state, all[100+i].state+4);
+	}
+
+	std::vector<RNG> other(100);
+	nemo::initialiseRng(100, 199, 8, other);
+	BOOST_REQUIRE(!std::equal(other[0].state, other[0].state+4, part[0].state));
+
+	std::vector<RNG> far(1);
+	nemo::initialiseRng(50000000, 50000000, 7, far);
+	RNG ref;
+	nemo::seedRng(7, 50000000, ref);
+	BOOST_REQUIRE_EQUAL_COLLECTIONS(far[0].state, far[0].state+4, ref.state, ref.state+4);
+}
+
+
+
+/* A simulation is reproducible for a given seed, and differs between
+ * seeds, with either RNG on the CPU backend */
+void
+testRngSeedSimulation(cpu_rng_t rngType)
+{
+	const unsigned ncount = 1000;
+	const unsigned duration = 200;
+
+	std::vector<unsigned> perm(ncount);
+	for(unsigned n=0; n < ncount; ++n) {
+		perm[n] = n;
+	}
+	boost::scoped_ptr<nemo::Network> net(createNoisyNetwork(perm, 0, false));
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	conf.setCpuRng(rngType);
+	BOOST_REQUIRE_EQUAL(conf.rngSeed(), 0U);
+	std::vector<std::vector<unsigned> > f0 = runNoisy(net.get(), conf, 0, duration);
+
+	conf.setRngSeed(1234);
+	BOOST_REQUIRE_EQUAL(conf.rngSeed(), 1234U);
+	std::vector<std::vector<unsigned> > f1 = runNoisy(net.get(), conf, 0, duration);
+	std::vector<std::vector<unsigned> > f2 = runNoisy(net.get(), conf, 0, duration);
+
+	BOOST_REQUIRE(f1 == f2);
+	BOOST_REQUIRE(f0 != f1);
+}
+
+
+BOOST_AUTO_TEST_SUITE(rng_seed)
+	BOOST_AUTO_TEST_CASE(range) { testRngSeedRange(); }
+	BOOST_AUTO_TEST_CASE(xorshift) { testRngSeedSimulation(NEMO_CPU_RNG_XORSHIFT); }
+	BOOST_AUTO_TEST_CASE(philox) { testRngSeedSimulation(NEMO_CPU_RNG_PHILOX); }
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+/* The CPU backend may use a vectorised Izhikevich kernel, which computes in
+ * single precision. Check a single step of a population of unconnected
+ * neurons against a double precision reference, using the tolerance
+ * documented in Izhikevich_simd.hpp. The population size is not a multiple
+ * of the vector width, so the scalar tail is covered as well. */
+void
+testIzhikevichTolerance()
+{
+	const unsigned ncount = 1003;
+
+	rng_t rng;
+	boost::variate_generator<rng_t&, boost::uniform_real<float> >
+		randomUnit(rng, boost::uniform_real<float>(0.0f, 1.0f));
+
+	nemo::Network net;
+	std::vector<double> u(ncount), v(ncount), a(ncount), b(ncount), I(ncount);
+	nemo::Simulation::current_stimulus istim;
+	for(unsigned n=0; n < ncount; ++n) {
+		a[n] = 0.02f + 0.08f * randomUnit();
+		b[n] = 0.2f + 0.05f * randomUnit();
+		v[n] = -70.0f + 20.0f * randomUnit();
+		u[n] = float(b[n] * v[n]);
+		I[n] = 10.0f * randomUnit();
+		net.addNeuron(n, a[n], b[n], -65.0f, 8.0f, u[n], v[n], 0.0f);
+		istim.push_back(std::make_pair(n, float(I[n])));
+	}
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+	sim->step(istim);
+
+	for(unsigned n=0; n < ncount; ++n) {
+		for(unsigned t=0; t < 4; ++t) {
+			v[n] += 0.25 * ((0.04 * v[n] + 5.0) * v[n] + 140.0 - u[n] + I[n]);
+			u[n] += 0.25 * (a[n] * (b[n] * v[n] - u[n]));
+		}
+		/* BOOST_CHECK_CLOSE takes the tolerance in percent */
+		BOOST_REQUIRE(v[n] < 30.0);
+		BOOST_CHECK_CLOSE(sim->getNeuronState(n, 0), u[n], 1e-2);
+		BOOST_CHECK_CLOSE(sim->getNeuronState(n, 1), v[n], 1e-2);
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(izhikevich_tolerance) { testIzhikevichTolerance(); }
+
+
+
+
+/* create basic network with a single neuron and verify that membrane potential
+ * is set correctly initially */
+void
+testVProbe(backend_t backend)
+{
+	nemo::Network net;
+	float v0 = -65.0;
+	net.addNeuron(0, 0.02f, 0.2f, -65.0f+15.0f*0.25f, 8.0f-6.0f*0.25f, 0.2f*-65.0f, v0, 5.0f);
+
+	nemo::Configuration conf = configuration(false, 1024, backend);
+
+	boost::scoped_ptr<nemo::Simulation> sim(simulation(net, conf));
+	BOOST_REQUIRE_EQUAL(v0, sim->getMembranePotential(0));
+}
+
+
+TEST_ALL_BACKENDS(vprobe, testVProbe)
+
+
+BOOST_AUTO_TEST_CASE(add_neuron)
+{
+	nemo::Network net;
+	unsigned iz = net.addNeuronType("Izhikevich");
+	std::vector<float> args(7, 0.0f);
+	/* Duplicate neuron indices should report an error */
+	net.addNeuron(iz, 0, args.size(), &args[0]);
+	BOOST_REQUIRE_THROW(net.addNeuron(iz, 0, args.size(), &args[0]), nemo::exception);
+}
+
+
+
+/* Both the simulation and network classes have neuron setters. Here we perform
  * the same test for both. */
 void
 testSetNeuron(backend_t backend)
@@ -1002,8 +2013,507 @@ testNoParamNeuronType()
 }
 
 
+/* Neuron state should be accessible for all neuron types in a network with
+ * several types, not just for the first one */
+void
+testMixedNeuronTypes(backend_t backend)
+{
+	const unsigned ncount = 20;
+	nemo::Network net;
+	unsigned poisson = net.addNeuronType("PoissonSource");
+	unsigned iz = net.addNeuronType("Izhikevich");
+	float rate = 0.0f;
+	for(unsigned n=0; n < ncount; ++n) {
+		net.addNeuron(poisson, n, 1, &rate);
+	}
+	for(unsigned n=0; n < ncount; ++n) {
+		float args[7] = { 0.02f, 0.2f, -65.0f, 8.0f, 0.0f, float(n), -65.0f };
+		net.addNeuron(iz, ncount+n, 7, args);
+	}
+
+	nemo::Configuration conf = configuration(false, 1024, backend);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(net, conf));
+	for(unsigned n=0; n < ncount; ++n) {
+		BOOST_REQUIRE_EQUAL(sim->getNeuronParameter(ncount+n, 0), 0.02f);
+		BOOST_REQUIRE_EQUAL(sim->getNeuronState(ncount+n, 0), float(n));
+		sim->setNeuronState(ncount+n, 1, -70.0f + float(n));
+	}
+	for(unsigned n=0; n < ncount; ++n) {
+		BOOST_REQUIRE_EQUAL(sim->getMembranePotential(ncount+n), -70.0f + float(n));
+	}
+}
+
+
+
+/* Add all synapses of a generator, in block order, to a network which
+ * already contains the same neurons (and no synapses). The synapse ids in
+ * the network should then be the same as in the generator. */
+void
+materialise(const nemo::network::Generator& gen, nemo::Network& net,
+		std::vector<synapse_id>& ids)
+{
+	for(size_t b=0; b < gen.synapseBlockCount(); ++b) {
+		nemo::network::SynapseBuffer buffer;
+		nemo::network::SynapseBlock block = gen.synapseBlock(b, buffer);
+		if(block.size == 0) {
+			continue;
+		}
+		std::vector<synapse_id> added(block.size);
+		std::vector<unsigned> delays(block.delay, block.delay + block.size);
+		net.addSynapses(block.size, block.source, block.target, &delays[0],
+				block.weight, block.plastic, &added[0]);
+		for(size_t s=0; s < block.size; ++s) {
+			BOOST_REQUIRE_EQUAL(added[s], (uint64_t(block.source[s]) << 32) | block.id[s]);
+		}
+		ids.insert(ids.end(), added.begin(), added.end());
+	}
+}
+
+
+
+/* Procedurally generated synapses should be the same every time a block is
+ * computed, and a simulation created directly from the generator should be
+ * the same as one created from a network containing the generated synapses */
+void
+testProceduralFixedInDegree()
+{
+	const unsigned ncount = 3000;
+	const unsigned inDegree = 100;
+
+	nemo::Network neurons;
+	nemo::Network materialised;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, neurons, 5.0f);
+		addExcitatoryNeuron(n, materialised, 5.0f);
+	}
+
+	nemo::network::procedural::Generator gen(neurons, 7);
+	gen.add(nemo::network::procedural::FixedInDegree(
+				0, ncount*4/5, 0, ncount, inDegree, 0.0f, 0.5f, 1, 20));
+	gen.add(nemo::network::procedural::FixedInDegree(
+				ncount*4/5, ncount, 0, ncount, inDegree/4, -1.0f, 0.0f, 1, 1));
+
+	std::vector<unsigned> indegree(ncount, 0);
+	std::vector<unsigned> outdegree(ncount, 0);
+	for(size_t b=0; b < gen.synapseBlockCount(); ++b) {
+		nemo::network::SynapseBuffer buffer1, buffer2;
+		nemo::network::SynapseBlock b1 = gen.synapseBlock(b, buffer1);
+		nemo::network::SynapseBlock b2 = gen.synapseBlock(b, buffer2);
+		BOOST_REQUIRE_EQUAL(b1.size, b2.size);
+		for(size_t s=0; s < b1.size; ++s) {
+			BOOST_REQUIRE_EQUAL(b1.target[s], b2.target[s]);
+			BOOST_REQUIRE_EQUAL(b1.weight[s], b2.weight[s]);
+			BOOST_REQUIRE_EQUAL(b1.delay[s], b2.delay[s]);
+			BOOST_REQUIRE(b1.target[s] < ncount);
+			BOOST_REQUIRE_EQUAL(b1.id[s], outdegree[b1.source[s]]);
+			indegree[b1.target[s]] += 1;
+			outdegree[b1.source[s]] += 1;
+		}
+	}
+	for(unsigned n=0; n < ncount; ++n) {
+		BOOST_REQUIRE_EQUAL(indegree[n], inDegree + inDegree/4);
+	}
+
+	std::vector<synapse_id> ids;
+	materialise(gen, materialised, ids);
+	BOOST_REQUIRE_EQUAL(ids.size(), size_t(ncount) * (inDegree + inDegree/4));
+
+	/* The iterator gives the same synapses as the blocks */
+	size_t pos = 0;
+	for(nemo::network::synapse_iterator i = gen.synapse_begin();
+			i != gen.synapse_end(); ++i, ++pos) {
+		BOOST_REQUIRE_EQUAL((uint64_t(i->source) << 32) | i->id(), ids[pos]);
+	}
+	BOOST_REQUIRE_EQUAL(pos, ids.size());
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(gen, conf));
+	boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(materialised, conf));
+
+	std::vector<unsigned> cycles1, nidx1, cycles2, nidx2;
+	for(unsigned ms=0; ms < 1000; ++ms) {
+		const std::vector<unsigned>& fired1 = sim1->step();
+		std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+		std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+		const std::vector<unsigned>& fired2 = sim2->step();
+		std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+		std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+	}
+	BOOST_REQUIRE(!nidx1.empty());
+	compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+
+	const std::vector<synapse_id>& fromFirst = sim1->getSynapsesFrom(0);
+	BOOST_REQUIRE_EQUAL(fromFirst.size(), outdegree[0]);
+}
+
+
+
+void
+testProceduralTorus()
+{
+	const unsigned pcount = 2;
+	const unsigned ncount = pcount * 1024;
+	const unsigned outDegree = 50;
+
+	nemo::Network neurons;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, neurons);
+	}
+
+	nemo::network::procedural::Generator gen(neurons);
+	gen.add(nemo::network::procedural::Torus(0, pcount, 0, ncount, outDegree, 64.0f, 0.0f, 0.5f));
+	BOOST_REQUIRE_EQUAL(gen.maxDelay(), 20U);
+
+	size_t count = 0;
+	for(size_t b=0; b < gen.synapseBlockCount(); ++b) {
+		nemo::network::SynapseBuffer buffer;
+		nemo::network::SynapseBlock block = gen.synapseBlock(b, buffer);
+		for(size_t s=0; s < block.size; ++s) {
+			BOOST_REQUIRE(block.target[s] < ncount);
+			BOOST_REQUIRE(block.delay[s] >= 1 && block.delay[s] <= 20);
+			BOOST_REQUIRE(block.weight[s] >= 0.0f && block.weight[s] <= 0.5f);
+		}
+		count += block.size;
+	}
+	BOOST_REQUIRE_EQUAL(count, size_t(ncount) * outDegree);
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(gen, conf));
+	BOOST_REQUIRE_EQUAL(sim->getSynapsesFrom(ncount-1).size(), outDegree);
+}
+
+
+
+/* Synapses of a block-structured network, mixed with synapses added
+ * explicitly to the network */
+void
+testProceduralBlocks()
+{
+	std::vector<unsigned> sizes;
+	sizes.push_back(100);
+	sizes.push_back(300);
+	const unsigned ncount = 400;
+
+	nemo::Network neurons;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, neurons);
+	}
+	neurons.addSynapse(0, 399, 5, 1.0f, false);
+
+	nemo::network::procedural::Blocks blocks(0, sizes);
+	blocks.connect(0, 1, 1.0f, 0.25f, 2);
+	blocks.connect(1, 0, 0.1f, -0.5f, 3);
+	BOOST_REQUIRE_THROW(blocks.connect(0, 2, 0.5f, 0.0f, 1), nemo::exception);
+	BOOST_REQUIRE_THROW(blocks.connect(0, 1, 1.5f, 0.0f, 1), nemo::exception);
+
+	nemo::network::procedural::Generator gen(neurons);
+	gen.add(blocks);
+	BOOST_REQUIRE_EQUAL(gen.maxDelay(), 5U);
+
+	nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+	boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(gen, conf));
+
+	/* The explicit synapse comes first, and the generated ids follow on */
+	const std::vector<synapse_id> ids0 = sim->getSynapsesFrom(0);
+	BOOST_REQUIRE_EQUAL(ids0.size(), 301U);
+	for(unsigned i=0; i < ids0.size(); ++i) {
+		BOOST_REQUIRE_EQUAL(ids0[i], uint64_t(i));
+		BOOST_REQUIRE_EQUAL(sim->getSynapseTarget(ids0[i]), i == 0 ? 399U : 100 + i - 1);
+		BOOST_REQUIRE_EQUAL(sim->getSynapseDelay(ids0[i]), i == 0 ? 5U : 2U);
+	}
+
+	size_t count = 0;
+	for(unsigned n=100; n < ncount; ++n) {
+		const std::vector<synapse_id>& ids = sim->getSynapsesFrom(n);
+		for(unsigned i=0; i < ids.size(); ++i) {
+			BOOST_REQUIRE(sim->getSynapseTarget(ids[i]) < 100);
+			BOOST_REQUIRE_EQUAL(sim->getSynapseWeight(ids[i]), -0.5f);
+		}
+		count += ids.size();
+	}
+	/* Binomial(30000, 0.1) has mean 3000 and standard deviation 52 */
+	BOOST_REQUIRE(count > 2700 && count < 3300);
+
+	/* Synapses to non-existing neurons are rejected when the simulation is
+	 * created */
+	nemo::network::procedural::Generator invalid(neurons);
+	invalid.add(nemo::network::procedural::FixedInDegree(
+				0, ncount, ncount, ncount+10, 1, 0.0f, 0.0f, 1, 1));
+	BOOST_REQUIRE_THROW(nemo::simulation(invalid, conf), nemo::exception);
+}
+
+
+
+/* Network not starting at neuron 0, with a mix of excitatory and inhibitory
+ * synapses, and some neurons without synapses */
+void
+createMappedTestNetwork(nemo::Network& net, unsigned n0, unsigned ncount)
+{
+	rng_t rng;
+	uirng_t target(rng, boost::uniform_int<>(n0, n0+ncount-1));
+	uirng_t delay(rng, boost::uniform_int<>(1, 20));
+	urng_t weight(rng, boost::uniform_real<double>(0.0, 0.5));
+
+	for(unsigned n=n0; n < n0+ncount; ++n) {
+		addExcitatoryNeuron(n, net, 5.0f);
+		if(n % 7 == 0) {
+			continue;
+		}
+		for(unsigned s=0; s < 50; ++s) {
+			float w = n % 5 == 0 ? -2.0f * float(weight()) : float(weight());
+			net.addSynapse(n, target(), delay(), w, s % 2 == 0);
+		}
+	}
+}
+
+
+
+std::vector<char>
+readFile(const char* filename)
+{
+	std::ifstream file(filename, std::ios::in | std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file),
+			std::istreambuf_iterator<char>());
+}
+
+
+
+void
+writeFile(const char* filename, const std::vector<char>& data)
+{
+	std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(&data[0], data.size());
+}
+
+
+
+/* A simulation created from a network file should be the same as one created
+ * from the network which was saved */
+void
+testMappedRoundTrip()
+{
+	const char* filename = "test-mapped.nemo";
+	const unsigned n0 = 100;
+	const unsigned ncount = 2500;
+
+	nemo::Network net;
+	createMappedTestNetwork(net, n0, ncount);
+	net.save(filename);
+
+	{
+		nemo::network::mapped::Generator gen(filename);
+		BOOST_REQUIRE_EQUAL(gen.neuronCount(), ncount);
+		BOOST_REQUIRE_EQUAL(gen.minNeuronIndex(), n0);
+		BOOST_REQUIRE_EQUAL(gen.maxNeuronIndex(), n0+ncount-1);
+		BOOST_REQUIRE_EQUAL(gen.maxDelay(), net.maxDelay());
+		BOOST_REQUIRE_EQUAL(gen.neuronTypeCount(), 1U);
+		BOOST_REQUIRE_EQUAL(gen.neuronType(0).name(), std::string("Izhikevich"));
+
+		unsigned neurons = 0;
+		for(nemo::network::neuron_iterator i = gen.neuron_begin(0);
+				i != gen.neuron_end(0); ++i, ++neurons) {
+			for(unsigned p=0; p < 5; ++p) {
+				BOOST_REQUIRE_EQUAL(i->second.getParameter(p), net.getNeuronParameter(i->first, p));
+			}
+			for(unsigned v=0; v < 2; ++v) {
+				BOOST_REQUIRE_EQUAL(i->second.getState(v), net.getNeuronState(i->first, v));
+			}
+		}
+		BOOST_REQUIRE_EQUAL(neurons, ncount);
+
+		/* The blocks and the iterator agree, and both give each source's
+		 * synapses in the order they were added */
+		std::vector<synapse_id> ids;
+		for(size_t b=0; b < gen.synapseBlockCount(); ++b) {
+			nemo::network::SynapseBuffer buffer;
+			nemo::network::SynapseBlock block = gen.synapseBlock(b, buffer);
+			for(size_t s=0; s < block.size; ++s) {
+				synapse_id id = (uint64_t(block.source[s]) << 32) | block.id[s];
+				BOOST_REQUIRE_EQUAL(block.target[s], net.getSynapseTarget(id));
+				BOOST_REQUIRE_EQUAL(block.delay[s], net.getSynapseDelay(id));
+				BOOST_REQUIRE_EQUAL(block.weight[s], net.getSynapseWeight(id));
+				BOOST_REQUIRE_EQUAL(block.plastic[s], net.getSynapsePlastic(id));
+				ids.push_back(id);
+			}
+		}
+		BOOST_REQUIRE_EQUAL(uint64_t(ids.size()), gen.synapseCount());
+		size_t pos = 0;
+		for(nemo::network::synapse_iterator i = gen.synapse_begin();
+				i != gen.synapse_end(); ++i, ++pos) {
+			BOOST_REQUIRE_EQUAL((uint64_t(i->source) << 32) | i->id(), ids[pos]);
+		}
+		BOOST_REQUIRE_EQUAL(pos, ids.size());
+
+		for(unsigned n=n0; n < n0+ncount; ++n) {
+			BOOST_REQUIRE_EQUAL(net.getSynapsesFrom(n).size(), n % 7 == 0 ? 0U : 50U);
+		}
+
+		nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+		boost::scoped_ptr<nemo::Simulation> sim1(nemo::simulation(gen, conf));
+		boost::scoped_ptr<nemo::Simulation> sim2(nemo::simulation(net, conf));
+		/* Public entry point, which maps the file itself */
+		boost::scoped_ptr<nemo::Simulation> sim3(nemo::simulation(filename, conf));
+
+		std::vector<unsigned> cycles1, nidx1, cycles2, nidx2, cycles3, nidx3;
+		for(unsigned ms=0; ms < 1000; ++ms) {
+			const std::vector<unsigned>& fired1 = sim1->step();
+			std::copy(fired1.begin(), fired1.end(), back_inserter(nidx1));
+			std::fill_n(back_inserter(cycles1), fired1.size(), ms);
+			const std::vector<unsigned>& fired2 = sim2->step();
+			std::copy(fired2.begin(), fired2.end(), back_inserter(nidx2));
+			std::fill_n(back_inserter(cycles2), fired2.size(), ms);
+			const std::vector<unsigned>& fired3 = sim3->step();
+			std::copy(fired3.begin(), fired3.end(), back_inserter(nidx3));
+			std::fill_n(back_inserter(cycles3), fired3.size(), ms);
+		}
+		BOOST_REQUIRE(!nidx1.empty());
+		compareSimulationResults(cycles1, nidx1, cycles2, nidx2);
+		compareSimulationResults(cycles3, nidx3, cycles2, nidx2);
+
+		const std::vector<synapse_id>& from = sim1->getSynapsesFrom(n0+1);
+		const std::vector<synapse_id>& expected = net.getSynapsesFrom(n0+1);
+		BOOST_REQUIRE_EQUAL(from.size(), expected.size());
+		for(size_t i=0; i < from.size(); ++i) {
+			BOOST_REQUIRE_EQUAL(sim1->getSynapseTarget(from[i]), net.getSynapseTarget(from[i]));
+		}
+	}
+
+	std::remove(filename);
+}
+
+
+
+/* A procedural network can be written once and then mapped repeatedly */
+void
+testMappedProcedural()
+{
+	const char* filename = "test-mapped-procedural.nemo";
+	const unsigned ncount = 3000;
+
+	nemo::Network neurons;
+	for(unsigned n=0; n < ncount; ++n) {
+		addExcitatoryNeuron(n, neurons, 5.0f);
+	}
+	neurons.addSynapse(0, 1, 1, 0.5f, false);
+	nemo::network::procedural::Generator procedural(neurons, 3);
+	procedural.add(nemo::network::procedural::FixedInDegree(
+				0, ncount, 0, ncount, 40, 0.0f, 0.5f, 1, 10));
+	nemo::network::mapped::write(procedural, filename);
+
+	{
+		nemo::network::mapped::Generator mapped(filename);
+		BOOST_REQUIRE_EQUAL(mapped.synapseCount(), uint64_t(ncount) * 40 + 1);
+		BOOST_REQUIRE_EQUAL(mapped.maxDelay(), 10U);
+
+		/* Same synapses, in the same order */
+		nemo::network::synapse_iterator i = procedural.synapse_begin();
+		nemo::network::synapse_iterator j = mapped.synapse_begin();
+		for( ; i != procedural.synapse_end(); ++i, ++j) {
+			BOOST_REQUIRE(j != mapped.synapse_end());
+			BOOST_REQUIRE_EQUAL(i->source, j->source);
+			BOOST_REQUIRE_EQUAL(i->id(), j->id());
+			BOOST_REQUIRE_EQUAL(i->target(), j->target());
+			BOOST_REQUIRE_EQUAL(i->delay, j->delay);
+			BOOST_REQUIRE_EQUAL(i->weight(), j->weight());
+		}
+		BOOST_REQUIRE(j == mapped.synapse_end());
+
+		nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+		boost::scoped_ptr<nemo::Simulation> sim(nemo::simulation(mapped, conf));
+		BOOST_REQUIRE_EQUAL(sim->getSynapseTarget(0), 1U);
+	}
+
+	std::remove(filename);
+}
+
+
+
+void
+testMappedInvalid()
+{
+	using nemo::network::mapped::FileHeader;
+
+	const char* filename = "test-mapped-invalid.nemo";
+	const char* corrupt = "test-mapped-corrupt.nemo";
+
+	nemo::Network empty;
+	BOOST_REQUIRE_THROW(empty.save(filename), nemo::exception);
+
+	BOOST_REQUIRE_THROW(nemo::network::mapped::Generator("no-such-file.nemo"), nemo::exception);
+	{
+		nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+		BOOST_REQUIRE_THROW(nemo::simulation("no-such-file.nemo", conf), nemo::exception);
+	}
+
+	nemo::Network net;
+	createMappedTestNetwork(net, 0, 100);
+	net.save(filename);
+	const std::vector<char> data = readFile(filename);
+	FileHeader header;
+	memcpy(&header, &data[0], sizeof(header));
+
+	{
+		std::vector<char> truncated(data.begin(), data.begin() + header.targetOffset);
+		writeFile(corrupt, truncated);
+		BOOST_REQUIRE_THROW(nemo::network::mapped::Generator gen(corrupt), nemo::exception);
+	}
+
+	{
+		std::vector<char> magic(data);
+		magic[0] = 'X';
+		writeFile(corrupt, magic);
+		BOOST_REQUIRE_THROW(nemo::network::mapped::Generator gen(corrupt), nemo::exception);
+	}
+
+	{
+		std::vector<char> version(data);
+		reinterpret_cast<FileHeader*>(&version[0])->version += 1;
+		writeFile(corrupt, version);
+		BOOST_REQUIRE_THROW(nemo::network::mapped::Generator gen(corrupt), nemo::exception);
+	}
+
+	{
+		std::vector<char> rows(data);
+		reinterpret_cast<uint64_t*>(&rows[header.rowOffsetOffset])[1] = header.synapseCount + 1;
+		writeFile(corrupt, rows);
+		BOOST_REQUIRE_THROW(nemo::network::mapped::Generator gen(corrupt), nemo::exception);
+	}
+
+	/* Invalid delays are only detected when the synapses are read */
+	{
+		std::vector<char> delay(data);
+		reinterpret_cast<uint32_t*>(&delay[header.delayOffset])[0] = 0;
+		writeFile(corrupt, delay);
+		nemo::network::mapped::Generator gen(corrupt);
+		nemo::Configuration conf = configuration(false, 1024, NEMO_BACKEND_CPU);
+		BOOST_REQUIRE_THROW(nemo::simulation(gen, conf), nemo::exception);
+	}
+
+	std::remove(filename);
+	std::remove(corrupt);
+}
+
+
+
+BOOST_AUTO_TEST_SUITE(procedural)
+	BOOST_AUTO_TEST_CASE(fixed_indegree) { testProceduralFixedInDegree(); }
+	BOOST_AUTO_TEST_CASE(torus) { testProceduralTorus(); }
+	BOOST_AUTO_TEST_CASE(blocks) { testProceduralBlocks(); }
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
+BOOST_AUTO_TEST_SUITE(mapped)
+	BOOST_AUTO_TEST_CASE(round_trip) { testMappedRoundTrip(); }
+	BOOST_AUTO_TEST_CASE(procedural) { testMappedProcedural(); }
+	BOOST_AUTO_TEST_CASE(invalid) { testMappedInvalid(); }
+BOOST_AUTO_TEST_SUITE_END()
+
+
+
 BOOST_AUTO_TEST_SUITE(plugins)
 	BOOST_AUTO_TEST_CASE(invalid_type) { testInvalidNeuronType(); }
+	BOOST_AUTO_TEST_CASE(mixed_types) { testMixedNeuronTypes(NEMO_BACKEND_CPU); }
 #ifdef NEMO_CUDA_ENABLED
 	BOOST_AUTO_TEST_CASE(no_parameters) { testNoParamNeuronType(); }
 #endif
@@ -1026,6 +2536,10 @@ BOOST_AUTO_TEST_SUITE(c_api)
 
 	BOOST_AUTO_TEST_CASE(synapse_ids) { nemo::test::c_api::testSynapseId(); }
 	BOOST_AUTO_TEST_CASE(set_neuron) { nemo::test::c_api::testSetNeuron(); }
+	TEST_ALL_BACKENDS(run, nemo::test::c_api::testRun)
+	TEST_ALL_BACKENDS(dense_istim, nemo::test::c_api::testDenseCurrentStimulus)
+	TEST_ALL_BACKENDS(bulk_construction, nemo::test::c_api::testBulkConstruction)
+	TEST_ALL_BACKENDS(save_and_load, nemo::test::c_api::testSaveAndLoad)
 
 	BOOST_AUTO_TEST_SUITE(get_synapse)
 		TEST_ALL_BACKENDS_N(n0, nemo::test::c_api::testGetSynapses, 0)